@@ -0,0 +1,574 @@
+#include "Wireless_mgmt.h"
+#include "fake_control.h"
+#include <atomic>
+#include <chrono>
+#include <new>
+
+// ==========================================
+// 主機端基準測試
+// 以 fakes/ 中的模擬後端執行函式庫，量測每次呼叫的實際耗時、
+// 模擬的裝置時間(虛擬時鐘)與堆積記憶體配置次數
+// 成功次數低於預期或每次呼叫的配置次數超過上限時印出 FAIL，並以非零值結束
+// 執行: pio run -e native -t exec
+// ==========================================
+
+// 計算全域 new/delete 的配置次數
+static std::atomic<uint64_t> _allocCount(0);
+
+void* operator new(size_t size) {
+  _allocCount++;
+  void* p = malloc(size > 0 ? size : 1);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) {
+  _allocCount++;
+  void* p = malloc(size > 0 ? size : 1);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t size) noexcept { free(p); }
+void operator delete[](void* p, size_t size) noexcept { free(p); }
+
+// 單一項目的量測區間
+typedef struct {
+  std::chrono::steady_clock::time_point wallStart;
+  unsigned long simStart;
+  uint64_t allocStart;
+} BenchSpan;
+
+static BenchSpan _benchBegin() {
+  BenchSpan span;
+  span.simStart = millis();
+  span.allocStart = _allocCount;
+  span.wallStart = std::chrono::steady_clock::now();
+  return span;
+}
+
+// 未通過的檢查數
+static uint32_t _benchFailures = 0;
+
+/**
+ * 印出一個項目的結果
+ * @param maxAllocs 每次呼叫允許的堆積配置次數上限，超過時計為失敗
+ */
+static void _benchReport(const char* name, const BenchSpan& span, uint32_t calls, double maxAllocs, const char* note) {
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  uint64_t allocs = _allocCount - span.allocStart;
+  double wallNs = std::chrono::duration<double, std::nano>(end - span.wallStart).count();
+  double simMs = (double)(millis() - span.simStart);
+  double allocsPerCall = (double)allocs / calls;
+
+  printf("%-28s %8u %12.0f %12.3f %10.2f  %s\n",
+         name, calls, wallNs / calls, simMs / calls, allocsPerCall, note);
+  // 以表格顯示的精度比較，首次呼叫的一次性配置不計為回歸
+  if (allocsPerCall > maxAllocs + 0.005) {
+    printf("FAIL %s: %.2f allocs/call (%llu), expected at most %.2f\n", name, allocsPerCall, (unsigned long long)allocs, maxAllocs);
+    _benchFailures++;
+  }
+}
+
+/**
+ * 檢查成功次數 (或其他計數) 是否達到預期
+ */
+static void _benchExpect(const char* name, const char* what, uint32_t actual, uint32_t expected) {
+  if (actual < expected) {
+    printf("FAIL %s: %s %u, expected %u\n", name, what, actual, expected);
+    _benchFailures++;
+  }
+}
+
+static void _benchHeader() {
+  printf("%-28s %8s %12s %12s %10s  %s\n", "benchmark", "calls", "ns/call", "sim ms/call", "allocs/call", "note");
+  printf("%.*s\n", 100, "----------------------------------------------------------------------------------------------------");
+}
+
+// ==========================================
+// WiFi
+// ==========================================
+
+static void _benchWifiConnect() {
+  const uint32_t calls = 200;
+  char note[64];
+
+  fake::wifiClearAPs();
+  fake::wifiAddAP("bench-ap", -48, 6);
+  fake::wifiAddAP("neighbor", -70, 1);
+  fake::wifiAddAP("bench-ap", -62, 11);
+
+  uint32_t ok = 0;
+  BenchSpan span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    if (Wifi_connect("bench-ap", "password", 10, true)) ok++;
+  }
+  snprintf(note, sizeof(note), "success %u/%u", ok, calls);
+  _benchReport("Wifi_connect", span, calls, 0.1, note);
+  _benchExpect("Wifi_connect", "success", ok, calls);
+
+  // 每三次關聯失敗一次: 逾時後改連排名第二的AP
+  fake::wifi.failAssocEveryN = 3;
+  ok = 0;
+  span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    if (Wifi_connect("bench-ap", "password", 1, true)) ok++;
+  }
+  snprintf(note, sizeof(note), "success %u/%u, 1/3 assoc fail", ok, calls);
+  _benchReport("Wifi_connect (failover)", span, calls, 0.1, note);
+  _benchExpect("Wifi_connect (failover)", "success", ok, calls);
+  fake::wifi.failAssocEveryN = 0;
+
+  Wifi_setFastReconnect(true);
+  Wifi_connect("bench-ap", "password", 10, true);
+  ok = 0;
+  span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    if (Wifi_connect("bench-ap", "password", 10, true)) ok++;
+  }
+  snprintf(note, sizeof(note), "success %u/%u, cached BSSID/lease", ok, calls);
+  _benchReport("Wifi_connect (fast)", span, calls, 0.1, note);
+  _benchExpect("Wifi_connect (fast)", "success", ok, calls);
+  Wifi_setFastReconnect(false);
+}
+
+// 連線中高頻率輪詢連線資訊: 結構化快照與舊的 String 路徑比較
+static void _benchWifiInfo() {
+  const uint32_t calls = 10000;
+  WifiInfo info;
+  int8_t rssi = 0;
+
+  BenchSpan span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    Wifi_getInfo(info);
+    rssi = info.rssi;
+  }
+  char note[64];
+  snprintf(note, sizeof(note), "connected, rssi %d", rssi);
+  _benchReport("Wifi_getInfo", span, calls, 0, note);
+
+  span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    String ssid = WiFi.SSID();
+    String mac = WiFi.macAddress();
+    rssi = WiFi.RSSI();
+  }
+  _benchReport("WiFi.SSID/macAddress String", span, calls, 2, "per-field String getters");
+}
+
+// ==========================================
+// MQTT
+// ==========================================
+
+static void _benchMqttPublish() {
+  const uint32_t calls = 10000;
+  char note[64];
+  char payload[65];
+  memset(payload, 'x', 64);
+  payload[64] = '\0';
+
+  Mqtt_setup("broker.local", 1883, true);
+  if (!Mqtt_connect("bench", NULL, NULL, NULL, NULL, false, true, true)) {
+    printf("FAIL Mqtt_connect: failed, skipping MQTT benchmarks\n");
+    _benchFailures++;
+    return;
+  }
+
+  fake::resetCounters();
+  uint32_t ok = 0;
+  BenchSpan span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    if (Mqtt_publish("bench/topic", payload, false, true)) ok++;
+  }
+  snprintf(note, sizeof(note), "64 B, success %u/%u", ok, calls);
+  _benchReport("Mqtt_publish", span, calls, 0, note);
+  _benchExpect("Mqtt_publish", "success", ok, calls);
+
+  fake::mqtt.failPublishEveryN = 10;
+  ok = 0;
+  span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    if (Mqtt_publish("bench/topic", payload, false, true)) ok++;
+  }
+  snprintf(note, sizeof(note), "64 B, success %u/%u, 1/10 fail", ok, calls);
+  _benchReport("Mqtt_publish (fail 10%)", span, calls, 0, note);
+  _benchExpect("Mqtt_publish (fail 10%)", "success", ok, calls - calls / 10);
+  fake::mqtt.failPublishEveryN = 0;
+
+  Mqtt_disconnect(true);
+}
+
+// ==========================================
+// 傳統藍牙
+// ==========================================
+
+static uint32_t _btFrames = 0;
+
+static void _btOnFrame(const uint8_t* data, size_t length, void* ctx) {
+  _btFrames++;
+}
+
+static void _btOnString(String message) {
+  _btFrames++;
+}
+
+static void _benchBTLoopWith(const char* name, uint32_t lines, double maxAllocs) {
+  const char* line = "sensor=23.5,humidity=41,seq=0000\n";
+  size_t lineLength = strlen(line);
+  char note[64];
+
+  // 一次餵入所有資料，量測 BT_loop 在接收預算內逐批處理的成本
+  for (uint32_t i = 0; i < lines; i++) {
+    fake::btFeed((const uint8_t*)line, lineLength);
+  }
+
+  _btFrames = 0;
+  uint32_t loops = 0;
+  BenchSpan span = _benchBegin();
+  while (_btFrames < lines && loops < lines * 4) {
+    BT_loop();
+    loops++;
+  }
+  snprintf(note, sizeof(note), "%u frames in %u loops, per frame", _btFrames, loops);
+  _benchReport(name, span, lines, maxAllocs, note);
+  _benchExpect(name, "frames", _btFrames, lines);
+}
+
+static void _benchBTLoop() {
+  BT_setup("bench-bt", true);
+  fake::btSetConnected(true);
+  BT_loop();
+
+  BT_setFrameCallback(_btOnFrame, NULL, true);
+  _benchBTLoopWith("BT_loop (frame callback)", 1000, 0);
+  BT_setFrameCallback(NULL, NULL, true);
+
+  BT_setCallback(_btOnString, true);
+  // 舊版回調函式每個訊框建立 String 並 trim
+  _benchBTLoopWith("BT_loop (String callback)", 1000, 2);
+  BT_setCallback(NULL, true);
+}
+
+// ==========================================
+// 低功耗藍牙
+// ==========================================
+
+static void _benchBLESendWith(const char* name, uint32_t calls, const char* extra) {
+  char text[201];
+  memset(text, 'b', 200);
+  text[200] = '\0';
+  String message(text);
+  char note[80];
+
+  fake::resetCounters();
+  uint32_t ok = 0;
+  BenchSpan span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    if (BLE_sendMessage(message, true, true)) ok++;
+  }
+  snprintf(note, sizeof(note), "200 B @ MTU 185, success %u/%u, %u notifies%s",
+           ok, calls, fake::counters.bleNotifies, extra);
+  _benchReport(name, span, calls, 0, note);
+  _benchExpect(name, "success", ok, calls);
+}
+
+static void _benchBLESend() {
+  BLE_setup("bench-ble", true);
+  fake::bleConnect(0, 185, true);
+  BLE_loop();
+
+  _benchBLESendWith("BLE_sendMessage", 2000, "");
+
+  // 每 7 次通知失敗一次並回報壅塞 3 ms
+  fake::ble.failNotifyEveryN = 7;
+  fake::ble.congestMs = 3;
+  _benchBLESendWith("BLE_sendMessage (congest)", 2000, ", 1/7 fail");
+  fake::ble.failNotifyEveryN = 0;
+  fake::ble.congestMs = 0;
+
+  fake::bleDisconnect(0);
+  BLE_loop();
+}
+
+// ==========================================
+// AP 站台表
+// ==========================================
+
+static void _benchAPStationCallback(const WifiAPStation &station, WifiAPStationEvent event, void* ctx) {
+  uint32_t* counts = (uint32_t*)ctx;
+  counts[event]++;
+}
+
+static void _benchAPStations() {
+  const uint32_t calls = 1000;
+  uint32_t counts[3] = {0, 0, 0};
+  uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x00};
+  char note[80];
+
+  Wifi_AP_start("bench-prov", "password", 6, false, 4, true);
+  Wifi_AP_setStationCallback(_benchAPStationCallback, counts, true);
+
+  // 每次: 站台加入、取得 IP、離開
+  BenchSpan span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    mac[5] = (uint8_t)i;
+    fake::apStationJoin(mac, -40, IPAddress(192, 168, 4, 2 + (i % 200)));
+    fake::apStationLeave(mac);
+  }
+  snprintf(note, sizeof(note), "join/ip/leave callbacks %u/%u/%u",
+           counts[WIFI_AP_STATION_JOINED], counts[WIFI_AP_STATION_IP_ASSIGNED], counts[WIFI_AP_STATION_LEFT]);
+  _benchReport("AP station join+leave", span, calls, 0, note);
+  _benchExpect("AP station join+leave", "joined", counts[WIFI_AP_STATION_JOINED], calls);
+  _benchExpect("AP station join+leave", "ip assigned", counts[WIFI_AP_STATION_IP_ASSIGNED], calls);
+  _benchExpect("AP station join+leave", "left", counts[WIFI_AP_STATION_LEFT], calls);
+
+  for (uint8_t i = 0; i < 4; i++) {
+    mac[5] = i;
+    fake::apStationJoin(mac, -40 - i, IPAddress(192, 168, 4, 10 + i));
+  }
+  WifiAPStation stations[WIFI_AP_MAX_STATIONS];
+  int count = 0;
+  span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    count = Wifi_AP_getStations(stations, WIFI_AP_MAX_STATIONS);
+  }
+  if (count > 0) {
+    snprintf(note, sizeof(note), "%d stations, last ip .%u", count, IPAddress(stations[count - 1].ip)[3]);
+  } else {
+    snprintf(note, sizeof(note), "no stations");
+  }
+  _benchReport("Wifi_AP_getStations", span, calls, 0, note);
+  _benchExpect("Wifi_AP_getStations", "stations", count > 0 ? count : 0, 4);
+
+  Wifi_AP_setStationCallback(NULL, NULL, true);
+  Wifi_AP_stop(true);
+}
+
+// ==========================================
+// 配網 (AP+STA): AP 保持開啟時以 STA 連線，穩定後關閉 AP
+// ==========================================
+
+static void _benchProvisionWith(const char* name, int apChannel, const char* ssid) {
+  const uint32_t calls = 50;
+  WifiProvTiming timing = {};
+  uint32_t done = 0;
+  char note[96];
+
+  BenchSpan span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    Wifi_provisionStart("bench-prov", "password", apChannel, false, 4, true);
+    Wifi_provisionConnect(ssid, "password", 500, 10, true);
+    WifiProvState state = Wifi_provisionPoll();
+    while (state != WIFI_PROV_DONE && state != WIFI_PROV_FAILED) {
+      delay(10);
+      state = Wifi_provisionPoll();
+    }
+    if (Wifi_provisionGetTiming(timing)) done++;
+    Wifi_provisionStop(true);
+  }
+  snprintf(note, sizeof(note), "done %u/%u, connect %lu ms, stable %lu ms%s",
+           done, calls, (unsigned long)timing.connectMs, (unsigned long)timing.stableMs,
+           timing.channelMoved ? ", AP moved channel" : "");
+  _benchReport(name, span, calls, 0, note);
+  _benchExpect(name, "done", done, calls);
+}
+
+static void _benchProvision() {
+  fake::wifiAddAP("other-net", -55, 1);
+  _benchProvisionWith("Provision (home channel)", 6, "bench-ap");
+  _benchProvisionWith("Provision (other channel)", 6, "other-net");
+}
+
+// ==========================================
+// 省電設定檔: 各設定檔下到閘道的往返延遲
+// ==========================================
+
+static void _benchPowerProfiles() {
+  const WifiPowerProfile profiles[] = {WIFI_PROFILE_LOW_LATENCY, WIFI_PROFILE_BALANCED, WIFI_PROFILE_LOW_POWER};
+  const char* names[] = {"Latency (low-latency)", "Latency (balanced)", "Latency (low-power)"};
+  const uint16_t count = 20;
+  char note[80];
+
+  for (int i = 0; i < 3; i++) {
+    Wifi_setPowerProfile(profiles[i], true);
+    Wifi_connect("bench-ap", "password", 10, true);
+
+    WifiLatencyStats stats;
+    BenchSpan span = _benchBegin();
+    Wifi_measureLatency(stats, count, 200, 1000);
+    snprintf(note, sizeof(note), "rtt min/avg/max %lu/%lu/%lu ms, %u/%u replies",
+             (unsigned long)stats.minMs, (unsigned long)stats.avgMs, (unsigned long)stats.maxMs,
+             stats.received, stats.sent);
+    // 模擬的 ping 以 new 建立工作階段 (每次量測一次)
+    _benchReport(names[i], span, count, 0.1, note);
+    _benchExpect(names[i], "replies", stats.received, count);
+  }
+  Wifi_setPowerProfile(WIFI_PROFILE_DEFAULT, true);
+}
+
+// ==========================================
+// CBOR 與 JSON: 同一筆感測資料的編碼大小、耗時與解碼
+// ==========================================
+
+static const int32_t _benchSamples[3] = {12, 340, -5};
+
+static size_t _benchEncodeCbor(CborWriter &writer, uint32_t seq) {
+  Cbor_beginMap(writer, 6);
+  Cbor_writeText(writer, "id");
+  Cbor_writeText(writer, "node-01");
+  Cbor_writeText(writer, "t");
+  Cbor_writeFloat(writer, 23.5f + (seq & 7));
+  Cbor_writeText(writer, "h");
+  Cbor_writeUint(writer, 61);
+  Cbor_writeText(writer, "ts");
+  Cbor_writeUint(writer, 1700000000UL + seq);
+  Cbor_writeText(writer, "ok");
+  Cbor_writeBool(writer, true);
+  Cbor_writeText(writer, "v");
+  Cbor_beginArray(writer, 3);
+  for (int i = 0; i < 3; i++) {
+    Cbor_writeInt(writer, _benchSamples[i]);
+  }
+  return writer.overflow ? 0 : writer.length;
+}
+
+static void _benchCbor() {
+  const uint32_t calls = 10000;
+  char note[80];
+  size_t length = 0;
+
+  // String 串接的 JSON (常見的 Arduino 寫法)
+  BenchSpan span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    String json = "{\"id\":\"node-01\",\"t\":" + String(23.5f + (i & 7), 1) + ",\"h\":" + String(61) +
+                  ",\"ts\":" + String(1700000000UL + i) + ",\"ok\":true,\"v\":[";
+    for (int k = 0; k < 3; k++) {
+      json += String(_benchSamples[k]);
+      if (k < 2) json += ",";
+    }
+    json += "]}";
+    length = json.length();
+  }
+  snprintf(note, sizeof(note), "%u B", (unsigned)length);
+  _benchReport("JSON (String)", span, calls, 28, note);
+
+  // snprintf 到固定緩衝區的 JSON
+  char json[128];
+  span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    length = snprintf(json, sizeof(json), "{\"id\":\"node-01\",\"t\":%.1f,\"h\":%d,\"ts\":%lu,\"ok\":true,\"v\":[%ld,%ld,%ld]}",
+                      23.5f + (i & 7), 61, 1700000000UL + i,
+                      (long)_benchSamples[0], (long)_benchSamples[1], (long)_benchSamples[2]);
+  }
+  size_t jsonLength = length;
+  snprintf(note, sizeof(note), "%u B", (unsigned)length);
+  _benchReport("JSON (snprintf)", span, calls, 0, note);
+
+  CborWriter writer;
+  span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    Cbor_writerInitShared(writer);
+    length = _benchEncodeCbor(writer, i);
+  }
+  snprintf(note, sizeof(note), "%u B (%.0f%% of JSON)", (unsigned)length, 100.0 * length / jsonLength);
+  _benchReport("Cbor encode", span, calls, 0, note);
+  _benchExpect("Cbor encode", "bytes", length > 0 ? 1 : 0, 1);
+
+  // 在原始資料上直接解碼兩個欄位，不複製字串
+  uint8_t encoded[64];
+  Cbor_writerInit(writer, encoded, sizeof(encoded));
+  _benchEncodeCbor(writer, 0);
+  double temperature = 0;
+  int64_t timestamp = 0;
+  uint32_t ok = 0;
+  span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    CborReader reader;
+    CborItem item;
+    Cbor_readerInit(reader, writer.buffer, writer.length);
+    if (!Cbor_read(reader, item) || item.type != CBOR_TYPE_MAP) continue;
+    size_t pairs = item.length;
+    if (Cbor_mapFind(reader, pairs, "ts", item) && Cbor_getInt(item, timestamp)) ok++;
+    Cbor_readerInit(reader, writer.buffer, writer.length);
+    Cbor_read(reader, item);
+    if (Cbor_mapFind(reader, pairs, "t", item) && Cbor_getFloat(item, temperature)) ok++;
+  }
+  snprintf(note, sizeof(note), "t=%.1f ts=%lld, found %u/%u", temperature, (long long)timestamp, ok, calls * 2);
+  _benchReport("Cbor_mapFind (t, ts)", span, calls, 0, note);
+  _benchExpect("Cbor_mapFind (t, ts)", "found", ok, calls * 2);
+
+  // 經由 MQTT 發布: 送出的位元組數
+  Mqtt_setup("broker.local", 1883, true);
+  if (!Mqtt_connect("bench", NULL, NULL, NULL, NULL, false, true, true)) {
+    printf("FAIL Mqtt_connect: failed, skipping MQTT encoding benchmarks\n");
+    _benchFailures++;
+    return;
+  }
+  fake::resetCounters();
+  span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    snprintf(json, sizeof(json), "{\"id\":\"node-01\",\"t\":%.1f,\"h\":%d,\"ts\":%lu,\"ok\":true,\"v\":[%ld,%ld,%ld]}",
+             23.5f + (i & 7), 61, 1700000000UL + i,
+             (long)_benchSamples[0], (long)_benchSamples[1], (long)_benchSamples[2]);
+    Mqtt_publish("bench/json", json, false, true);
+  }
+  snprintf(note, sizeof(note), "%llu B sent", (unsigned long long)fake::counters.mqttBytes);
+  _benchReport("Mqtt_publish (JSON)", span, calls, 0, note);
+  _benchExpect("Mqtt_publish (JSON)", "published", fake::counters.mqttPublishes, calls);
+
+  fake::resetCounters();
+  span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    Cbor_writerInitShared(writer);
+    _benchEncodeCbor(writer, i);
+    Mqtt_publishCbor("bench/cbor", writer, false, true);
+  }
+  snprintf(note, sizeof(note), "%llu B sent", (unsigned long long)fake::counters.mqttBytes);
+  _benchReport("Mqtt_publishCbor", span, calls, 0, note);
+  _benchExpect("Mqtt_publishCbor", "published", fake::counters.mqttPublishes, calls);
+  Mqtt_disconnect(true);
+}
+
+// ==========================================
+// Wireless_formatMetrics: 上述所有情境累積的指標
+// ==========================================
+
+static void _benchMetrics() {
+  static char payload[WIRELESS_METRICS_PAYLOAD_LEN];
+  const uint32_t calls = 1000;
+  size_t length = 0;
+
+  BenchSpan span = _benchBegin();
+  for (uint32_t i = 0; i < calls; i++) {
+    length = Wireless_formatMetrics(payload, sizeof(payload));
+  }
+  char note[40];
+  snprintf(note, sizeof(note), "%u B JSON", (unsigned)length);
+  _benchReport("Wireless_formatMetrics", span, calls, 0, note);
+  _benchExpect("Wireless_formatMetrics", "bytes", length > 0 ? 1 : 0, 1);
+  printf("\n%s\n", payload);
+}
+
+int main(int argc, char** argv) {
+  Wireless_setLogSink(NULL);
+
+  _benchHeader();
+  _benchWifiConnect();
+  _benchWifiInfo();
+  _benchMqttPublish();
+  _benchBTLoop();
+  _benchBLESend();
+  _benchAPStations();
+  _benchProvision();
+  _benchPowerProfiles();
+  _benchCbor();
+  _benchMetrics();
+
+  if (_benchFailures > 0) {
+    printf("\n%u check(s) failed\n", _benchFailures);
+    return 1;
+  }
+  return 0;
+}
\ No newline at end of file
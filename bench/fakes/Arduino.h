@@ -0,0 +1,154 @@
+#ifndef FAKE_ARDUINO_H
+#define FAKE_ARDUINO_H
+
+// ==========================================
+// 主機端模擬的 Arduino 核心 (僅供 native 環境的基準測試使用)
+// 時間由虛擬時鐘提供，delay() 只推進時鐘不會真的等待
+// ==========================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
+
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+uint32_t esp_random();
+
+#define RTC_DATA_ATTR
+#define IRAM_ATTR
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+// 與 Arduino String 相同，非空字串一律配置堆積記憶體，方便計算配置次數
+class String {
+public:
+  String(const char* s = "");
+  String(const String& other);
+  String(int value);
+  String(unsigned int value);
+  String(long value);
+  String(unsigned long value);
+  String(float value, unsigned char decimalPlaces = 2);
+  ~String();
+
+  String& operator=(const String& other);
+  String& operator+=(const String& other);
+  String& operator+=(const char* s);
+  String& operator+=(char c);
+  bool operator==(const String& other) const { return equals(other); }
+  char operator[](unsigned int index) const { return index < _len ? _buf[index] : 0; }
+
+  const char* c_str() const { return _buf != NULL ? _buf : ""; }
+  unsigned int length() const { return _len; }
+  bool equals(const String& other) const { return strcmp(c_str(), other.c_str()) == 0; }
+  int indexOf(const String& other) const;
+  void trim();
+
+private:
+  void assign(const char* s, size_t len);
+  void append(const char* s, size_t len);
+
+  char* _buf;
+  unsigned int _len;
+};
+
+String operator+(const String& a, const String& b);
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+  }
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t println() { return write("\r\n"); }
+  size_t println(const char* s) { return print(s) + println(); }
+  size_t println(const String& s) { return print(s) + println(); }
+  int printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual void flush() {}
+};
+
+// 序列埠輸出預設捨棄，基準測試可透過 fake::serialEcho 開啟
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) {}
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+};
+
+extern HardwareSerial Serial;
+
+#include "IPAddress.h"
+
+// 臨界區段 (主機端以單一互斥鎖模擬)
+typedef struct { int owner; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+void fake_enterCritical(portMUX_TYPE* mux);
+void fake_exitCritical(portMUX_TYPE* mux);
+#define portENTER_CRITICAL(mux) fake_enterCritical(mux)
+#define portEXIT_CRITICAL(mux) fake_exitCritical(mux)
+
+// FreeRTOS (任務以執行緒模擬，佇列以互斥鎖保護的環形緩衝區模擬)
+typedef void* TaskHandle_t;
+typedef void* QueueHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef void (*TaskFunction_t)(void*);
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+#define pdPASS 1
+#define pdFAIL 0
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackSize, void* arg, UBaseType_t priority, TaskHandle_t* handle);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackSize, void* arg, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+void vQueueDelete(QueueHandle_t queue);
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t wait);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+#endif
\ No newline at end of file
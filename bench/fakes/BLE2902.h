@@ -0,0 +1,15 @@
+#ifndef FAKE_BLE2902_H
+#define FAKE_BLE2902_H
+
+#include "BLEDevice.h"
+
+class BLE2902 : public BLEDescriptor {
+public:
+  BLE2902() : BLEDescriptor("2902", 2) {}
+  bool getNotifications() { return (_value[0] & 0x01) != 0; }
+  bool getIndications() { return (_value[0] & 0x02) != 0; }
+  void setNotifications(bool enable) { _value[0] = enable ? (_value[0] | 0x01) : (_value[0] & ~0x01); }
+  void setIndications(bool enable) { _value[0] = enable ? (_value[0] | 0x02) : (_value[0] & ~0x02); }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,131 @@
+#ifndef FAKE_BLEDEVICE_H
+#define FAKE_BLEDEVICE_H
+
+#include "Arduino.h"
+#include "esp_gatts_api.h"
+#include <string>
+
+class BLEServer;
+class BLEService;
+class BLECharacteristic;
+class BLEAdvertising;
+
+class BLEDescriptor {
+public:
+  BLEDescriptor(const char* uuid, uint16_t maxLen = 100) : _handle(0) { memset(_value, 0, sizeof(_value)); }
+  virtual ~BLEDescriptor() {}
+  uint16_t getHandle() { return _handle; }
+  uint8_t* getValue() { return _value; }
+  size_t getLength() { return 2; }
+
+protected:
+  friend class BLECharacteristic;
+  uint16_t _handle;
+  uint8_t _value[2];
+};
+
+class BLECharacteristicCallbacks {
+public:
+  typedef enum {
+    SUCCESS_INDICATE, SUCCESS_NOTIFY, ERROR_INDICATE_DISABLED, ERROR_NOTIFY_DISABLED,
+    ERROR_GATT, ERROR_NO_CLIENT, ERROR_INDICATE_TIMEOUT, ERROR_INDICATE_FAILURE
+  } Status;
+  virtual ~BLECharacteristicCallbacks() {}
+  virtual void onRead(BLECharacteristic* pCharacteristic) {}
+  virtual void onWrite(BLECharacteristic* pCharacteristic) {}
+  virtual void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t* param) { onWrite(pCharacteristic); }
+  virtual void onNotify(BLECharacteristic* pCharacteristic) {}
+  virtual void onStatus(BLECharacteristic* pCharacteristic, Status s, uint32_t code) {}
+};
+
+class BLECharacteristic {
+public:
+  static const uint32_t PROPERTY_READ = 1 << 0;
+  static const uint32_t PROPERTY_WRITE = 1 << 1;
+  static const uint32_t PROPERTY_NOTIFY = 1 << 2;
+  static const uint32_t PROPERTY_BROADCAST = 1 << 3;
+  static const uint32_t PROPERTY_INDICATE = 1 << 4;
+  static const uint32_t PROPERTY_WRITE_NR = 1 << 5;
+
+  BLECharacteristic(uint16_t handle) : _handle(handle), _descriptor(NULL), _callbacks(NULL) {}
+  void addDescriptor(BLEDescriptor* descriptor);
+  BLEDescriptor* getDescriptorByUUID(const char* uuid) { return _descriptor; }
+  void setCallbacks(BLECharacteristicCallbacks* callbacks) { _callbacks = callbacks; }
+  BLECharacteristicCallbacks* getCallbacks() { return _callbacks; }
+  std::string getValue() { return _value; }
+  uint8_t* getData() { return (uint8_t*)_value.data(); }
+  size_t getLength() { return _value.size(); }
+  uint16_t getHandle() { return _handle; }
+  void setValue(uint8_t* data, size_t size) { _value.assign((const char*)data, size); }
+  void setValue(std::string value) { _value = value; }
+  void notify(bool isNotification = true);
+  void indicate() { notify(false); }
+
+private:
+  uint16_t _handle;
+  BLEDescriptor* _descriptor;
+  BLECharacteristicCallbacks* _callbacks;
+  std::string _value;
+};
+
+class BLEService {
+public:
+  BLECharacteristic* createCharacteristic(const char* uuid, uint32_t properties);
+  void start() {}
+};
+
+class BLEServerCallbacks {
+public:
+  virtual ~BLEServerCallbacks() {}
+  virtual void onConnect(BLEServer* pServer) {}
+  virtual void onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) { onConnect(pServer); }
+  virtual void onDisconnect(BLEServer* pServer) {}
+  virtual void onDisconnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) { onDisconnect(pServer); }
+  virtual void onMtuChanged(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {}
+};
+
+class BLEServer {
+public:
+  BLEServer() : _callbacks(NULL), _connectedCount(0) {}
+  BLEService* createService(const char* uuid);
+  void setCallbacks(BLEServerCallbacks* callbacks) { _callbacks = callbacks; }
+  BLEServerCallbacks* getCallbacks() { return _callbacks; }
+  void startAdvertising();
+  uint32_t getConnectedCount() { return _connectedCount; }
+  esp_gatt_if_t getGattsIf() { return 3; }
+  void disconnect(uint16_t connId);
+  BLEAdvertising* getAdvertising();
+
+private:
+  friend void fake_bleSetConnectedCount(BLEServer* server, int delta);
+  BLEServerCallbacks* _callbacks;
+  uint32_t _connectedCount;
+};
+
+class BLEAdvertising {
+public:
+  void addServiceUUID(const char* uuid) {}
+  void setScanResponse(bool enable) {}
+  void setMinPreferred(uint16_t value) {}
+  void setMaxPreferred(uint16_t value) {}
+  void setMinInterval(uint16_t value) {}
+  void setMaxInterval(uint16_t value) {}
+  void start();
+  void stop();
+};
+
+typedef void (*gatts_event_handler)(esp_gatts_cb_event_t event, esp_gatt_if_t gattsIf, esp_ble_gatts_cb_param_t* param);
+
+class BLEDevice {
+public:
+  static void init(std::string deviceName);
+  static BLEServer* createServer();
+  static BLEAdvertising* getAdvertising();
+  static void startAdvertising();
+  static void stopAdvertising();
+  static esp_err_t setMTU(uint16_t mtu);
+  static uint16_t getMTU();
+  static void setCustomGattsHandler(gatts_event_handler customGattsHandler);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,6 @@
+#ifndef FAKE_BLESERVER_H
+#define FAKE_BLESERVER_H
+
+#include "BLEDevice.h"
+
+#endif
\ No newline at end of file
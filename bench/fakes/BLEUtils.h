@@ -0,0 +1,6 @@
+#ifndef FAKE_BLEUTILS_H
+#define FAKE_BLEUTILS_H
+
+#include "BLEDevice.h"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef FAKE_BLUETOOTHSERIAL_H
+#define FAKE_BLUETOOTHSERIAL_H
+
+#include "Arduino.h"
+#include "esp_bt_defs.h"
+#include <functional>
+#include <string>
+
+// 與 arduino-esp32 2.0.x 相同: getNative() 回傳指向 uint8_t[6] 的 esp_bd_addr_t*
+class BTAddress {
+public:
+  BTAddress() { memset(_address, 0, ESP_BD_ADDR_LEN); }
+  BTAddress(esp_bd_addr_t address) { memcpy(_address, address, ESP_BD_ADDR_LEN); }
+  esp_bd_addr_t* getNative() const { return const_cast<esp_bd_addr_t*>(&_address); }
+  std::string toString(bool capital = false) const;
+
+private:
+  esp_bd_addr_t _address;
+};
+
+class BTAdvertisedDevice {
+public:
+  virtual ~BTAdvertisedDevice() {}
+  virtual std::string getName() const = 0;
+  virtual BTAddress getAddress() = 0;
+  virtual int8_t getRSSI() const = 0;
+  virtual bool haveName() const = 0;
+};
+
+typedef std::function<void(BTAdvertisedDevice* pAdvertisedDevice)> BTAdvertisedDeviceCb;
+
+// 接收資料由 fake::btFeed 提供，連線與掃描結果由 fake::bt 控制
+class BluetoothSerial : public Stream {
+public:
+  bool begin(String localName = String(), bool isMaster = false);
+  int available() override;
+  int peek() override;
+  int read() override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  bool connect(String remoteName);
+  bool connect(uint8_t remoteAddress[], int channel = 0);
+  bool connect();
+  bool connected(int timeout = 0);
+  bool disconnect();
+  bool discoverAsync(BTAdvertisedDeviceCb cb, int timeout = 0x30 * 1280);
+  void discoverAsyncStop();
+};
+
+#endif
\ No newline at end of file
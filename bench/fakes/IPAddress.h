@@ -0,0 +1,21 @@
+#ifndef FAKE_IPADDRESS_H
+#define FAKE_IPADDRESS_H
+
+#include <stdint.h>
+
+class IPAddress {
+public:
+  IPAddress() : _addr(0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    : _addr(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+  IPAddress(uint32_t addr) : _addr(addr) {}
+
+  operator uint32_t() const { return _addr; }
+  uint8_t operator[](int index) const { return (_addr >> (8 * index)) & 0xFF; }
+  bool fromString(const char* address);
+
+private:
+  uint32_t _addr;
+};
+
+#endif
\ No newline at end of file
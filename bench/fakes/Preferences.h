@@ -0,0 +1,27 @@
+#ifndef FAKE_PREFERENCES_H
+#define FAKE_PREFERENCES_H
+
+#include "Arduino.h"
+#include <string>
+
+// 以記憶體模擬 NVS，內容在同一個行程內保留
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false, const char* partition_label = NULL);
+  void end();
+  bool clear();
+  bool remove(const char* key);
+  size_t putBytes(const char* key, const void* value, size_t len);
+  size_t getBytes(const char* key, void* buf, size_t maxLen);
+  size_t getBytesLength(const char* key);
+  bool isKey(const char* key);
+  size_t putUInt(const char* key, uint32_t value);
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+
+private:
+  std::string _namespace;
+  bool _open = false;
+  bool _readOnly = false;
+};
+
+#endif
\ No newline at end of file
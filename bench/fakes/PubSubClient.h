@@ -0,0 +1,71 @@
+#ifndef FAKE_PUBSUBCLIENT_H
+#define FAKE_PUBSUBCLIENT_H
+
+#include "Arduino.h"
+#include "Client.h"
+#include <functional>
+
+#define MQTT_MAX_PACKET_SIZE 256
+#define MQTT_KEEPALIVE 15
+#define MQTT_SOCKET_TIMEOUT 15
+#define MQTT_MAX_HEADER_SIZE 5
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+#define MQTTPUBLISH 3 << 4
+#define MQTTPUBACK 4 << 4
+#define MQTTQOS1 (1 << 1)
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+// 與 PubSubClient 2.8 相同的介面，延遲與失敗由 fake::mqtt 控制
+class PubSubClient : public Print {
+public:
+  PubSubClient(Client& client);
+  PubSubClient& setServer(const char* domain, uint16_t port);
+  PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+  PubSubClient& setKeepAlive(uint16_t keepAlive);
+  PubSubClient& setSocketTimeout(uint16_t timeout);
+  bool setBufferSize(uint16_t size);
+  uint16_t getBufferSize();
+
+  bool connect(const char* id);
+  bool connect(const char* id, const char* user, const char* pass);
+  bool connect(const char* id, const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage);
+  bool connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage);
+  bool connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage, bool cleanSession);
+  void disconnect();
+
+  bool publish(const char* topic, const char* payload);
+  bool publish(const char* topic, const char* payload, bool retained);
+  bool publish(const char* topic, const uint8_t* payload, unsigned int plength);
+  bool publish(const char* topic, const uint8_t* payload, unsigned int plength, bool retained);
+  bool beginPublish(const char* topic, unsigned int plength, bool retained);
+  int endPublish();
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+
+  bool subscribe(const char* topic);
+  bool subscribe(const char* topic, uint8_t qos);
+  bool unsubscribe(const char* topic);
+  bool loop();
+  bool connected();
+  int state();
+
+private:
+  bool finishPublish(size_t length);
+
+  Client* _client;
+  std::function<void(char*, uint8_t*, unsigned int)> _callback;
+  uint16_t _bufferSize;
+  int _state;
+  bool _streaming;
+  size_t _streamExpected;
+  size_t _streamWritten;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,107 @@
+#ifndef FAKE_WIFI_H
+#define FAKE_WIFI_H
+
+#include "Arduino.h"
+#include "Client.h"
+#include "esp_wifi_types.h"
+typedef enum { WL_NO_SHIELD = 255, WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL, WL_SCAN_COMPLETED, WL_CONNECTED, WL_CONNECT_FAILED, WL_CONNECTION_LOST, WL_DISCONNECTED } wl_status_t;
+#define WIFI_OFF WIFI_MODE_NULL
+#define WIFI_STA WIFI_MODE_STA
+#define WIFI_AP WIFI_MODE_AP
+#define WIFI_AP_STA WIFI_MODE_APSTA
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+typedef enum { WIFI_POWER_19_5dBm = 78, WIFI_POWER_17dBm = 68, WIFI_POWER_15dBm = 60, WIFI_POWER_11dBm = 44, WIFI_POWER_8_5dBm = 34, WIFI_POWER_2dBm = 8 } wifi_power_t;
+typedef enum {
+  ARDUINO_EVENT_WIFI_READY = 0, ARDUINO_EVENT_WIFI_SCAN_DONE, ARDUINO_EVENT_WIFI_STA_START, ARDUINO_EVENT_WIFI_STA_STOP,
+  ARDUINO_EVENT_WIFI_STA_CONNECTED, ARDUINO_EVENT_WIFI_STA_DISCONNECTED, ARDUINO_EVENT_WIFI_STA_AUTHMODE_CHANGE,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP, ARDUINO_EVENT_WIFI_STA_GOT_IP6, ARDUINO_EVENT_WIFI_STA_LOST_IP,
+  ARDUINO_EVENT_WIFI_AP_START, ARDUINO_EVENT_WIFI_AP_STOP, ARDUINO_EVENT_WIFI_AP_STACONNECTED,
+  ARDUINO_EVENT_WIFI_AP_STADISCONNECTED, ARDUINO_EVENT_WIFI_AP_STAIPASSIGNED, ARDUINO_EVENT_WIFI_AP_PROBEREQRECVED,
+  ARDUINO_EVENT_MAX
+} arduino_event_id_t;
+typedef struct { uint8_t ssid[32]; uint8_t ssid_len; uint8_t bssid[6]; uint8_t reason; } wifi_event_sta_disconnected_t;
+typedef struct { uint8_t ssid[32]; uint8_t ssid_len; uint8_t bssid[6]; uint8_t channel; } wifi_event_sta_connected_t;
+typedef struct { uint8_t mac[6]; uint8_t aid; } wifi_event_ap_staconnected_t;
+typedef struct { uint8_t mac[6]; uint8_t aid; } wifi_event_ap_stadisconnected_t;
+typedef struct { uint32_t addr; } esp_ip4_addr_t;
+typedef struct { esp_ip4_addr_t ip; esp_ip4_addr_t netmask; esp_ip4_addr_t gw; } esp_netif_ip_info_t;
+typedef struct { esp_netif_ip_info_t ip_info; } ip_event_got_ip_t;
+typedef struct { esp_ip4_addr_t ip; } ip_event_ap_staipassigned_t;
+typedef union {
+  wifi_event_sta_connected_t wifi_sta_connected;
+  wifi_event_sta_disconnected_t wifi_sta_disconnected;
+  wifi_event_ap_staconnected_t wifi_ap_staconnected;
+  wifi_event_ap_stadisconnected_t wifi_ap_stadisconnected;
+  ip_event_got_ip_t got_ip;
+  ip_event_ap_staipassigned_t wifi_ap_staipassigned;
+} arduino_event_info_t;
+typedef void (*WiFiEventFuncCb)(arduino_event_id_t event, arduino_event_info_t info);
+typedef size_t wifi_event_id_t;
+
+class WiFiClient : public Client {
+public:
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char* host, uint16_t port) override;
+  size_t write(uint8_t) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size) override;
+  int peek() override;
+  void flush() override;
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+};
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t m);
+  wifi_mode_t getMode();
+  bool enableSTA(bool enable);
+  bool enableAP(bool enable);
+  wl_status_t status();
+  wl_status_t begin(const char* ssid, const char* passphrase = NULL, int32_t channel = 0, const uint8_t* bssid = NULL, bool connect = true);
+  bool config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1 = (uint32_t)0x00000000, IPAddress dns2 = (uint32_t)0x00000000);
+  bool disconnect(bool wifioff = false, bool eraseap = false);
+  bool reconnect();
+  bool isConnected();
+  bool setAutoReconnect(bool autoReconnect);
+  bool setSleep(bool enabled);
+  bool setSleep(wifi_ps_type_t sleepType);
+  wifi_ps_type_t getSleep();
+  bool setTxPower(wifi_power_t power);
+  wifi_power_t getTxPower();
+  int16_t scanNetworks(bool async = false, bool show_hidden = false, bool passive = false, uint32_t max_ms_per_chan = 300, uint8_t channel = 0, const char* ssid = nullptr, const uint8_t* bssid = nullptr);
+  int16_t scanComplete();
+  void scanDelete();
+  String SSID(uint8_t networkItem);
+  int32_t RSSI(uint8_t networkItem);
+  uint8_t* BSSID(uint8_t networkItem);
+  int32_t channel(uint8_t networkItem);
+  wifi_auth_mode_t encryptionType(uint8_t networkItem);
+  void* getScanInfoByIndex(int i);
+  String SSID() const;
+  int8_t RSSI();
+  uint8_t* BSSID();
+  int32_t channel();
+  IPAddress localIP();
+  IPAddress subnetMask();
+  IPAddress gatewayIP();
+  IPAddress dnsIP(uint8_t dns_no = 0);
+  String macAddress();
+  uint8_t* macAddress(uint8_t* mac);
+  const char* getHostname();
+  bool softAP(const char* ssid, const char* passphrase = NULL, int channel = 1, int ssid_hidden = 0, int max_connection = 4, bool ftm_responder = false);
+  bool softAPdisconnect(bool wifioff = false);
+  uint8_t softAPgetStationNum();
+  IPAddress softAPIP();
+  String softAPmacAddress();
+  uint8_t* softAPmacAddress(uint8_t* mac);
+  wifi_event_id_t onEvent(WiFiEventFuncCb cbEvent, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+  void removeEvent(wifi_event_id_t id);
+};
+extern WiFiClass WiFi;
+
+#endif
\ No newline at end of file
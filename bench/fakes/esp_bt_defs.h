@@ -0,0 +1,9 @@
+#ifndef FAKE_ESP_BT_DEFS_H
+#define FAKE_ESP_BT_DEFS_H
+
+#include <stdint.h>
+
+#define ESP_BD_ADDR_LEN 6
+typedef uint8_t esp_bd_addr_t[ESP_BD_ADDR_LEN];
+
+#endif
\ No newline at end of file
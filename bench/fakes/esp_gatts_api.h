@@ -0,0 +1,28 @@
+#ifndef FAKE_ESP_GATTS_API_H
+#define FAKE_ESP_GATTS_API_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_bt_defs.h"
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#define ESP_FAIL -1
+#endif
+typedef uint8_t esp_gatt_if_t;
+typedef enum {
+  ESP_GATTS_REG_EVT = 0, ESP_GATTS_READ_EVT = 1, ESP_GATTS_WRITE_EVT = 2, ESP_GATTS_EXEC_WRITE_EVT = 3,
+  ESP_GATTS_MTU_EVT = 4, ESP_GATTS_CONF_EVT = 5, ESP_GATTS_CONNECT_EVT = 14, ESP_GATTS_DISCONNECT_EVT = 15,
+  ESP_GATTS_CONGEST_EVT = 21
+} esp_gatts_cb_event_t;
+typedef union {
+  struct { uint16_t conn_id; esp_bd_addr_t remote_bda; } connect;
+  struct { uint16_t conn_id; esp_bd_addr_t remote_bda; int reason; } disconnect;
+  struct { uint16_t conn_id; uint16_t mtu; } mtu;
+  struct { uint16_t conn_id; uint32_t trans_id; esp_bd_addr_t bda; uint16_t handle; uint16_t offset; bool need_rsp; bool is_prep; uint16_t len; uint8_t* value; } write;
+  struct { uint16_t conn_id; bool congested; } congest;
+  struct { int status; uint16_t conn_id; uint16_t handle; } conf;
+} esp_ble_gatts_cb_param_t;
+esp_err_t esp_ble_gatts_send_indicate(esp_gatt_if_t gatts_if, uint16_t conn_id, uint16_t attr_handle, uint16_t value_len, uint8_t* value, bool need_confirm);
+
+#endif
\ No newline at end of file
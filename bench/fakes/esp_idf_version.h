@@ -0,0 +1,9 @@
+#ifndef FAKE_ESP_IDF_VERSION_H
+#define FAKE_ESP_IDF_VERSION_H
+
+// 與 Arduino-ESP32 2.x 相同的 ESP-IDF 4.4
+#define ESP_IDF_VERSION_MAJOR 4
+#define ESP_IDF_VERSION_MINOR 4
+#define ESP_IDF_VERSION_PATCH 0
+
+#endif
\ No newline at end of file
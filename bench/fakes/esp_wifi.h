@@ -0,0 +1,20 @@
+#ifndef FAKE_ESP_WIFI_H
+#define FAKE_ESP_WIFI_H
+
+#include "esp_wifi_types.h"
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#define ESP_FAIL -1
+#endif
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type);
+esp_err_t esp_wifi_get_ps(wifi_ps_type_t* type);
+esp_err_t esp_wifi_set_protocol(wifi_interface_t ifx, uint8_t protocol_bitmap);
+esp_err_t esp_wifi_get_config(wifi_interface_t ifx, wifi_config_t* conf);
+esp_err_t esp_wifi_set_config(wifi_interface_t ifx, wifi_config_t* conf);
+esp_err_t esp_wifi_ap_get_sta_list(wifi_sta_list_t* sta);
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t* ap_info);
+esp_err_t esp_wifi_scan_stop(void);
+esp_err_t esp_wifi_connect(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,384 @@
+#include "Arduino.h"
+#include "fake_control.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ==========================================
+// Arduino 核心、虛擬時鐘與 FreeRTOS 模擬
+// ==========================================
+
+HardwareSerial Serial;
+
+namespace fake {
+
+bool serialEcho = false;
+Counters counters;
+
+void resetCounters() {
+  memset(&counters, 0, sizeof(counters));
+}
+
+static std::atomic<unsigned long> _clockUs(0);
+
+void advance(unsigned long ms) {
+  _clockUs += ms * 1000UL;
+}
+
+void resetClock() {
+  _clockUs = 0;
+}
+
+}  // namespace fake
+
+unsigned long millis() {
+  return fake::_clockUs / 1000UL;
+}
+
+unsigned long micros() {
+  return fake::_clockUs;
+}
+
+void fake_wifiPump();
+void fake_blePump();
+
+// 推進時鐘後觸發到期的事件 (WiFi 事件只在主執行緒觸發)；
+// 其他任務(執行緒)短暫休眠，避免空轉搶佔主執行緒
+static std::thread::id _mainThread = std::this_thread::get_id();
+
+void delay(unsigned long ms) {
+  fake::advance(ms);
+  fake_blePump();
+  if (std::this_thread::get_id() != _mainThread) {
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  } else {
+    fake_wifiPump();
+    std::this_thread::yield();
+  }
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+uint32_t esp_random() {
+  // 固定種子的 xorshift，讓每次執行的結果一致
+  static uint32_t state = 0x2545F491;
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+// ==========================================
+// String
+// ==========================================
+
+String::String(const char* s) : _buf(NULL), _len(0) {
+  if (s != NULL) assign(s, strlen(s));
+}
+
+String::String(const String& other) : _buf(NULL), _len(0) {
+  assign(other.c_str(), other._len);
+}
+
+String::String(int value) : _buf(NULL), _len(0) {
+  char text[16];
+  assign(text, snprintf(text, sizeof(text), "%d", value));
+}
+
+String::String(unsigned int value) : _buf(NULL), _len(0) {
+  char text[16];
+  assign(text, snprintf(text, sizeof(text), "%u", value));
+}
+
+String::String(long value) : _buf(NULL), _len(0) {
+  char text[24];
+  assign(text, snprintf(text, sizeof(text), "%ld", value));
+}
+
+String::String(unsigned long value) : _buf(NULL), _len(0) {
+  char text[24];
+  assign(text, snprintf(text, sizeof(text), "%lu", value));
+}
+
+String::String(float value, unsigned char decimalPlaces) : _buf(NULL), _len(0) {
+  char text[32];
+  assign(text, snprintf(text, sizeof(text), "%.*f", decimalPlaces, value));
+}
+
+String::~String() {
+  delete[] _buf;
+}
+
+String& String::operator=(const String& other) {
+  if (this != &other) assign(other.c_str(), other._len);
+  return *this;
+}
+
+String& String::operator+=(const String& other) {
+  append(other.c_str(), other._len);
+  return *this;
+}
+
+String& String::operator+=(const char* s) {
+  if (s != NULL) append(s, strlen(s));
+  return *this;
+}
+
+String& String::operator+=(char c) {
+  append(&c, 1);
+  return *this;
+}
+
+int String::indexOf(const String& other) const {
+  const char* found = strstr(c_str(), other.c_str());
+  return found != NULL ? (int)(found - c_str()) : -1;
+}
+
+void String::trim() {
+  if (_len == 0) return;
+  const char* begin = _buf;
+  const char* end = _buf + _len;
+  while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '\r' || *begin == '\n')) begin++;
+  while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) end--;
+  _len = end - begin;
+  memmove(_buf, begin, _len);
+  _buf[_len] = '\0';
+}
+
+void String::assign(const char* s, size_t len) {
+  // 與 Arduino 相同: 空字串不配置記憶體，否則配置剛好足夠的緩衝區
+  if (len == 0) {
+    if (_buf != NULL) _buf[0] = '\0';
+    _len = 0;
+    return;
+  }
+  char* buf = new char[len + 1];
+  memcpy(buf, s, len);
+  buf[len] = '\0';
+  delete[] _buf;
+  _buf = buf;
+  _len = len;
+}
+
+void String::append(const char* s, size_t len) {
+  if (len == 0) return;
+  char* buf = new char[_len + len + 1];
+  if (_len > 0) memcpy(buf, _buf, _len);
+  memcpy(buf + _len, s, len);
+  buf[_len + len] = '\0';
+  delete[] _buf;
+  _buf = buf;
+  _len += len;
+}
+
+String operator+(const String& a, const String& b) {
+  String result(a);
+  result += b;
+  return result;
+}
+
+// ==========================================
+// Print / Serial
+// ==========================================
+
+int Print::printf(const char* format, ...) {
+  char text[256];
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  write(text);
+  return n;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (fake::serialEcho) fputc(c, stdout);
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (fake::serialEcho) fwrite(buffer, 1, size, stdout);
+  return size;
+}
+
+bool IPAddress::fromString(const char* address) {
+  unsigned int a, b, c, d;
+  char extra;
+  if (sscanf(address, "%u.%u.%u.%u%c", &a, &b, &c, &d, &extra) != 4 ||
+      a > 255 || b > 255 || c > 255 || d > 255) {
+    return false;
+  }
+  *this = IPAddress(a, b, c, d);
+  return true;
+}
+
+// ==========================================
+// 臨界區段
+// ==========================================
+
+static std::recursive_mutex _criticalMutex;
+
+void fake_enterCritical(portMUX_TYPE* mux) {
+  _criticalMutex.lock();
+}
+
+void fake_exitCritical(portMUX_TYPE* mux) {
+  _criticalMutex.unlock();
+}
+
+// ==========================================
+// FreeRTOS 任務與佇列
+// ==========================================
+
+// 任務函式呼叫 vTaskDelete(NULL) 時以例外結束執行緒
+struct FakeTaskExit {};
+
+struct FakeTask {
+  TaskFunction_t fn;
+  void* arg;
+};
+
+static thread_local FakeTask* _currentTask = NULL;
+
+static void _taskEntry(FakeTask* task) {
+  _currentTask = task;
+  try {
+    task->fn(task->arg);
+  } catch (const FakeTaskExit&) {
+  }
+  _currentTask = NULL;
+  delete task;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackSize, void* arg, UBaseType_t priority, TaskHandle_t* handle) {
+  FakeTask* task = new FakeTask{fn, arg};
+  if (handle != NULL) *handle = task;
+  std::thread(_taskEntry, task).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackSize, void* arg, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+  return xTaskCreate(fn, name, stackSize, arg, priority, handle);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  // 只支援任務刪除自己 (本函式庫的用法)
+  if (task == NULL || task == _currentTask) throw FakeTaskExit();
+}
+
+void vTaskDelay(TickType_t ticks) {
+  delay(ticks);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return _currentTask;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  return 0;
+}
+
+struct FakeQueue {
+  std::mutex mutex;
+  std::deque<std::vector<uint8_t>> items;
+  UBaseType_t length;
+  UBaseType_t itemSize;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  FakeQueue* queue = new FakeQueue();
+  queue->length = length;
+  queue->itemSize = itemSize;
+  return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t handle, const void* item, TickType_t wait) {
+  FakeQueue* queue = (FakeQueue*)handle;
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  if (queue->items.size() >= queue->length) return pdFALSE;
+  const uint8_t* bytes = (const uint8_t*)item;
+  queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t handle, void* item, TickType_t wait) {
+  FakeQueue* queue = (FakeQueue*)handle;
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  if (queue->items.empty()) return pdFALSE;
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t handle) {
+  FakeQueue* queue = (FakeQueue*)handle;
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  return queue->items.size();
+}
+
+void vQueueDelete(QueueHandle_t handle) {
+  delete (FakeQueue*)handle;
+}
+
+// 互斥鎖與二元號誌 (等待時間以實際時間計算)
+struct FakeSemaphore {
+  std::mutex mutex;
+  std::condition_variable cond;
+  UBaseType_t count;
+  bool recursive;
+  std::thread::id owner;
+  UBaseType_t depth;
+};
+
+static SemaphoreHandle_t _semaphoreCreate(UBaseType_t count, bool recursive) {
+  FakeSemaphore* semaphore = new FakeSemaphore();
+  semaphore->count = count;
+  semaphore->recursive = recursive;
+  semaphore->depth = 0;
+  return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return _semaphoreCreate(1, false); }
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return _semaphoreCreate(1, true); }
+SemaphoreHandle_t xSemaphoreCreateBinary() { return _semaphoreCreate(0, false); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t handle, TickType_t wait) {
+  FakeSemaphore* semaphore = (FakeSemaphore*)handle;
+  std::unique_lock<std::mutex> lock(semaphore->mutex);
+  if (semaphore->recursive && semaphore->depth > 0 && semaphore->owner == std::this_thread::get_id()) {
+    semaphore->depth++;
+    return pdTRUE;
+  }
+  if (wait == portMAX_DELAY) {
+    semaphore->cond.wait(lock, [semaphore] { return semaphore->count > 0; });
+  } else if (!semaphore->cond.wait_for(lock, std::chrono::milliseconds(wait), [semaphore] { return semaphore->count > 0; })) {
+    return pdFALSE;
+  }
+  semaphore->count--;
+  semaphore->owner = std::this_thread::get_id();
+  semaphore->depth = 1;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t handle) {
+  FakeSemaphore* semaphore = (FakeSemaphore*)handle;
+  std::lock_guard<std::mutex> lock(semaphore->mutex);
+  if (semaphore->recursive && --semaphore->depth > 0) return pdTRUE;
+  if (semaphore->count > 0) return pdFALSE;
+  semaphore->depth = 0;
+  semaphore->count++;
+  semaphore->cond.notify_one();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t handle, TickType_t wait) { return xSemaphoreTake(handle, wait); }
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t handle) { return xSemaphoreGive(handle); }
+
+void vSemaphoreDelete(SemaphoreHandle_t handle) {
+  delete (FakeSemaphore*)handle;
+}
\ No newline at end of file
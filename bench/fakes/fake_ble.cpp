@@ -0,0 +1,293 @@
+#include "BLEDevice.h"
+#include "BLE2902.h"
+#include "Preferences.h"
+#include "fake_control.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ==========================================
+// BLE 模擬
+// fake::bleConnect/bleWrite 以註冊的 GATTS 處理函式與特徵回調模擬用戶端，
+// 通知依 fake::ble 注入失敗與壅塞
+// ==========================================
+
+static gatts_event_handler _bleGattsHandler = NULL;
+static BLEServer* _bleServer = NULL;
+static BLECharacteristic* _bleCharacteristic = NULL;
+static BLEAdvertising _bleAdvertising;
+static uint16_t _bleLocalMTU = 23;
+static uint16_t _bleNextHandle = 0x2A;
+static bool _bleAdvertisingActive = false;
+
+// 壅塞中的連線與預定解除的時間 (固定大小，避免模擬本身配置記憶體而影響量測)
+#define FAKE_BLE_MAX_CONGESTED 8
+
+typedef struct {
+  bool active;
+  uint16_t connId;
+  unsigned long releaseAt;
+} FakeBLECongestion;
+
+static std::mutex _bleCongestMutex;
+static FakeBLECongestion _bleCongested[FAKE_BLE_MAX_CONGESTED];
+
+void fake_bleSetConnectedCount(BLEServer* server, int delta) {
+  server->_connectedCount += delta;
+}
+
+static void _bleDispatch(esp_gatts_cb_event_t event, esp_ble_gatts_cb_param_t& param) {
+  if (_bleGattsHandler != NULL) {
+    _bleGattsHandler(event, 3, &param);
+  }
+}
+
+static void _bleSetCongested(uint16_t connId, bool congested, unsigned long releaseAt) {
+  std::lock_guard<std::mutex> lock(_bleCongestMutex);
+  int freeSlot = -1;
+  for (int i = 0; i < FAKE_BLE_MAX_CONGESTED; i++) {
+    if (_bleCongested[i].active && _bleCongested[i].connId == connId) {
+      _bleCongested[i].active = congested;
+      _bleCongested[i].releaseAt = releaseAt;
+      return;
+    }
+    if (!_bleCongested[i].active && freeSlot < 0) freeSlot = i;
+  }
+  if (congested && freeSlot >= 0) {
+    _bleCongested[freeSlot].active = true;
+    _bleCongested[freeSlot].connId = connId;
+    _bleCongested[freeSlot].releaseAt = releaseAt;
+  }
+}
+
+/**
+ * 解除時間已到的壅塞 (由 delay() 呼叫)
+ */
+void fake_blePump() {
+  uint16_t released[FAKE_BLE_MAX_CONGESTED];
+  int count = 0;
+  {
+    std::lock_guard<std::mutex> lock(_bleCongestMutex);
+    unsigned long now = millis();
+    for (int i = 0; i < FAKE_BLE_MAX_CONGESTED; i++) {
+      if (_bleCongested[i].active && (long)(now - _bleCongested[i].releaseAt) >= 0) {
+        _bleCongested[i].active = false;
+        released[count++] = _bleCongested[i].connId;
+      }
+    }
+  }
+  for (int i = 0; i < count; i++) {
+    esp_ble_gatts_cb_param_t param;
+    memset(&param, 0, sizeof(param));
+    param.congest.conn_id = released[i];
+    param.congest.congested = false;
+    _bleDispatch(ESP_GATTS_CONGEST_EVT, param);
+  }
+}
+
+namespace fake {
+
+BLEScript ble = {0, 0};
+
+void bleConnect(uint16_t connId, uint16_t mtu, bool subscribe) {
+  esp_ble_gatts_cb_param_t param;
+  memset(&param, 0, sizeof(param));
+  param.connect.conn_id = connId;
+  for (int i = 0; i < 6; i++) param.connect.remote_bda[i] = 0xA0 + i + connId;
+  _bleDispatch(ESP_GATTS_CONNECT_EVT, param);
+
+  // 藍牙堆疊在建立連線時停止廣播
+  _bleAdvertisingActive = false;
+  if (_bleServer != NULL) {
+    fake_bleSetConnectedCount(_bleServer, 1);
+    if (_bleServer->getCallbacks() != NULL) _bleServer->getCallbacks()->onConnect(_bleServer, &param);
+  }
+
+  memset(&param, 0, sizeof(param));
+  param.mtu.conn_id = connId;
+  param.mtu.mtu = mtu < _bleLocalMTU ? mtu : _bleLocalMTU;
+  _bleDispatch(ESP_GATTS_MTU_EVT, param);
+
+  if (subscribe && _bleCharacteristic != NULL) {
+    BLEDescriptor* cccd = _bleCharacteristic->getDescriptorByUUID("2902");
+    uint8_t value[2] = {0x01, 0x00};
+    memset(&param, 0, sizeof(param));
+    param.write.conn_id = connId;
+    param.write.handle = cccd != NULL ? cccd->getHandle() : 0;
+    param.write.len = 2;
+    param.write.value = value;
+    _bleDispatch(ESP_GATTS_WRITE_EVT, param);
+  }
+}
+
+void bleDisconnect(uint16_t connId) {
+  esp_ble_gatts_cb_param_t param;
+  memset(&param, 0, sizeof(param));
+  param.disconnect.conn_id = connId;
+  param.disconnect.reason = 0x13;
+  _bleDispatch(ESP_GATTS_DISCONNECT_EVT, param);
+
+  if (_bleServer != NULL) {
+    fake_bleSetConnectedCount(_bleServer, -1);
+    if (_bleServer->getCallbacks() != NULL) _bleServer->getCallbacks()->onDisconnect(_bleServer, &param);
+  }
+  _bleSetCongested(connId, false, 0);
+}
+
+void bleWrite(uint16_t connId, const uint8_t* data, size_t length) {
+  if (_bleCharacteristic == NULL) return;
+
+  esp_ble_gatts_cb_param_t param;
+  memset(&param, 0, sizeof(param));
+  param.write.conn_id = connId;
+  param.write.handle = _bleCharacteristic->getHandle();
+  param.write.len = length;
+  param.write.value = (uint8_t*)data;
+  _bleDispatch(ESP_GATTS_WRITE_EVT, param);
+
+  _bleCharacteristic->setValue((uint8_t*)data, length);
+  if (_bleCharacteristic->getCallbacks() != NULL) {
+    _bleCharacteristic->getCallbacks()->onWrite(_bleCharacteristic, &param);
+  }
+}
+
+}  // namespace fake
+
+esp_err_t esp_ble_gatts_send_indicate(esp_gatt_if_t gatts_if, uint16_t conn_id, uint16_t attr_handle, uint16_t value_len, uint8_t* value, bool need_confirm) {
+  fake::counters.bleNotifies++;
+
+  bool fail = fake::ble.failNotifyEveryN > 0 && fake::counters.bleNotifies % fake::ble.failNotifyEveryN == 0;
+  if (!fail) {
+    fake::counters.bleBytes += value_len;
+    return ESP_OK;
+  }
+
+  fake::counters.bleNotifyFailures++;
+  if (fake::ble.congestMs > 0) {
+    _bleSetCongested(conn_id, true, millis() + fake::ble.congestMs);
+    esp_ble_gatts_cb_param_t param;
+    memset(&param, 0, sizeof(param));
+    param.congest.conn_id = conn_id;
+    param.congest.congested = true;
+    _bleDispatch(ESP_GATTS_CONGEST_EVT, param);
+  }
+  return ESP_FAIL;
+}
+
+// ==========================================
+// BLE 類別
+// ==========================================
+
+void BLECharacteristic::addDescriptor(BLEDescriptor* descriptor) {
+  descriptor->_handle = _bleNextHandle++;
+  _descriptor = descriptor;
+}
+
+void BLECharacteristic::notify(bool isNotification) {
+  esp_ble_gatts_send_indicate(3, 0, _handle, _value.size(), (uint8_t*)_value.data(), !isNotification);
+}
+
+BLECharacteristic* BLEService::createCharacteristic(const char* uuid, uint32_t properties) {
+  _bleCharacteristic = new BLECharacteristic(_bleNextHandle++);
+  return _bleCharacteristic;
+}
+
+BLEService* BLEServer::createService(const char* uuid) {
+  return new BLEService();
+}
+
+void BLEServer::startAdvertising() { _bleAdvertising.start(); }
+void BLEServer::disconnect(uint16_t connId) { fake::bleDisconnect(connId); }
+BLEAdvertising* BLEServer::getAdvertising() { return &_bleAdvertising; }
+
+void BLEAdvertising::start() { _bleAdvertisingActive = true; }
+void BLEAdvertising::stop() { _bleAdvertisingActive = false; }
+
+void BLEDevice::init(std::string deviceName) {}
+
+BLEServer* BLEDevice::createServer() {
+  _bleServer = new BLEServer();
+  return _bleServer;
+}
+
+BLEAdvertising* BLEDevice::getAdvertising() { return &_bleAdvertising; }
+void BLEDevice::startAdvertising() { _bleAdvertising.start(); }
+void BLEDevice::stopAdvertising() { _bleAdvertising.stop(); }
+
+esp_err_t BLEDevice::setMTU(uint16_t mtu) {
+  _bleLocalMTU = mtu;
+  return ESP_OK;
+}
+
+uint16_t BLEDevice::getMTU() { return _bleLocalMTU; }
+
+void BLEDevice::setCustomGattsHandler(gatts_event_handler customGattsHandler) {
+  _bleGattsHandler = customGattsHandler;
+}
+
+// ==========================================
+// Preferences (以記憶體模擬 NVS)
+// ==========================================
+
+typedef std::map<std::string, std::vector<uint8_t>> FakeNvsNamespace;
+static std::map<std::string, FakeNvsNamespace> _nvs;
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partition_label) {
+  if (_open) return false;
+  _namespace = name;
+  _readOnly = readOnly;
+  _open = true;
+  return true;
+}
+
+void Preferences::end() {
+  _open = false;
+}
+
+bool Preferences::clear() {
+  if (!_open || _readOnly) return false;
+  _nvs[_namespace].clear();
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!_open || _readOnly) return false;
+  return _nvs[_namespace].erase(key) > 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+  if (!_open || _readOnly) return 0;
+  const uint8_t* bytes = (const uint8_t*)value;
+  _nvs[_namespace][key] = std::vector<uint8_t>(bytes, bytes + len);
+  return len;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+  if (!_open) return 0;
+  FakeNvsNamespace& ns = _nvs[_namespace];
+  FakeNvsNamespace::iterator it = ns.find(key);
+  if (it == ns.end() || it->second.size() > maxLen) return 0;
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  if (!_open) return 0;
+  FakeNvsNamespace& ns = _nvs[_namespace];
+  FakeNvsNamespace::iterator it = ns.find(key);
+  return it != ns.end() ? it->second.size() : 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  return _open && _nvs[_namespace].count(key) > 0;
+}
+
+size_t Preferences::putUInt(const char* key, uint32_t value) {
+  return putBytes(key, &value, sizeof(value));
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+  uint32_t value;
+  return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "BluetoothSerial.h"
+#include "fake_control.h"
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ==========================================
+// BluetoothSerial 模擬
+// 掃描時依序回報 fake::btAddDevice 加入的設備，接收資料由 fake::btFeed 提供
+// ==========================================
+
+class FakeBTDevice : public BTAdvertisedDevice {
+public:
+  FakeBTDevice(const char* name, const uint8_t address[6], int8_t rssi)
+    : _name(name), _address(const_cast<uint8_t*>(address)), _rssi(rssi) {}
+  std::string getName() const override { return _name; }
+  BTAddress getAddress() override { return _address; }
+  int8_t getRSSI() const override { return _rssi; }
+  bool haveName() const override { return !_name.empty(); }
+
+private:
+  std::string _name;
+  BTAddress _address;
+  int8_t _rssi;
+};
+
+static std::vector<FakeBTDevice> _btDevices;
+static std::mutex _btRxMutex;
+static std::deque<uint8_t> _btRx;
+static bool _btConnected = false;
+
+namespace fake {
+
+BTScript bt = {200, false};
+
+void btAddDevice(const char* name, const uint8_t address[6], int8_t rssi) {
+  _btDevices.push_back(FakeBTDevice(name, address, rssi));
+}
+
+void btClearDevices() {
+  _btDevices.clear();
+}
+
+void btSetConnected(bool connected) {
+  _btConnected = connected;
+}
+
+void btFeed(const uint8_t* data, size_t length) {
+  std::lock_guard<std::mutex> lock(_btRxMutex);
+  _btRx.insert(_btRx.end(), data, data + length);
+}
+
+}  // namespace fake
+
+std::string BTAddress::toString(bool capital) const {
+  char text[18];
+  snprintf(text, sizeof(text), capital ? "%02X:%02X:%02X:%02X:%02X:%02X" : "%02x:%02x:%02x:%02x:%02x:%02x",
+           _address[0], _address[1], _address[2], _address[3], _address[4], _address[5]);
+  return text;
+}
+
+bool BluetoothSerial::begin(String localName, bool isMaster) {
+  return true;
+}
+
+int BluetoothSerial::available() {
+  std::lock_guard<std::mutex> lock(_btRxMutex);
+  return _btRx.size();
+}
+
+int BluetoothSerial::peek() {
+  std::lock_guard<std::mutex> lock(_btRxMutex);
+  return _btRx.empty() ? -1 : _btRx.front();
+}
+
+int BluetoothSerial::read() {
+  std::lock_guard<std::mutex> lock(_btRxMutex);
+  if (_btRx.empty()) return -1;
+  uint8_t c = _btRx.front();
+  _btRx.pop_front();
+  return c;
+}
+
+size_t BluetoothSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t BluetoothSerial::write(const uint8_t* buffer, size_t size) {
+  if (!_btConnected) return 0;
+  fake::counters.btWrites++;
+  fake::counters.btBytes += size;
+  return size;
+}
+
+bool BluetoothSerial::connect(String remoteName) {
+  for (size_t i = 0; i < _btDevices.size(); i++) {
+    if (_btDevices[i].getName() == remoteName.c_str()) {
+      uint8_t address[6];
+      memcpy(address, *_btDevices[i].getAddress().getNative(), 6);
+      return connect(address);
+    }
+  }
+  delay(fake::bt.connectMs);
+  return false;
+}
+
+bool BluetoothSerial::connect(uint8_t remoteAddress[], int channel) {
+  delay(fake::bt.connectMs);
+  if (fake::bt.failConnect) return false;
+  for (size_t i = 0; i < _btDevices.size(); i++) {
+    if (memcmp(*_btDevices[i].getAddress().getNative(), remoteAddress, 6) == 0) {
+      _btConnected = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BluetoothSerial::connect() {
+  return _btConnected;
+}
+
+bool BluetoothSerial::connected(int timeout) {
+  return _btConnected;
+}
+
+bool BluetoothSerial::disconnect() {
+  _btConnected = false;
+  return true;
+}
+
+bool BluetoothSerial::discoverAsync(BTAdvertisedDeviceCb cb, int timeout) {
+  // 直接在呼叫者的執行緒中回報所有設備，相當於掃描立即收到全部回應
+  for (size_t i = 0; i < _btDevices.size(); i++) {
+    cb(&_btDevices[i]);
+  }
+  return true;
+}
+
+void BluetoothSerial::discoverAsyncStop() {}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#ifndef FAKE_CONTROL_H
+#define FAKE_CONTROL_H
+
+// ==========================================
+// 模擬後端的控制介面
+// 基準測試透過此介面設定各模組的延遲與失敗注入，並讀取呼叫次數
+// 所有延遲皆以虛擬時鐘(毫秒)計算，由 delay() 與 fake::advance() 推進
+// ==========================================
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace fake {
+
+// 虛擬時鐘
+void advance(unsigned long ms);
+void resetClock();
+
+// 是否將 Serial 輸出印到 stdout (預設捨棄)
+extern bool serialEcho;
+
+// WiFi: 掃描、關聯與 DHCP 各階段的延遲
+typedef struct {
+  unsigned long scanMs;         // 每次掃描 (單一頻道或全頻道) 耗時
+  unsigned long assocMs;        // begin() 到 STA_CONNECTED 的時間
+  unsigned long dhcpMs;         // STA_CONNECTED 到 GOT_IP 的時間
+  uint32_t failAssocEveryN;     // 每 N 次 begin() 有一次無法關聯 (0 為不失敗)
+} WifiScript;
+
+extern WifiScript wifi;
+void wifiAddAP(const char* ssid, int8_t rssi, uint8_t channel);
+void wifiClearAPs();
+// 站台加入/離開本機 AP，立即觸發 STACONNECTED、STAIPASSIGNED (ip 非0時) 與 STADISCONNECTED 事件
+void apStationJoin(const uint8_t mac[6], int8_t rssi, uint32_t ip);
+void apStationLeave(const uint8_t mac[6]);
+
+// MQTT: 連線與發布的延遲及失敗注入
+typedef struct {
+  unsigned long connectMs;      // connect() 耗時
+  unsigned long publishMs;      // 每次 publish()/endPublish() 耗時
+  uint32_t failPublishEveryN;   // 每 N 次發布有一次失敗 (0 為不失敗)
+  bool refuseConnect;           // connect() 一律失敗
+  bool autoPuback;              // 對直接寫入的 QoS 1 PUBLISH 封包自動回覆 PUBACK
+  uint32_t clientWriteLimit;    // WiFiClient::write() 每次最多寫出的位元組數，模擬傳送緩衝區已滿 (0 為不限制)
+} MqttScript;
+
+extern MqttScript mqtt;
+void mqttDropConnection();
+// 模擬伺服器送來一則訊息，於下一次 loop() 交給回調函式
+void mqttInject(const char* topic, const uint8_t* payload, size_t length);
+
+// 傳統藍牙: 連線延遲、掃描結果與接收資料
+typedef struct {
+  unsigned long connectMs;      // connect() 耗時
+  bool failConnect;             // connect() 一律失敗
+} BTScript;
+
+extern BTScript bt;
+void btAddDevice(const char* name, const uint8_t address[6], int8_t rssi);
+void btClearDevices();
+void btSetConnected(bool connected);
+// 將資料放入 SerialBT 的接收緩衝區
+void btFeed(const uint8_t* data, size_t length);
+
+// 低功耗藍牙: 透過已註冊的 GATTS 處理函式模擬用戶端
+typedef struct {
+  uint32_t failNotifyEveryN;    // 每 N 次通知有一次失敗 (0 為不失敗)
+  unsigned long congestMs;      // 失敗時同時回報壅塞的持續時間 (0 為不回報)
+} BLEScript;
+
+extern BLEScript ble;
+void bleConnect(uint16_t connId, uint16_t mtu, bool subscribe);
+void bleDisconnect(uint16_t connId);
+void bleWrite(uint16_t connId, const uint8_t* data, size_t length);
+
+// 呼叫次數統計
+typedef struct {
+  uint32_t wifiScans;
+  uint32_t wifiBegins;
+  uint32_t mqttConnects;
+  uint32_t mqttPublishes;
+  uint32_t mqttPublishFailures;
+  uint32_t mqttBytes;
+  uint32_t btWrites;
+  uint32_t btBytes;
+  uint32_t bleNotifies;
+  uint32_t bleNotifyFailures;
+  uint32_t bleBytes;
+} Counters;
+
+extern Counters counters;
+void resetCounters();
+
+}  // namespace fake
+
+#endif
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "PubSubClient.h"
+#include "fake_control.h"
+#include <deque>
+#include <string>
+
+// ==========================================
+// PubSubClient 模擬
+// 發布不經過網路，只依 fake::mqtt 推進虛擬時鐘並注入失敗；
+// 直接以 write() 寫入的封包 (QoS 1) 會轉交給底層的 Client
+// ==========================================
+
+namespace fake {
+
+MqttScript mqtt = {20, 1, 0, false, true, 0};
+
+typedef struct {
+  std::string topic;
+  std::string payload;
+} FakeMqttMessage;
+
+static std::deque<FakeMqttMessage> _mqttInbox;
+static bool _mqttDropped = false;
+
+void mqttDropConnection() {
+  _mqttDropped = true;
+}
+
+void mqttInject(const char* topic, const uint8_t* payload, size_t length) {
+  _mqttInbox.push_back({topic, std::string((const char*)payload, length)});
+}
+
+}  // namespace fake
+
+PubSubClient::PubSubClient(Client& client)
+  : _client(&client), _bufferSize(MQTT_MAX_PACKET_SIZE), _state(MQTT_DISCONNECTED),
+    _streaming(false), _streamExpected(0), _streamWritten(0) {}
+
+PubSubClient& PubSubClient::setServer(const char* domain, uint16_t port) { return *this; }
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+  _callback = callback;
+  return *this;
+}
+
+PubSubClient& PubSubClient::setKeepAlive(uint16_t keepAlive) { return *this; }
+PubSubClient& PubSubClient::setSocketTimeout(uint16_t timeout) { return *this; }
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+  if (size == 0) return false;
+  _bufferSize = size;
+  return true;
+}
+
+uint16_t PubSubClient::getBufferSize() { return _bufferSize; }
+
+bool PubSubClient::connect(const char* id) {
+  return connect(id, NULL, NULL, NULL, 0, false, NULL, true);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+  return connect(id, user, pass, NULL, 0, false, NULL, true);
+}
+
+bool PubSubClient::connect(const char* id, const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage) {
+  return connect(id, NULL, NULL, willTopic, willQos, willRetain, willMessage, true);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage) {
+  return connect(id, user, pass, willTopic, willQos, willRetain, willMessage, true);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage, bool cleanSession) {
+  fake::counters.mqttConnects++;
+  delay(fake::mqtt.connectMs);
+
+  if (fake::mqtt.refuseConnect || !_client->connect("broker", 1883)) {
+    _client->stop();
+    _state = MQTT_CONNECT_FAILED;
+    return false;
+  }
+  fake::_mqttDropped = false;
+  _state = MQTT_CONNECTED;
+  return true;
+}
+
+void PubSubClient::disconnect() {
+  _client->stop();
+  _state = MQTT_DISCONNECTED;
+  _streaming = false;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload) {
+  return publish(topic, (const uint8_t*)payload, strlen(payload), false);
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+  return publish(topic, (const uint8_t*)payload, strlen(payload), retained);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength) {
+  return publish(topic, payload, plength, false);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength, bool retained) {
+  if (!connected()) return false;
+  // 與 PubSubClient 相同: 封包超過緩衝區大小時失敗
+  size_t packetSize = MQTT_MAX_HEADER_SIZE + 2 + strlen(topic) + plength;
+  if (packetSize > _bufferSize) return false;
+  return finishPublish(plength);
+}
+
+bool PubSubClient::beginPublish(const char* topic, unsigned int plength, bool retained) {
+  if (!connected()) return false;
+  _streaming = true;
+  _streamExpected = plength;
+  _streamWritten = 0;
+  return true;
+}
+
+int PubSubClient::endPublish() {
+  if (!_streaming) return 0;
+  _streaming = false;
+  if (_streamWritten != _streamExpected) return 0;
+  return finishPublish(_streamWritten) ? 1 : 0;
+}
+
+size_t PubSubClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t PubSubClient::write(const uint8_t* buffer, size_t size) {
+  if (_streaming) {
+    _streamWritten += size;
+    return size;
+  }
+  return _client->write(buffer, size);
+}
+
+bool PubSubClient::finishPublish(size_t length) {
+  fake::counters.mqttPublishes++;
+  delay(fake::mqtt.publishMs);
+
+  if (fake::mqtt.failPublishEveryN > 0 && fake::counters.mqttPublishes % fake::mqtt.failPublishEveryN == 0) {
+    fake::counters.mqttPublishFailures++;
+    return false;
+  }
+  fake::counters.mqttBytes += length;
+  return true;
+}
+
+bool PubSubClient::subscribe(const char* topic) { return subscribe(topic, 0); }
+bool PubSubClient::subscribe(const char* topic, uint8_t qos) { return connected(); }
+bool PubSubClient::unsubscribe(const char* topic) { return connected(); }
+
+bool PubSubClient::loop() {
+  if (!connected()) return false;
+
+  // 讀取底層連線的資料 (例如 PUBACK)，讓包裝的 Client 能解析
+  uint8_t buffer[64];
+  while (_client->available() > 0) {
+    _client->read(buffer, sizeof(buffer));
+  }
+
+  // 一次交出一則伺服器訊息，與 PubSubClient 每次 loop() 處理一個封包相同
+  if (!fake::_mqttInbox.empty()) {
+    fake::FakeMqttMessage message = fake::_mqttInbox.front();
+    fake::_mqttInbox.pop_front();
+    if (_callback) {
+      _callback((char*)message.topic.c_str(), (uint8_t*)&message.payload[0], message.payload.size());
+    }
+  }
+  return connected();
+}
+
+bool PubSubClient::connected() {
+  if (_state == MQTT_CONNECTED && (fake::_mqttDropped || !_client->connected())) {
+    fake::_mqttDropped = false;
+    _client->stop();
+    _state = MQTT_CONNECTION_LOST;
+  }
+  return _state == MQTT_CONNECTED;
+}
+
+int PubSubClient::state() { return _state; }
\ No newline at end of file
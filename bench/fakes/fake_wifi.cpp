@@ -0,0 +1,660 @@
+#include "WiFi.h"
+#include "esp_wifi.h"
+#include "ping/ping_sock.h"
+#include "fake_control.h"
+#include <deque>
+#include <vector>
+
+// ==========================================
+// WiFi 模擬
+// begin() 之後依 fake::wifi 的延遲依序觸發 STA_CONNECTED 與 GOT_IP 事件
+// ==========================================
+
+WiFiClass WiFi;
+
+namespace fake {
+
+WifiScript wifi = {50, 30, 20, 0};
+static std::vector<wifi_ap_record_t> _aps;
+
+void wifiAddAP(const char* ssid, int8_t rssi, uint8_t channel) {
+  wifi_ap_record_t record;
+  memset(&record, 0, sizeof(record));
+  strncpy((char*)record.ssid, ssid, sizeof(record.ssid) - 1);
+  for (int i = 0; i < 6; i++) record.bssid[i] = 0x10 * (i + 1) + (uint8_t)_aps.size();
+  record.primary = channel;
+  record.rssi = rssi;
+  record.authmode = WIFI_AUTH_WPA2_PSK;
+  _aps.push_back(record);
+}
+
+void wifiClearAPs() {
+  _aps.clear();
+}
+
+}  // namespace fake
+
+typedef struct {
+  WiFiEventFuncCb callback;
+  arduino_event_id_t event;
+} FakeWifiHandler;
+
+static std::vector<FakeWifiHandler> _wifiHandlers;
+static wifi_mode_t _wifiMode = WIFI_MODE_NULL;
+static wl_status_t _wifiStatus = WL_DISCONNECTED;
+
+// 掃描狀態
+static bool _wifiScanning = false;      // 驅動程式正在掃描
+static bool _wifiScanDone = false;      // 結果可供讀取 (直到 scanDelete)
+static unsigned long _wifiScanDoneAt = 0;
+static std::vector<wifi_ap_record_t> _wifiScanResults;
+
+// 連線狀態: 關聯與取得IP的預定時間
+static const wifi_ap_record_t* _wifiTarget = NULL;
+static unsigned long _wifiAssocAt = 0;
+static unsigned long _wifiGotIpAt = 0;
+static bool _wifiAssocPending = false;
+static bool _wifiIpPending = false;
+static IPAddress _wifiStaticIP;
+
+static IPAddress _wifiAPIP(192, 168, 4, 1);
+static bool _wifiAPActive = false;
+static wifi_config_t _wifiApConfig;
+static wifi_config_t _wifiStaConfig;
+
+static void _wifiFire(arduino_event_id_t event, arduino_event_info_t& info) {
+  for (size_t i = 0; i < _wifiHandlers.size(); i++) {
+    if (_wifiHandlers[i].event == event || _wifiHandlers[i].event == ARDUINO_EVENT_MAX) {
+      _wifiHandlers[i].callback(event, info);
+    }
+  }
+}
+
+// 連接到 AP 的站台
+static std::vector<wifi_sta_info_t> _wifiAPStations;
+static uint8_t _wifiNextAid = 1;
+
+namespace fake {
+
+void apStationJoin(const uint8_t mac[6], int8_t rssi, uint32_t ip) {
+  wifi_sta_info_t station;
+  memset(&station, 0, sizeof(station));
+  memcpy(station.mac, mac, 6);
+  station.rssi = rssi;
+  _wifiAPStations.push_back(station);
+
+  arduino_event_info_t info;
+  memset(&info, 0, sizeof(info));
+  memcpy(info.wifi_ap_staconnected.mac, mac, 6);
+  info.wifi_ap_staconnected.aid = _wifiNextAid++;
+  _wifiFire(ARDUINO_EVENT_WIFI_AP_STACONNECTED, info);
+
+  if (ip != 0) {
+    memset(&info, 0, sizeof(info));
+    info.wifi_ap_staipassigned.ip.addr = ip;
+    _wifiFire(ARDUINO_EVENT_WIFI_AP_STAIPASSIGNED, info);
+  }
+}
+
+void apStationLeave(const uint8_t mac[6]) {
+  for (size_t i = 0; i < _wifiAPStations.size(); i++) {
+    if (memcmp(_wifiAPStations[i].mac, mac, 6) == 0) {
+      _wifiAPStations.erase(_wifiAPStations.begin() + i);
+      break;
+    }
+  }
+
+  arduino_event_info_t info;
+  memset(&info, 0, sizeof(info));
+  memcpy(info.wifi_ap_stadisconnected.mac, mac, 6);
+  _wifiFire(ARDUINO_EVENT_WIFI_AP_STADISCONNECTED, info);
+}
+
+}  // namespace fake
+
+/**
+ * 觸發時間已到的事件 (由 status()、scanComplete() 與主執行緒的 delay() 呼叫)
+ */
+void fake_wifiPump() {
+  unsigned long now = millis();
+  arduino_event_info_t info;
+  memset(&info, 0, sizeof(info));
+
+  if (_wifiAssocPending && (long)(now - _wifiAssocAt) >= 0) {
+    _wifiAssocPending = false;
+    memcpy(info.wifi_sta_connected.ssid, _wifiTarget->ssid, 32);
+    memcpy(info.wifi_sta_connected.bssid, _wifiTarget->bssid, 6);
+    info.wifi_sta_connected.channel = _wifiTarget->primary;
+    _wifiFire(ARDUINO_EVENT_WIFI_STA_CONNECTED, info);
+  }
+  if (!_wifiAssocPending && _wifiIpPending && (long)(now - _wifiGotIpAt) >= 0) {
+    _wifiIpPending = false;
+    _wifiStatus = WL_CONNECTED;
+    info.got_ip.ip_info.ip.addr = (uint32_t)WiFi.localIP();
+    _wifiFire(ARDUINO_EVENT_WIFI_STA_GOT_IP, info);
+  }
+}
+
+// ==========================================
+// WiFiClass
+// ==========================================
+
+bool WiFiClass::mode(wifi_mode_t m) {
+  _wifiMode = m;
+  return true;
+}
+
+wifi_mode_t WiFiClass::getMode() {
+  return _wifiMode;
+}
+
+bool WiFiClass::enableSTA(bool enable) {
+  bool ap = _wifiMode == WIFI_MODE_AP || _wifiMode == WIFI_MODE_APSTA;
+  _wifiMode = enable ? (ap ? WIFI_MODE_APSTA : WIFI_MODE_STA) : (ap ? WIFI_MODE_AP : WIFI_MODE_NULL);
+  return true;
+}
+
+bool WiFiClass::enableAP(bool enable) {
+  bool sta = _wifiMode == WIFI_MODE_STA || _wifiMode == WIFI_MODE_APSTA;
+  _wifiMode = enable ? (sta ? WIFI_MODE_APSTA : WIFI_MODE_AP) : (sta ? WIFI_MODE_STA : WIFI_MODE_NULL);
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  fake_wifiPump();
+  return _wifiStatus;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase, int32_t channel, const uint8_t* bssid, bool connect) {
+  fake::counters.wifiBegins++;
+  disconnect();
+  enableSTA(true);
+
+  // 與核心相同: 以新的 STA 設定取代目前的設定 (listen_interval 為 0)
+  memset(&_wifiStaConfig, 0, sizeof(_wifiStaConfig));
+  memcpy(_wifiStaConfig.sta.ssid, ssid, strnlen(ssid, sizeof(_wifiStaConfig.sta.ssid)));
+  if (passphrase != NULL) {
+    memcpy(_wifiStaConfig.sta.password, passphrase, strnlen(passphrase, sizeof(_wifiStaConfig.sta.password)));
+  }
+  if (bssid != NULL) {
+    _wifiStaConfig.sta.bssid_set = true;
+    memcpy(_wifiStaConfig.sta.bssid, bssid, 6);
+  }
+  _wifiStaConfig.sta.channel = channel;
+
+  // 依 SSID (與指定的 BSSID/頻道) 找到目標AP
+  _wifiTarget = NULL;
+  for (size_t i = 0; i < fake::_aps.size(); i++) {
+    const wifi_ap_record_t& ap = fake::_aps[i];
+    if (strcmp((const char*)ap.ssid, ssid) != 0) continue;
+    if (bssid != NULL && memcmp(ap.bssid, bssid, 6) != 0) continue;
+    if (channel != 0 && ap.primary != channel) continue;
+    _wifiTarget = &ap;
+    break;
+  }
+
+  _wifiStatus = WL_DISCONNECTED;
+  if (connect) {
+    esp_wifi_connect();
+  }
+  return _wifiStatus;
+}
+
+/**
+ * 開始與 begin() 找到的目標AP關聯
+ */
+esp_err_t esp_wifi_connect(void) {
+  bool fail = fake::wifi.failAssocEveryN > 0 && fake::counters.wifiBegins % fake::wifi.failAssocEveryN == 0;
+  if (_wifiTarget == NULL || fail) {
+    _wifiStatus = _wifiTarget == NULL ? WL_NO_SSID_AVAIL : WL_DISCONNECTED;
+    return ESP_OK;
+  }
+
+  _wifiStatus = WL_DISCONNECTED;
+  _wifiAssocAt = millis() + fake::wifi.assocMs;
+  _wifiGotIpAt = _wifiAssocAt + ((uint32_t)_wifiStaticIP != 0 ? 0 : fake::wifi.dhcpMs);
+  _wifiAssocPending = true;
+  _wifiIpPending = true;
+  return ESP_OK;
+}
+
+bool WiFiClass::config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
+  _wifiStaticIP = local_ip;
+  return true;
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool eraseap) {
+  bool wasConnected = _wifiStatus == WL_CONNECTED;
+  _wifiAssocPending = false;
+  _wifiIpPending = false;
+  _wifiStatus = WL_DISCONNECTED;
+  if (wasConnected) {
+    arduino_event_info_t info;
+    memset(&info, 0, sizeof(info));
+    info.wifi_sta_disconnected.reason = 8;  // ASSOC_LEAVE
+    _wifiFire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, info);
+  }
+  if (wifioff) enableSTA(false);
+  return true;
+}
+
+bool WiFiClass::reconnect() {
+  if (_wifiTarget == NULL) return false;
+  begin((const char*)_wifiTarget->ssid, NULL, _wifiTarget->primary, _wifiTarget->bssid);
+  return true;
+}
+
+bool WiFiClass::isConnected() { return status() == WL_CONNECTED; }
+bool WiFiClass::setAutoReconnect(bool autoReconnect) { return true; }
+bool WiFiClass::setSleep(bool enabled) { return setSleep(enabled ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE); }
+bool WiFiClass::setSleep(wifi_ps_type_t sleepType) { return esp_wifi_set_ps(sleepType) == ESP_OK; }
+
+wifi_ps_type_t WiFiClass::getSleep() {
+  wifi_ps_type_t type;
+  esp_wifi_get_ps(&type);
+  return type;
+}
+
+static wifi_power_t _wifiTxPower = WIFI_POWER_19_5dBm;
+bool WiFiClass::setTxPower(wifi_power_t power) { _wifiTxPower = power; return true; }
+wifi_power_t WiFiClass::getTxPower() { return _wifiTxPower; }
+
+int16_t WiFiClass::scanNetworks(bool async, bool show_hidden, bool passive, uint32_t max_ms_per_chan, uint8_t channel, const char* ssid, const uint8_t* bssid) {
+  // 與核心相同: 前一次掃描尚未結束時直接返回 WIFI_SCAN_RUNNING，不會啟動新的掃描
+  if (scanComplete() == WIFI_SCAN_RUNNING) return WIFI_SCAN_RUNNING;
+  fake::counters.wifiScans++;
+  _wifiScanDone = false;
+  _wifiScanResults.clear();
+  for (size_t i = 0; i < fake::_aps.size(); i++) {
+    if (channel == 0 || fake::_aps[i].primary == channel) {
+      _wifiScanResults.push_back(fake::_aps[i]);
+    }
+  }
+  _wifiScanning = true;
+  _wifiScanDoneAt = millis() + fake::wifi.scanMs;
+  if (!async) {
+    delay(fake::wifi.scanMs);
+    return scanComplete();
+  }
+  return WIFI_SCAN_RUNNING;
+}
+
+int16_t WiFiClass::scanComplete() {
+  fake_wifiPump();
+  if (_wifiScanning) {
+    if ((long)(millis() - _wifiScanDoneAt) < 0) return WIFI_SCAN_RUNNING;
+    _wifiScanning = false;
+    _wifiScanDone = true;
+  }
+  if (!_wifiScanDone) return WIFI_SCAN_FAILED;
+  return _wifiScanResults.size();
+}
+
+// 與核心相同: 只釋放結果，不會停止進行中的掃描
+void WiFiClass::scanDelete() {
+  _wifiScanDone = false;
+  _wifiScanResults.clear();
+}
+
+void* WiFiClass::getScanInfoByIndex(int i) {
+  if (i < 0 || (size_t)i >= _wifiScanResults.size()) return NULL;
+  return &_wifiScanResults[i];
+}
+
+String WiFiClass::SSID(uint8_t networkItem) {
+  const wifi_ap_record_t* record = (const wifi_ap_record_t*)getScanInfoByIndex(networkItem);
+  return String(record != NULL ? (const char*)record->ssid : "");
+}
+
+int32_t WiFiClass::RSSI(uint8_t networkItem) {
+  const wifi_ap_record_t* record = (const wifi_ap_record_t*)getScanInfoByIndex(networkItem);
+  return record != NULL ? record->rssi : 0;
+}
+
+uint8_t* WiFiClass::BSSID(uint8_t networkItem) {
+  wifi_ap_record_t* record = (wifi_ap_record_t*)getScanInfoByIndex(networkItem);
+  return record != NULL ? record->bssid : NULL;
+}
+
+int32_t WiFiClass::channel(uint8_t networkItem) {
+  const wifi_ap_record_t* record = (const wifi_ap_record_t*)getScanInfoByIndex(networkItem);
+  return record != NULL ? record->primary : 0;
+}
+
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t networkItem) {
+  const wifi_ap_record_t* record = (const wifi_ap_record_t*)getScanInfoByIndex(networkItem);
+  return record != NULL ? record->authmode : WIFI_AUTH_OPEN;
+}
+
+String WiFiClass::SSID() const {
+  return String(_wifiStatus == WL_CONNECTED ? (const char*)_wifiTarget->ssid : "");
+}
+
+int8_t WiFiClass::RSSI() {
+  return _wifiStatus == WL_CONNECTED ? _wifiTarget->rssi : 0;
+}
+
+uint8_t* WiFiClass::BSSID() {
+  return _wifiStatus == WL_CONNECTED ? (uint8_t*)_wifiTarget->bssid : NULL;
+}
+
+int32_t WiFiClass::channel() {
+  return _wifiStatus == WL_CONNECTED ? _wifiTarget->primary : 0;
+}
+
+IPAddress WiFiClass::localIP() {
+  if (_wifiStatus != WL_CONNECTED) return IPAddress();
+  return (uint32_t)_wifiStaticIP != 0 ? _wifiStaticIP : IPAddress(192, 168, 1, 100);
+}
+
+IPAddress WiFiClass::subnetMask() { return IPAddress(255, 255, 255, 0); }
+IPAddress WiFiClass::gatewayIP() { return IPAddress(192, 168, 1, 1); }
+IPAddress WiFiClass::dnsIP(uint8_t dns_no) { return dns_no == 0 ? IPAddress(192, 168, 1, 1) : IPAddress(8, 8, 8, 8); }
+
+static const uint8_t _wifiStaMac[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x01};
+static const uint8_t _wifiApMac[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x02};
+
+String WiFiClass::macAddress() {
+  char text[18];
+  snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X",
+           _wifiStaMac[0], _wifiStaMac[1], _wifiStaMac[2], _wifiStaMac[3], _wifiStaMac[4], _wifiStaMac[5]);
+  return String(text);
+}
+
+uint8_t* WiFiClass::macAddress(uint8_t* mac) {
+  memcpy(mac, _wifiStaMac, 6);
+  return mac;
+}
+
+const char* WiFiClass::getHostname() { return "esp32-fake"; }
+
+bool WiFiClass::softAP(const char* ssid, const char* passphrase, int channel, int ssid_hidden, int max_connection, bool ftm_responder) {
+  enableAP(true);
+  _wifiAPActive = true;
+  memset(&_wifiApConfig, 0, sizeof(_wifiApConfig));
+  _wifiApConfig.ap.ssid_len = strnlen(ssid, sizeof(_wifiApConfig.ap.ssid));
+  memcpy(_wifiApConfig.ap.ssid, ssid, _wifiApConfig.ap.ssid_len);
+  _wifiApConfig.ap.channel = channel;
+  _wifiApConfig.ap.ssid_hidden = ssid_hidden;
+  _wifiApConfig.ap.max_connection = max_connection;
+  return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool wifioff) {
+  _wifiAPActive = false;
+  _wifiAPStations.clear();
+  if (wifioff) enableAP(false);
+  return true;
+}
+
+uint8_t WiFiClass::softAPgetStationNum() { return _wifiAPStations.size(); }
+IPAddress WiFiClass::softAPIP() { return _wifiAPActive ? _wifiAPIP : IPAddress(); }
+
+String WiFiClass::softAPmacAddress() {
+  char text[18];
+  snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X",
+           _wifiApMac[0], _wifiApMac[1], _wifiApMac[2], _wifiApMac[3], _wifiApMac[4], _wifiApMac[5]);
+  return String(text);
+}
+
+uint8_t* WiFiClass::softAPmacAddress(uint8_t* mac) {
+  memcpy(mac, _wifiApMac, 6);
+  return mac;
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb cbEvent, arduino_event_id_t event) {
+  _wifiHandlers.push_back({cbEvent, event});
+  return _wifiHandlers.size();
+}
+
+void WiFiClass::removeEvent(wifi_event_id_t id) {
+  if (id > 0 && id <= _wifiHandlers.size()) {
+    _wifiHandlers[id - 1].callback = [](arduino_event_id_t, arduino_event_info_t) {};
+  }
+}
+
+// ==========================================
+// esp_wifi
+// ==========================================
+
+static wifi_ps_type_t _wifiPs = WIFI_PS_MIN_MODEM;
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type) { _wifiPs = type; return ESP_OK; }
+esp_err_t esp_wifi_get_ps(wifi_ps_type_t* type) { *type = _wifiPs; return ESP_OK; }
+esp_err_t esp_wifi_set_protocol(wifi_interface_t ifx, uint8_t protocol_bitmap) { return ESP_OK; }
+
+esp_err_t esp_wifi_get_config(wifi_interface_t ifx, wifi_config_t* conf) {
+  *conf = ifx == WIFI_IF_AP ? _wifiApConfig : _wifiStaConfig;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t ifx, wifi_config_t* conf) {
+  if (ifx == WIFI_IF_AP) {
+    _wifiApConfig = *conf;
+  } else {
+    _wifiStaConfig = *conf;
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_ap_get_sta_list(wifi_sta_list_t* sta) {
+  memset(sta, 0, sizeof(*sta));
+  for (size_t i = 0; i < _wifiAPStations.size() && i < ESP_WIFI_MAX_CONN_NUM; i++) {
+    sta->sta[sta->num++] = _wifiAPStations[i];
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_stop(void) {
+  _wifiScanning = false;
+  _wifiScanDone = false;
+  _wifiScanResults.clear();
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t* ap_info) {
+  if (_wifiStatus != WL_CONNECTED) return ESP_FAIL;
+  *ap_info = *_wifiTarget;
+  return ESP_OK;
+}
+
+// ==========================================
+// WiFiClient
+// 寫入的位元組由簡易的伺服器端解析，收到 QoS 1 PUBLISH 時可自動回覆 PUBACK
+// ==========================================
+
+static bool _clientConnected = false;
+static std::deque<uint8_t> _clientRx;
+
+// 伺服器端的封包解析狀態
+static uint8_t _brokerState = 0;
+static uint8_t _brokerHeader = 0;
+static uint32_t _brokerRemaining = 0;
+static uint32_t _brokerMultiplier = 1;
+static uint32_t _brokerIndex = 0;
+static uint16_t _brokerTopicLength = 0;
+static uint16_t _brokerPacketId = 0;
+
+static void _brokerPacketDone() {
+  bool qos1Publish = (_brokerHeader & 0xF0) == 0x30 && (_brokerHeader & 0x06) == 0x02;
+  if (qos1Publish && fake::mqtt.autoPuback) {
+    _clientRx.push_back(0x40);
+    _clientRx.push_back(0x02);
+    _clientRx.push_back(_brokerPacketId >> 8);
+    _clientRx.push_back(_brokerPacketId & 0xFF);
+  }
+  _brokerState = 0;
+}
+
+static void _brokerParse(uint8_t b) {
+  switch (_brokerState) {
+    case 0:
+      _brokerHeader = b;
+      _brokerRemaining = 0;
+      _brokerMultiplier = 1;
+      _brokerIndex = 0;
+      _brokerTopicLength = 0;
+      _brokerPacketId = 0;
+      _brokerState = 1;
+      break;
+    case 1:
+      _brokerRemaining += (b & 0x7F) * _brokerMultiplier;
+      _brokerMultiplier *= 128;
+      if ((b & 0x80) == 0) {
+        if (_brokerRemaining == 0) {
+          _brokerPacketDone();
+        } else {
+          _brokerState = 2;
+        }
+      }
+      break;
+    case 2:
+      // PUBLISH 可變標頭: 主題長度(2) + 主題 + 封包識別碼(2)
+      if (_brokerIndex < 2) {
+        _brokerTopicLength = (_brokerTopicLength << 8) | b;
+      } else if (_brokerIndex >= 2u + _brokerTopicLength && _brokerIndex < 4u + _brokerTopicLength) {
+        _brokerPacketId = (_brokerPacketId << 8) | b;
+      }
+      _brokerIndex++;
+      if (_brokerIndex >= _brokerRemaining) {
+        _brokerPacketDone();
+      }
+      break;
+  }
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  _clientConnected = WiFi.status() == WL_CONNECTED;
+  return _clientConnected;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  _clientConnected = WiFi.status() == WL_CONNECTED;
+  return _clientConnected;
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+  if (!_clientConnected) return 0;
+  if (fake::mqtt.clientWriteLimit > 0 && size > fake::mqtt.clientWriteLimit) {
+    size = fake::mqtt.clientWriteLimit;
+  }
+  for (size_t i = 0; i < size; i++) {
+    _brokerParse(buf[i]);
+  }
+  return size;
+}
+
+int WiFiClient::available() { return _clientRx.size(); }
+
+int WiFiClient::read() {
+  if (_clientRx.empty()) return -1;
+  uint8_t b = _clientRx.front();
+  _clientRx.pop_front();
+  return b;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+  size_t n = 0;
+  while (n < size && !_clientRx.empty()) {
+    buf[n++] = _clientRx.front();
+    _clientRx.pop_front();
+  }
+  return n;
+}
+
+int WiFiClient::peek() { return _clientRx.empty() ? -1 : _clientRx.front(); }
+void WiFiClient::flush() {}
+
+void WiFiClient::stop() {
+  _clientConnected = false;
+  _clientRx.clear();
+  _brokerState = 0;
+}
+
+uint8_t WiFiClient::connected() { return _clientConnected; }
+
+// ==========================================
+// esp_ping
+// 在呼叫者的執行緒中同步完成，往返時間依省電模式模擬:
+// 不省電時約 2 ms，MIN_MODEM 需等待下一個 DTIM 信標，MAX_MODEM 依 listen interval 等待
+// ==========================================
+
+typedef struct {
+  esp_ping_config_t config;
+  esp_ping_callbacks_t callbacks;
+  uint32_t seqno;
+  uint32_t timegap;
+  uint32_t received;
+} FakePingSession;
+
+static uint32_t _fakePingRtt(uint32_t seqno) {
+  switch (_wifiPs) {
+    case WIFI_PS_NONE:
+      return 2;
+    case WIFI_PS_MIN_MODEM:
+      return 2 + (seqno * 37) % 102;
+    default: {
+      // listen_interval 為 0 時驅動程式使用預設值 3
+      uint32_t listen = _wifiStaConfig.sta.listen_interval > 0 ? _wifiStaConfig.sta.listen_interval : 3;
+      return 2 + (seqno * 37) % (102 * listen);
+    }
+  }
+}
+
+esp_err_t esp_ping_new_session(const esp_ping_config_t* config, const esp_ping_callbacks_t* cbs, esp_ping_handle_t* hdl_out) {
+  FakePingSession* session = new FakePingSession();
+  session->config = *config;
+  session->callbacks = *cbs;
+  *hdl_out = session;
+  return ESP_OK;
+}
+
+esp_err_t esp_ping_delete_session(esp_ping_handle_t hdl) {
+  delete (FakePingSession*)hdl;
+  return ESP_OK;
+}
+
+esp_err_t esp_ping_start(esp_ping_handle_t hdl) {
+  FakePingSession* session = (FakePingSession*)hdl;
+  for (uint32_t i = 0; i < session->config.count; i++) {
+    session->seqno = i + 1;
+    uint32_t rtt = _fakePingRtt(session->seqno);
+    bool connected = _wifiStatus == WL_CONNECTED;
+    if (connected && rtt < session->config.timeout_ms) {
+      delay(rtt);
+      session->timegap = rtt;
+      session->received++;
+      if (session->callbacks.on_ping_success) session->callbacks.on_ping_success(hdl, session->callbacks.cb_args);
+    } else {
+      delay(session->config.timeout_ms);
+      if (session->callbacks.on_ping_timeout) session->callbacks.on_ping_timeout(hdl, session->callbacks.cb_args);
+    }
+    if (i + 1 < session->config.count && session->config.interval_ms > rtt) {
+      delay(session->config.interval_ms - rtt);
+    }
+  }
+  if (session->callbacks.on_ping_end) session->callbacks.on_ping_end(hdl, session->callbacks.cb_args);
+  return ESP_OK;
+}
+
+esp_err_t esp_ping_stop(esp_ping_handle_t hdl) { return ESP_OK; }
+
+esp_err_t esp_ping_get_profile(esp_ping_handle_t hdl, esp_ping_profile_t profile, void* data, uint32_t size) {
+  FakePingSession* session = (FakePingSession*)hdl;
+  uint32_t value = 0;
+  switch (profile) {
+    case ESP_PING_PROF_SEQNO: value = session->seqno; break;
+    case ESP_PING_PROF_REQUEST: value = session->seqno; break;
+    case ESP_PING_PROF_REPLY: value = session->received; break;
+    case ESP_PING_PROF_TIMEGAP: value = session->timegap; break;
+    case ESP_PING_PROF_SIZE: value = session->config.data_size; break;
+    default: break;
+  }
+  if (size < sizeof(value)) return ESP_FAIL;
+  memcpy(data, &value, sizeof(value));
+  return ESP_OK;
+}
\ No newline at end of file
@@ -1,143 +1,290 @@
 #include "Wireless_mgmt.h"
 #include "Arduino.h"
 #include <BluetoothSerial.h>
+#include <Preferences.h>
+#include <atomic>
 
 // ==========================================
 // Bluetooth Classic
 // ==========================================
 
 BluetoothSerial SerialBT; 
+static bool _btStarted = false;
+static uint8_t _btPeerAddress[6] = {0};
 
 // 藍牙回調函式指針
 void (*_btCallback)(String) = NULL;
 
+/**
+ * 舊版字串回調函式的事件轉接
+ */
+static void _btLegacyAdapter(const WirelessEvent &event, void* ctx) {
+  if (event.source == WIRELESS_SOURCE_BT && _btCallback != NULL) {
+    String message = String((const char*)event.data);
+    message.trim();
+    if (message.length() > 0) {
+      _btCallback(message);
+    }
+  }
+}
+
 /**
  * 設定藍牙連接參數
  * @param btName 藍牙顯示名稱
  */
 void BT_setup(const char* btName, bool silentMode) {
-  SerialBT.begin(btName);
+  _btStarted = SerialBT.begin(btName);
   
   if (!silentMode) {
-    Serial.println("--------------------------------");
-    Serial.println("藍牙設定:");
-    Serial.print("- 設備名稱: ");
-    Serial.println(btName);
+    WM_LOGI(WM_SEPARATOR);
+    WM_LOGI("藍牙設定:");
+    WM_LOGI("- 設備名稱: %s", btName);
     
     if (_btCallback != NULL) {
-      Serial.println("- 回調函式已設定");
+      WM_LOGI("- 回調函式已設定");
     }
-    Serial.println("--------------------------------");
+    WM_LOGI(WM_SEPARATOR);
   }
 }
 
+// 名稱與位址對應快取
+typedef struct {
+  bool used;
+  uint32_t key;
+  uint8_t address[6];
+} BTPeerEntry;
+
+static BTPeerEntry _btPeerCache[BT_PEER_CACHE_SIZE];
+static uint8_t _btPeerNext = 0;
+static const char* _btPeerNamespace = "wm_bt";
+
+// 連接統計 (由執行連接的任務寫入)
+static BTConnectStats _btConnectStats = {0, 0, 0, 0, 0, 0, 0, 0};
+
+// 非同步連接狀態
+#define BT_ASYNC_IDLE     0
+#define BT_ASYNC_RUNNING  1
+#define BT_ASYNC_DONE     2
+
+static std::atomic<uint8_t> _btAsyncState(BT_ASYNC_IDLE);
+static std::atomic<bool> _btAsyncResult(false);
+static String _btAsyncName;
+static uint32_t _btAsyncScanDuration = 5;
+static bool _btAsyncPartialMatch = false;
+static int _btAsyncMaxAttempts = 1;
+static bool _btAsyncSilentMode = false;
+static BTConnectCallback _btAsyncCallback = NULL;
+
 /**
- * 掃描並連接指定名稱的藍牙設備(一步到位)
- * @param name 要連接的設備名稱
- * @param scanDuration 掃描時間(秒)
- * @param partialMatch 是否允許部分名稱匹配
- * @param maxAttempts 最大嘗試次數
- * @param silentMode 是否安靜模式
- * @return 是否成功連接
+ * 計算快取鍵值 (FNV-1a，包含部分匹配旗標)
  */
-bool BT_master_connect(const String &name, uint32_t scanDuration, bool partialMatch, int maxAttempts, bool silentMode) {
-  for (int attempt = 1; attempt <= maxAttempts; attempt++) {
-    if (!silentMode && maxAttempts > 1) {
-      Serial.print("嘗試 ");
-      Serial.print(attempt);
-      Serial.print("/");
-      Serial.print(maxAttempts);
-      Serial.println("...");
+static uint32_t _btPeerKey(const String &name, bool partialMatch) {
+  uint32_t hash = 2166136261UL;
+  const char* p = name.c_str();
+  for (size_t i = 0; i < name.length(); i++) {
+    hash ^= (uint8_t)p[i];
+    hash *= 16777619UL;
+  }
+  hash ^= partialMatch ? 1 : 0;
+  hash *= 16777619UL;
+  return hash;
+}
+
+/**
+ * 取得 NVS 鍵名 (最長 15 字元)
+ */
+static void _btPeerNvsKey(uint32_t key, char* out, size_t size) {
+  snprintf(out, size, "p%08lx", (unsigned long)key);
+}
+
+/**
+ * 將位址寫入 RAM 快取，已存在時覆寫
+ */
+static void _btPeerRemember(uint32_t key, const uint8_t address[6]) {
+  for (int i = 0; i < BT_PEER_CACHE_SIZE; i++) {
+    if (_btPeerCache[i].used && _btPeerCache[i].key == key) {
+      memcpy(_btPeerCache[i].address, address, 6);
+      return;
     }
-    
-    // 開始掃描
-    if (!silentMode) {
-      Serial.println("--------------------------------");
-      Serial.println("開始藍牙掃描...");
+  }
+  BTPeerEntry &entry = _btPeerCache[_btPeerNext];
+  _btPeerNext = (_btPeerNext + 1) % BT_PEER_CACHE_SIZE;
+  entry.used = true;
+  entry.key = key;
+  memcpy(entry.address, address, 6);
+}
+
+/**
+ * 查詢快取位址 (先查 RAM，再查 NVS)
+ * @return 是否找到
+ */
+static bool _btPeerLookup(uint32_t key, uint8_t address[6]) {
+  for (int i = 0; i < BT_PEER_CACHE_SIZE; i++) {
+    if (_btPeerCache[i].used && _btPeerCache[i].key == key) {
+      memcpy(address, _btPeerCache[i].address, 6);
+      return true;
     }
+  }
+
+  char nvsKey[12];
+  _btPeerNvsKey(key, nvsKey, sizeof(nvsKey));
+  Preferences prefs;
+  if (!prefs.begin(_btPeerNamespace, true)) return false;
+  bool found = prefs.getBytes(nvsKey, address, 6) == 6;
+  prefs.end();
+
+  if (found) _btPeerRemember(key, address);
+  return found;
+}
+
+/**
+ * 儲存位址到 RAM 與 NVS (內容相同時不寫入快閃記憶體)
+ */
+static void _btPeerStore(uint32_t key, const uint8_t address[6]) {
+  _btPeerRemember(key, address);
+
+  char nvsKey[12];
+  _btPeerNvsKey(key, nvsKey, sizeof(nvsKey));
+  Preferences prefs;
+  if (!prefs.begin(_btPeerNamespace, false)) return;
+  uint8_t stored[6];
+  if (prefs.getBytes(nvsKey, stored, 6) != 6 || memcmp(stored, address, 6) != 0) {
+    prefs.putBytes(nvsKey, address, 6);
+  }
+  prefs.end();
+}
+
+/**
+ * 掃描指定名稱的設備，找到後立即停止掃描
+ * @param address 輸出的設備位址
+ * @return 是否找到
+ */
+static bool _btScanFor(const String &name, uint32_t scanDuration, bool partialMatch, uint8_t address[6], bool silentMode) {
+  if (!silentMode) {
+    WM_LOGI(WM_SEPARATOR);
+    WM_LOGI("開始藍牙掃描...");
+  }
+
+  // 掃描回調於藍牙堆疊任務中執行
+  std::atomic<bool> found(false);
+  uint8_t foundAddress[6];
+
+  bool scanStarted = SerialBT.discoverAsync([&](BTAdvertisedDevice* device) {
+    if (found) return;
+
+    // 檢查設備名稱是否匹配
+    String deviceName = device->getName().c_str();
+    bool nameMatches = false;
     
-    // 清空之前掃描結果
-    bool foundTargetDevice = false;
-    String targetAddress = "";
-    
-    // 啟動掃描
-    bool scanStarted = SerialBT.discoverAsync([&](BTAdvertisedDevice* device) {
-      // 檢查設備名稱是否匹配
-      String deviceName = device->getName().c_str();
-      bool nameMatches = false;
-      
-      if (deviceName.length() > 0) {
-        if (partialMatch) {
-          nameMatches = (deviceName.indexOf(name) >= 0);
-        } else {
-          nameMatches = deviceName.equals(name);
-        }
-      }
-      
-      // 找到匹配設備
-      if (nameMatches) {
-        foundTargetDevice = true;
-        targetAddress = device->getAddress().toString().c_str();
-        
-        if (!silentMode) {
-          Serial.print("找到目標設備: ");
-          Serial.print(deviceName);
-          Serial.print(" (");
-          Serial.print(targetAddress);
-          Serial.print("), RSSI: ");
-          Serial.println(device->getRSSI());
-        }
-      } else if (!silentMode) {
-        Serial.print("發現設備: ");
-        Serial.print(deviceName.length() > 0 ? deviceName : "(無名稱)");
-        Serial.print(" (");
-        Serial.print(device->getAddress().toString().c_str());
-        Serial.println(")");
+    if (deviceName.length() > 0) {
+      if (partialMatch) {
+        nameMatches = (deviceName.indexOf(name) >= 0);
+      } else {
+        nameMatches = deviceName.equals(name);
       }
-    });
-    
-    if (!scanStarted) {
-      if (!silentMode) Serial.println("啟動掃描失敗");
-      return false;
     }
     
-    // 等待掃描結束
-    delay(scanDuration * 1000);
-    SerialBT.discoverAsyncStop();
-    
+    // getAddress() 回傳暫時物件，需先保存再取得位址；getNative() 回傳 esp_bd_addr_t* (指向 uint8_t[6])
+    BTAddress deviceAddress = device->getAddress();
+    const uint8_t* native = *deviceAddress.getNative();
+    if (nameMatches) {
+      memcpy(foundAddress, native, 6);
+      found = true;
+
+      if (!silentMode) {
+        WM_LOGI("找到目標設備: %s (" WM_MAC_FMT "), RSSI: %d", deviceName.c_str(), WM_MAC_ARGS(native), device->getRSSI());
+      }
+    } else if (!silentMode) {
+      WM_LOGD("發現設備: %s (" WM_MAC_FMT ")", deviceName.length() > 0 ? deviceName.c_str() : "(無名稱)", WM_MAC_ARGS(native));
+    }
+  });
+  
+  if (!scanStarted) {
+    if (!silentMode) WM_LOGE("啟動掃描失敗");
+    return false;
+  }
+  
+  // 等待掃描結束，找到目標後提前結束
+  unsigned long start = millis();
+  while (!found && millis() - start < scanDuration * 1000UL) {
+    delay(10);
+  }
+  SerialBT.discoverAsyncStop();
+  _btConnectStats.lastScanMs = millis() - start;
+  
+  if (!silentMode) {
+    WM_LOGI("藍牙掃描已停止 (%lu ms)", (unsigned long)_btConnectStats.lastScanMs);
+  }
+
+  if (!found) return false;
+  memcpy(address, foundAddress, 6);
+  return true;
+}
+
+/**
+ * 以位址連接設備並記錄耗時
+ */
+static bool _btConnectAddress(uint8_t address[6]) {
+  unsigned long start = millis();
+  bool connected = SerialBT.connect(address);
+  _btConnectStats.lastConnectMs = millis() - start;
+  if (connected) memcpy(_btPeerAddress, address, 6);
+  return connected;
+}
+
+/**
+ * 連接指定名稱的設備: 先使用快取位址，失敗時才掃描
+ */
+static bool _btConnect(const String &name, uint32_t scanDuration, bool partialMatch, int maxAttempts, bool silentMode) {
+  unsigned long start = millis();
+  uint32_t key = _btPeerKey(name, partialMatch);
+  uint8_t address[6];
+  bool connected = false;
+
+  _btConnectStats.attempts++;
+  _btConnectStats.lastScanMs = 0;
+
+  // 先嘗試快取中的位址
+  if (_btPeerLookup(key, address)) {
+    _btConnectStats.cacheHits++;
     if (!silentMode) {
-      Serial.println("藍牙掃描已停止");
+      WM_LOGI("使用快取位址連接: %s (" WM_MAC_FMT ")", name.c_str(), WM_MAC_ARGS(address));
+    }
+    connected = _btConnectAddress(address);
+    if (!connected && !silentMode) {
+      WM_LOGW("快取位址連接失敗，改為掃描");
+    }
+  } else {
+    _btConnectStats.cacheMisses++;
+  }
+
+  for (int attempt = 1; !connected && attempt <= maxAttempts; attempt++) {
+    if (!silentMode && maxAttempts > 1) {
+      WM_LOGI("嘗試 %d/%d...", attempt, maxAttempts);
     }
     
     // 如果找到目標設備，嘗試連接
-    if (foundTargetDevice) {
+    if (_btScanFor(name, scanDuration, partialMatch, address, silentMode)) {
       if (!silentMode) {
-        Serial.println("--------------------------------");
-        Serial.print("正在連接到設備: ");
-        Serial.print(name);
-        Serial.print(" (");
-        Serial.print(targetAddress);
-        Serial.println(")");
+        WM_LOGI(WM_SEPARATOR);
+        WM_LOGI("正在連接到設備: %s (" WM_MAC_FMT ")", name.c_str(), WM_MAC_ARGS(address));
       }
       
-      bool connected = SerialBT.connect(targetAddress.c_str());
+      connected = _btConnectAddress(address);
       
       if (connected) {
+        _btPeerStore(key, address);
         if (!silentMode) {
-          Serial.println("連接成功!");
-          Serial.println("--------------------------------");
+          WM_LOGI("連接成功! (%lu ms)", (unsigned long)_btConnectStats.lastConnectMs);
+          WM_LOGI(WM_SEPARATOR);
         }
-        return true;
+        break;
       } else if (!silentMode) {
-        Serial.println("連接失敗");
-        Serial.println("--------------------------------");
+        WM_LOGW("連接失敗");
+        WM_LOGI(WM_SEPARATOR);
       }
     } else if (!silentMode) {
-      Serial.print("找不到名稱");
-      Serial.print(partialMatch ? "包含" : "為");
-      Serial.print(" '");
-      Serial.print(name);
-      Serial.println("' 的設備");
+      WM_LOGW("找不到名稱%s '%s' 的設備", partialMatch ? "包含" : "為", name.c_str());
     }
     
     // 如果不是最後一次嘗試，則等待一段時間
@@ -145,16 +292,110 @@ bool BT_master_connect(const String &name, uint32_t scanDuration, bool partialMa
       delay(1000);  // 等待1秒後再試
     }
   }
-  
-  if (!silentMode && maxAttempts > 1) {
-    Serial.print("在 ");
-    Serial.print(maxAttempts);
-    Serial.print(" 次嘗試後無法連接到設備 '");
-    Serial.print(name);
-    Serial.println("'");
+
+  _btConnectStats.lastTotalMs = millis() - start;
+  if (connected) {
+    _btConnectStats.successes++;
+    _wirelessMetricLatency(WIRELESS_HIST_BT_CONNECT, _btConnectStats.lastTotalMs * 1000UL);
+  } else {
+    _btConnectStats.failures++;
+    if (!silentMode && maxAttempts > 1) {
+      WM_LOGW("在 %d 次嘗試後無法連接到設備 '%s'", maxAttempts, name.c_str());
+    }
+  }
+  return connected;
+}
+
+/**
+ * 掃描並連接指定名稱的藍牙設備(一步到位)
+ * 已知的設備會直接以快取位址連接，失敗時才重新掃描
+ * @param name 要連接的設備名稱
+ * @param scanDuration 掃描時間(秒)，找到目標後會提前結束
+ * @param partialMatch 是否允許部分名稱匹配
+ * @param maxAttempts 最大嘗試次數
+ * @param silentMode 是否安靜模式
+ * @return 是否成功連接
+ */
+bool BT_master_connect(const String &name, uint32_t scanDuration, bool partialMatch, int maxAttempts, bool silentMode) {
+  if (_btAsyncState != BT_ASYNC_IDLE) {
+    if (!silentMode) WM_LOGW("藍牙非同步連接進行中");
+    return false;
+  }
+  return _btConnect(name, scanDuration, partialMatch, maxAttempts, silentMode);
+}
+
+/**
+ * 非同步連接任務
+ */
+static void _btConnectTask(void* arg) {
+  _btAsyncResult = _btConnect(_btAsyncName, _btAsyncScanDuration, _btAsyncPartialMatch,
+                              _btAsyncMaxAttempts, _btAsyncSilentMode);
+  _btAsyncState = BT_ASYNC_DONE;
+  vTaskDelete(NULL);
+}
+
+/**
+ * 非同步掃描並連接指定名稱的藍牙設備
+ * 掃描與連接在背景任務中執行，完成後於 BT_loop 中呼叫回調函式
+ * @param name 要連接的設備名稱
+ * @param scanDuration 掃描時間(秒)
+ * @param partialMatch 是否允許部分名稱匹配
+ * @param maxAttempts 最大嘗試次數
+ * @param callback 完成回調函式
+ * @param silentMode 是否安靜模式
+ * @return 是否成功開始
+ */
+bool BT_connectAsync(const String &name, uint32_t scanDuration, bool partialMatch, int maxAttempts,
+                     BTConnectCallback callback, bool silentMode) {
+  if (_btAsyncState != BT_ASYNC_IDLE) {
+    if (!silentMode) WM_LOGW("藍牙非同步連接進行中");
+    return false;
+  }
+
+  _btAsyncName = name;
+  _btAsyncScanDuration = scanDuration;
+  _btAsyncPartialMatch = partialMatch;
+  _btAsyncMaxAttempts = maxAttempts;
+  _btAsyncSilentMode = silentMode;
+  _btAsyncCallback = callback;
+  _btAsyncState = BT_ASYNC_RUNNING;
+
+  if (xTaskCreate(_btConnectTask, "bt_connect", 4096, NULL, 1, NULL) != pdPASS) {
+    _btAsyncState = BT_ASYNC_IDLE;
+    if (!silentMode) WM_LOGE("無法建立藍牙連接任務");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * 檢查非同步連接是否進行中
+ * @return 是否進行中
+ */
+bool BT_isConnecting() {
+  return _btAsyncState == BT_ASYNC_RUNNING;
+}
+
+/**
+ * 取得藍牙連接統計資訊
+ * @param stats 輸出的統計資訊
+ */
+void BT_getConnectStats(BTConnectStats &stats) {
+  stats = _btConnectStats;
+}
+
+/**
+ * 清除名稱與位址對應快取 (RAM 與 NVS)
+ */
+void BT_clearPeerCache() {
+  memset(_btPeerCache, 0, sizeof(_btPeerCache));
+  _btPeerNext = 0;
+
+  Preferences prefs;
+  if (prefs.begin(_btPeerNamespace, false)) {
+    prefs.clear();
+    prefs.end();
   }
-  
-  return false;
 }
 
 /**
@@ -163,20 +404,253 @@ bool BT_master_connect(const String &name, uint32_t scanDuration, bool partialMa
  */
 void BT_setCallback(void (*callback)(String), bool silentMode) {
   _btCallback = callback;
+  if (callback != NULL) {
+    Wireless_on(WIRELESS_EVENT_MASK(WIRELESS_EVENT_MESSAGE), _btLegacyAdapter);
+  } else {
+    Wireless_off(_btLegacyAdapter);
+  }
+  if (!silentMode) {
+    WM_LOGI("藍牙回調函式已設定");
+  }
+}
+
+// 訊框切割設定
+static BTFrameMode _btFrameMode = BT_FRAME_DELIMITER;
+static char _btDelimiter = '\n';
+static size_t _btMaxFrameLen = BT_FRAME_MAX_LEN;
+static unsigned long _btIdleFlushMs = 100;
+
+// 訊框回調函式
+static BTFrameCallback _btFrameCallback = NULL;
+static void* _btFrameCtx = NULL;
+
+// 訊框組裝狀態 (多留一個位元組給結尾的 '\0')
+static uint8_t _btFrame[BT_FRAME_MAX_LEN + 1];
+static size_t _btFrameLen = 0;
+static size_t _btExpectLen = 0;       // 長度模式: 資料長度
+static uint8_t _btHeaderLen = 0;      // 長度模式: 已收到的長度位元組數
+static bool _btDiscarding = false;    // 正在丟棄超長訊框的剩餘資料
+static size_t _btDiscardLeft = 0;     // 長度模式: 尚待丟棄的位元組數
+static unsigned long _btLastByteAt = 0;
+static BTFrameStats _btFrameStats = {0, 0, 0, 0};
+
+/**
+ * 清除目前組裝中的訊框
+ */
+static void _btResetFrame() {
+  _btFrameLen = 0;
+  _btExpectLen = 0;
+  _btHeaderLen = 0;
+  _btDiscarding = false;
+  _btDiscardLeft = 0;
+}
+
+/**
+ * 訊框回調函式的事件轉接
+ */
+static void _btFrameAdapter(const WirelessEvent &event, void* ctx) {
+  if (event.source == WIRELESS_SOURCE_BT && _btFrameCallback != NULL) {
+    _btFrameCallback(event.data, event.length, _btFrameCtx);
+  }
+}
+
+/**
+ * 以 MESSAGE 事件通知監聽函式 (包含訊框與舊版字串回調函式，data 需以 '\0' 結尾)
+ * 服務任務執行中時由 Wireless_dispatch 在應用程式的任務中呼叫
+ */
+void _btDeliver(const uint8_t* data, size_t length) {
+  WirelessEvent event = {};
+  event.type = WIRELESS_EVENT_MESSAGE;
+  event.source = WIRELESS_SOURCE_BT;
+  event.data = data;
+  event.length = length;
+  Wireless_emit(event);
+}
+
+/**
+ * 將組裝完成的訊框交給回調函式
+ */
+static void _btDeliverFrame() {
+  size_t length = _btFrameLen;
+  if (_btFrameMode == BT_FRAME_DELIMITER) {
+    if (length > 0 && _btFrame[length - 1] == '\r') length--;
+    if (length == 0) {
+      _btResetFrame();
+      return;
+    }
+  }
+  _btFrame[length] = '\0';
+  _btFrameStats.frames++;
+
+  if (_wirelessServiceDefer()) {
+    _wirelessServicePostInbound(WIRELESS_INBOUND_BT, 0, NULL, _btFrame, length);
+  } else {
+    _btDeliver(_btFrame, length);
+  }
+  _btResetFrame();
+}
+
+/**
+ * 分隔字元模式: 處理一個位元組
+ */
+static void _btFeedDelimited(uint8_t c) {
+  if (c == (uint8_t)_btDelimiter) {
+    if (_btDiscarding) {
+      _btResetFrame();
+    } else {
+      _btDeliverFrame();
+    }
+    return;
+  }
+  if (_btDiscarding) return;
+
+  if (_btFrameLen >= _btMaxFrameLen) {
+    // 超過最大長度，丟棄到下一個分隔字元為止
+    _btFrameStats.overflows++;
+    _btFrameLen = 0;
+    _btDiscarding = true;
+    return;
+  }
+  _btFrame[_btFrameLen++] = c;
+}
+
+/**
+ * 長度前綴模式: 處理一個位元組
+ */
+static void _btFeedLengthPrefixed(uint8_t c) {
+  if (_btHeaderLen < 2) {
+    _btExpectLen = (_btExpectLen << 8) | c;
+    _btHeaderLen++;
+    if (_btHeaderLen < 2) return;
+
+    if (_btExpectLen > _btMaxFrameLen) {
+      _btFrameStats.overflows++;
+      _btDiscarding = true;
+      _btDiscardLeft = _btExpectLen;
+    } else if (_btExpectLen == 0) {
+      _btDeliverFrame();
+    }
+    return;
+  }
+
+  if (_btDiscarding) {
+    if (--_btDiscardLeft == 0) _btResetFrame();
+    return;
+  }
+
+  _btFrame[_btFrameLen++] = c;
+  if (_btFrameLen == _btExpectLen) {
+    _btDeliverFrame();
+  }
+}
+
+/**
+ * 設定藍牙訊框切割方式
+ * @param mode 分隔字元模式或長度前綴模式
+ * @param delimiter 分隔字元 (僅分隔字元模式)
+ * @param maxFrameLen 單一訊框最大長度 (上限為 BT_FRAME_MAX_LEN)
+ * @param idleFlushMs 閒置多久後處理未完成的訊框 (毫秒, 0 表示停用)
+ * @param silentMode 是否安靜模式
+ */
+void BT_setFraming(BTFrameMode mode, char delimiter, size_t maxFrameLen, unsigned long idleFlushMs, bool silentMode) {
+  if (maxFrameLen == 0 || maxFrameLen > BT_FRAME_MAX_LEN) {
+    maxFrameLen = BT_FRAME_MAX_LEN;
+  }
+  _btFrameMode = mode;
+  _btDelimiter = delimiter;
+  _btMaxFrameLen = maxFrameLen;
+  _btIdleFlushMs = idleFlushMs;
+  _btResetFrame();
+
+  if (!silentMode) {
+    if (mode == BT_FRAME_DELIMITER) {
+      WM_LOGI("藍牙訊框: 分隔字元 0x%02X, 最大 %u 位元組", (uint8_t)delimiter, (unsigned)maxFrameLen);
+    } else {
+      WM_LOGI("藍牙訊框: 長度前綴, 最大 %u 位元組", (unsigned)maxFrameLen);
+    }
+  }
+}
+
+/**
+ * 設定藍牙訊框回調函式 (可與 BT_setCallback 同時使用)
+ * @param callback 回調函式指針
+ * @param ctx 傳給回調函式的使用者資料
+ */
+void BT_setFrameCallback(BTFrameCallback callback, void* ctx, bool silentMode) {
+  _btFrameCallback = callback;
+  _btFrameCtx = ctx;
+  if (callback != NULL) {
+    Wireless_on(WIRELESS_EVENT_MASK(WIRELESS_EVENT_MESSAGE), _btFrameAdapter);
+  } else {
+    Wireless_off(_btFrameAdapter);
+  }
   if (!silentMode) {
-    Serial.println("藍牙回調函式已設定");
+    WM_LOGI("藍牙訊框回調函式已設定");
   }
 }
 
+/**
+ * 取得藍牙訊框統計資訊
+ * @param stats 輸出的統計資訊
+ */
+void BT_getFrameStats(BTFrameStats &stats) {
+  stats = _btFrameStats;
+}
+
 /**
  * 藍牙主迴圈處理
- * 此函式應在主迴圈中定期呼叫
+ * 此函式應在主迴圈中定期呼叫，只讀取已到達的資料，不會阻塞
  */
+// 上次通知的連線狀態，用來產生 LINK_UP/LINK_DOWN 事件
+static bool _btLinkUp = false;
+static unsigned long _btLinkUpAt = 0;
+
 void BT_loop() {
-  if (SerialBT.available()) {
-    String message = SerialBT.readString();
-    message.trim();
-    _btCallback(message);
+  bool connected = SerialBT.connected(0);
+  if (connected != _btLinkUp) {
+    _btLinkUp = connected;
+    if (connected) _btLinkUpAt = millis();
+    WirelessEvent event = {};
+    event.type = connected ? WIRELESS_EVENT_LINK_UP : WIRELESS_EVENT_LINK_DOWN;
+    event.source = WIRELESS_SOURCE_BT;
+    Wireless_emit(event);
+  }
+
+  // 非同步連接完成，於主迴圈中呼叫回調函式
+  if (_btAsyncState == BT_ASYNC_DONE) {
+    BTConnectCallback callback = _btAsyncCallback;
+    bool connected = _btAsyncResult;
+    _btAsyncState = BT_ASYNC_IDLE;
+    if (callback != NULL) callback(connected);
+  }
+
+  int available = SerialBT.available();
+  if (available > BT_RX_BUDGET) available = BT_RX_BUDGET;
+
+  int received = 0;
+  for (; received < available; received++) {
+    int c = SerialBT.read();
+    if (c < 0) break;
+    _btFrameStats.bytes++;
+    _btLastByteAt = millis();
+
+    if (_btFrameMode == BT_FRAME_DELIMITER) {
+      _btFeedDelimited((uint8_t)c);
+    } else {
+      _btFeedLengthPrefixed((uint8_t)c);
+    }
+  }
+  if (received > 0) _wirelessMetricAdd(WIRELESS_METRIC_BT_RX_BYTES, received);
+
+  // 閒置逾時: 分隔模式送出未結尾的訊框，長度模式丟棄不完整的訊框
+  bool pending = _btFrameLen > 0 || _btHeaderLen > 0 || _btDiscarding;
+  if (pending && _btIdleFlushMs > 0 && millis() - _btLastByteAt >= _btIdleFlushMs) {
+    _btFrameStats.idleFlushes++;
+    if (_btFrameMode == BT_FRAME_DELIMITER && !_btDiscarding) {
+      _btDeliverFrame();
+    } else {
+      _btResetFrame();
+    }
   }
 }
 
@@ -187,15 +661,17 @@ void BT_loop() {
  */
 bool BT_sendMessage(const String &message, bool ln, bool silentMode) {
   if (SerialBT.connected()) {
+    size_t written;
     if (ln) {
-      SerialBT.println(message);
+      written = SerialBT.println(message);
     } else {
-      SerialBT.print(message);
+      written = SerialBT.print(message);
     }
+    _wirelessMetricAdd(WIRELESS_METRIC_BT_TX_BYTES, written);
     return true;
   } else {
     if (!silentMode) {
-      Serial.println("藍牙未連接，無法發送訊息");
+      WM_LOGW("藍牙未連接，無法發送訊息");
     }
     return false;
   }
@@ -209,6 +685,24 @@ bool BT_checkStatus() {
   return SerialBT.connected();
 }
 
+/**
+ * 取得藍牙連線資訊，不配置堆積記憶體
+ * 連線時間以 BT_loop 偵測到連線的時間起算
+ * @param info 輸出的連線資訊
+ * @return 是否已連接
+ */
+bool BT_getInfo(BTInfo &info) {
+  info.started = _btStarted;
+  info.connected = _btStarted && SerialBT.connected(0);
+  info.connecting = BT_isConnecting();
+  memcpy(info.peer, _btPeerAddress, 6);
+  info.uptimeMs = info.connected && _btLinkUp ? millis() - _btLinkUpAt : 0;
+  info.rxBytes = _btFrameStats.bytes;
+  info.frames = _btFrameStats.frames;
+  info.lastConnectMs = _btConnectStats.lastTotalMs;
+  return info.connected;
+}
+
 // ==========================================
 // Bluetooth Low Energy
 // ==========================================
@@ -216,44 +710,284 @@ bool BT_checkStatus() {
 // BLE 伺服器相關變數
 BLEServer *pServer = NULL;
 BLECharacteristic *pCharacteristic = NULL;
-bool deviceConnected = false;
-bool oldDeviceConnected = false;
+std::atomic<bool> deviceConnected(false);
 
 // 訊息回調函式
 BLECallbackFunction _bleCallback = NULL;
+static BLEDataCallback _bleDataCallback = NULL;
+static void* _bleDataCtx = NULL;
+
+/**
+ * 資料回調函式的事件轉接
+ */
+static void _bleDataAdapter(const WirelessEvent &event, void* ctx) {
+  if (event.source == WIRELESS_SOURCE_BLE && _bleDataCallback != NULL) {
+    _bleDataCallback(event.id, event.data, event.length, _bleDataCtx);
+  }
+}
+
+/**
+ * 舊版字串回調函式的事件轉接
+ */
+static void _bleLegacyAdapter(const WirelessEvent &event, void* ctx) {
+  if (event.source == WIRELESS_SOURCE_BLE && _bleCallback != NULL) {
+    String message = String((const char*)event.data);
+    message.trim();
+    _bleCallback(message);
+  }
+}
+
+// 接收佇列: 藍牙堆疊任務為唯一生產者，BLE_loop 為唯一消費者
+// 多配置一個槽位以區分佇列已滿與佇列為空
+#define BLE_RX_SLOTS (BLE_RX_QUEUE_SIZE + 1)
+
+typedef struct {
+  uint16_t connId;
+  uint16_t length;
+  uint8_t data[BLE_RX_SLOT_LEN + 1];  // 多留一個位元組給結尾的 '\0'
+} BLERxSlot;
+
+static BLERxSlot _bleRxSlots[BLE_RX_SLOTS];
+static std::atomic<uint16_t> _bleRxHead(0);   // 下一個寫入位置 (生產者)
+static std::atomic<uint16_t> _bleRxTail(0);   // 下一個讀取位置 (消費者)
+static std::atomic<uint16_t> _bleRxHighWater(0);
+static std::atomic<uint32_t> _bleRxReceived(0);
+static std::atomic<uint32_t> _bleRxDropped(0);
+static std::atomic<uint32_t> _bleRxTruncated(0);
+
+// 連線狀態回調是否輸出日誌(由 BLE_setup 設定)
+static bool _bleSilentMode = false;
+
+// 通知描述符 (用來判斷用戶端是否已啟用通知)
+static BLE2902* _ble2902 = NULL;
+
+// 連線表 (由藍牙堆疊的 GATTS 事件更新，存取時需持有 _bleConnMux)
+typedef struct {
+  bool active;
+  bool congested;
+  uint32_t generation;    // 建立連線時的世代，區分斷線後重用的 connId
+  BLEConnectionInfo info;
+} BLEConnSlot;
+
+static BLEConnSlot _bleConns[BLE_MAX_CONNECTIONS];
+static portMUX_TYPE _bleConnMux = portMUX_INITIALIZER_UNLOCKED;
+static std::atomic<uint8_t> _bleConnCount(0);
+static uint8_t _bleMaxConns = BLE_MAX_CONNECTIONS;
+static uint32_t _bleConnGeneration = 0;     // 每次連線/斷線遞增 (需持有 _bleConnMux)
+static uint32_t _bleLastGeneration = 0;     // BLE_loop 上次處理時的世代
 
-// 定義回調類別處理連線狀態
+// 廣播狀態
+typedef enum {
+  BLE_ADV_IDLE = 0,   // 已達連線上限，不廣播
+  BLE_ADV_PENDING,    // 連線數變動後等待重新廣播
+  BLE_ADV_FAST,       // 快速間隔廣播中
+  BLE_ADV_SLOW        // 慢速間隔廣播中
+} BLEAdvState;
+
+static BLEAdvState _bleAdvState = BLE_ADV_IDLE;
+static unsigned long _bleAdvDeadline = 0;
+
+// 廣播間隔設定 (毫秒)
+static uint16_t _bleAdvFastMin = 20;
+static uint16_t _bleAdvFastMax = 30;
+static unsigned long _bleAdvFastDuration = 30000;
+static uint16_t _bleAdvSlowMin = 1000;
+static uint16_t _bleAdvSlowMax = 1285;
+
+// 分段傳送設定與統計
+static bool _bleChunkHeader = false;
+static uint8_t _bleChunk[BLE_MTU];
+static BLETxStats _bleTxStats = {23, 0, 0, 0, 0, 0, 0, 0};
+// 分段緩衝區與統計由所有發送共用，同一時間只允許一個任務發送，也避免不同訊息的分段交錯
+static SemaphoreHandle_t _bleTxLock = NULL;
+
+/**
+ * 尋找連線在連線表中的位置 (需持有 _bleConnMux)
+ * @return 索引，找不到時為 -1
+ */
+static int _bleConnFind(uint16_t connId) {
+  for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+    if (_bleConns[i].active && _bleConns[i].info.connId == connId) return i;
+  }
+  return -1;
+}
+
+/**
+ * GATTS 事件處理 (於藍牙堆疊任務中執行)
+ * 維護連線表: 連線/斷線、協商後的 MTU、通知訂閱與壅塞狀態
+ */
+static void _bleGattsHandler(esp_gatts_cb_event_t event, esp_gatt_if_t gattsIf, esp_ble_gatts_cb_param_t* param) {
+  portENTER_CRITICAL(&_bleConnMux);
+  switch (event) {
+    case ESP_GATTS_CONNECT_EVT:
+      for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        if (_bleConns[i].active) continue;
+        memset(&_bleConns[i], 0, sizeof(BLEConnSlot));
+        _bleConns[i].active = true;
+        _bleConns[i].info.connId = param->connect.conn_id;
+        _bleConns[i].info.mtu = 23;
+        memcpy(_bleConns[i].info.address, param->connect.remote_bda, 6);
+        _bleConns[i].generation = ++_bleConnGeneration;
+        _bleConnCount++;
+        break;
+      }
+      break;
+    case ESP_GATTS_DISCONNECT_EVT: {
+      int i = _bleConnFind(param->disconnect.conn_id);
+      if (i >= 0) {
+        _bleConns[i].active = false;
+        _bleConnGeneration++;
+        _bleConnCount--;
+      }
+      break;
+    }
+    case ESP_GATTS_MTU_EVT: {
+      int i = _bleConnFind(param->mtu.conn_id);
+      if (i >= 0) _bleConns[i].info.mtu = param->mtu.mtu;
+      break;
+    }
+    case ESP_GATTS_CONGEST_EVT: {
+      int i = _bleConnFind(param->congest.conn_id);
+      if (i >= 0) _bleConns[i].congested = param->congest.congested;
+      break;
+    }
+    case ESP_GATTS_WRITE_EVT: {
+      // 用戶端寫入 CCCD 以啟用/停用通知，各連線分別記錄
+      if (_ble2902 == NULL || param->write.handle != _ble2902->getHandle() || param->write.len < 2) break;
+      int i = _bleConnFind(param->write.conn_id);
+      if (i >= 0) _bleConns[i].info.subscribed = (param->write.value[0] & 0x01) != 0;
+      break;
+    }
+    default:
+      break;
+  }
+  deviceConnected = _bleConnCount > 0;
+  portEXIT_CRITICAL(&_bleConnMux);
+}
+
+// 定義回調類別處理連線狀態 (連線表由 _bleGattsHandler 維護)
 class MyServerCallbacks: public BLEServerCallbacks {
     void onConnect(BLEServer* pServer) {
-      deviceConnected = true;
-      Serial.println("BLE 用戶已連接");
+      if (!_bleSilentMode) WM_LOGI("BLE 用戶已連接");
     };
 
     void onDisconnect(BLEServer* pServer) {
-      deviceConnected = false;
-      Serial.println("BLE 用戶已斷開");
+      if (!_bleSilentMode) WM_LOGI("BLE 用戶已斷開");
     }
 };
 
 // 定義特徵回調處理收到的數據
 class MyCallbacks: public BLECharacteristicCallbacks {
-    void onWrite(BLECharacteristic *pCharacteristic) {
-      if (_bleCallback != NULL) {
-        std::string value = pCharacteristic->getValue();
-        String message = String(value.c_str());
-        message.trim();
-        _bleCallback(message);
+    // 於藍牙堆疊任務中執行，只複製資料到接收佇列
+    void onWrite(BLECharacteristic *pCharacteristic, esp_ble_gatts_cb_param_t* param) {
+      uint16_t connId = param->write.conn_id;
+      size_t length = pCharacteristic->getLength();
+
+      portENTER_CRITICAL(&_bleConnMux);
+      int i = _bleConnFind(connId);
+      if (i >= 0) {
+        _bleConns[i].info.rxMessages++;
+        _bleConns[i].info.rxBytes += length;
+      }
+      portEXIT_CRITICAL(&_bleConnMux);
+      _wirelessMetricAdd(WIRELESS_METRIC_BLE_RX_BYTES, length);
+
+      // 沒有任何 MESSAGE 監聽函式 (包括舊版回調函式的轉接) 時不需複製資料
+      if (!_wirelessHasListener(WIRELESS_EVENT_MASK(WIRELESS_EVENT_MESSAGE))) return;
+
+      uint16_t head = _bleRxHead.load(std::memory_order_relaxed);
+      uint16_t tail = _bleRxTail.load(std::memory_order_acquire);
+      uint16_t next = (head + 1) % BLE_RX_SLOTS;
+      if (next == tail) {
+        _bleRxDropped.fetch_add(1, std::memory_order_relaxed);
+        _wirelessMetricAdd(WIRELESS_METRIC_BLE_RX_DROPS);
+        return;
+      }
+
+      if (length > BLE_RX_SLOT_LEN) {
+        length = BLE_RX_SLOT_LEN;
+        _bleRxTruncated.fetch_add(1, std::memory_order_relaxed);
+      }
+      BLERxSlot &slot = _bleRxSlots[head];
+      memcpy(slot.data, pCharacteristic->getData(), length);
+      slot.data[length] = '\0';
+      slot.length = length;
+      slot.connId = connId;
+      _bleRxHead.store(next, std::memory_order_release);
+
+      uint16_t depth = (next + BLE_RX_SLOTS - tail) % BLE_RX_SLOTS;
+      if (depth > _bleRxHighWater.load(std::memory_order_relaxed)) {
+        _bleRxHighWater.store(depth, std::memory_order_relaxed);
       }
+      _bleRxReceived.fetch_add(1, std::memory_order_relaxed);
     }
 };
 
+/**
+ * 以指定的間隔設定(重新)開始廣播
+ * @param fast 使用快速間隔 (否則使用慢速間隔)
+ */
+static void _bleStartAdvertising(bool fast) {
+  BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
+  uint16_t minMs = fast ? _bleAdvFastMin : _bleAdvSlowMin;
+  uint16_t maxMs = fast ? _bleAdvFastMax : _bleAdvSlowMax;
+
+  // 廣播間隔單位為 0.625 毫秒，變更後需重新啟動廣播才會生效
+  pAdvertising->stop();
+  pAdvertising->setMinInterval((uint16_t)(minMs * 8UL / 5));
+  pAdvertising->setMaxInterval((uint16_t)(maxMs * 8UL / 5));
+  pAdvertising->start();
+
+  _bleAdvState = fast ? BLE_ADV_FAST : BLE_ADV_SLOW;
+  _bleAdvDeadline = millis() + _bleAdvFastDuration;
+
+  if (!_bleSilentMode) {
+    WM_LOGD("BLE 廣播間隔: %u-%u ms", minMs, maxMs);
+  }
+}
+
+/**
+ * 設定低功耗藍牙廣播間隔
+ * @param fastMinMs 快速廣播最小間隔(毫秒)
+ * @param fastMaxMs 快速廣播最大間隔(毫秒)
+ * @param fastDurationMs 快速廣播持續時間(毫秒)，0 表示不切換到慢速
+ * @param slowMinMs 慢速廣播最小間隔(毫秒)
+ * @param slowMaxMs 慢速廣播最大間隔(毫秒)
+ * @param silentMode 是否安靜模式
+ */
+void BLE_setAdvertisingProfile(uint16_t fastMinMs, uint16_t fastMaxMs, unsigned long fastDurationMs,
+                               uint16_t slowMinMs, uint16_t slowMaxMs, bool silentMode) {
+  _bleAdvFastMin = constrain(fastMinMs, 20, 10240);
+  _bleAdvFastMax = constrain(fastMaxMs, _bleAdvFastMin, 10240);
+  _bleAdvFastDuration = fastDurationMs;
+  _bleAdvSlowMin = constrain(slowMinMs, 20, 10240);
+  _bleAdvSlowMax = constrain(slowMaxMs, _bleAdvSlowMin, 10240);
+
+  // 廣播中則立即套用新的間隔
+  if (_bleAdvState == BLE_ADV_FAST || _bleAdvState == BLE_ADV_SLOW) {
+    _bleStartAdvertising(_bleAdvState == BLE_ADV_FAST);
+  }
+
+  if (!silentMode) {
+    WM_LOGI("BLE 廣播間隔: 快速 %u-%u ms (%lu ms), 慢速 %u-%u ms",
+            _bleAdvFastMin, _bleAdvFastMax, fastDurationMs, _bleAdvSlowMin, _bleAdvSlowMax);
+  }
+}
+
 /**
  * 設定低功耗藍牙連接參數
  * @param bleName 藍牙顯示名稱
  */
 void BLE_setup(const char* bleName, bool silentMode) {
+  _bleSilentMode = silentMode;
+  if (_bleTxLock == NULL) {
+    _bleTxLock = xSemaphoreCreateMutex();
+  }
+
   // 創建 BLE 設備
   BLEDevice::init(bleName);
+  BLEDevice::setMTU(BLE_MTU);
+  BLEDevice::setCustomGattsHandler(_bleGattsHandler);
   
   // 創建 BLE 伺服器
   pServer = BLEDevice::createServer();
@@ -272,7 +1006,8 @@ void BLE_setup(const char* bleName, bool silentMode) {
                     );
                     
   // 創建 BLE Descriptor
-  pCharacteristic->addDescriptor(new BLE2902());
+  _ble2902 = new BLE2902();
+  pCharacteristic->addDescriptor(_ble2902);
   
   // 設置特徵回調
   pCharacteristic->setCallbacks(new MyCallbacks());
@@ -286,19 +1021,18 @@ void BLE_setup(const char* bleName, bool silentMode) {
   pAdvertising->setScanResponse(true);
   pAdvertising->setMinPreferred(0x06);  // 連線優先級
   pAdvertising->setMinPreferred(0x12);
-  BLEDevice::startAdvertising();
+  _bleStartAdvertising(true);
   
   if (!silentMode) {
-    Serial.println("--------------------------------");
-    Serial.println("低功耗藍牙(BLE)設定:");
-    Serial.print("- 設備名稱: ");
-    Serial.println(bleName);
-    Serial.println("- 等待連線中...");
+    WM_LOGI(WM_SEPARATOR);
+    WM_LOGI("低功耗藍牙(BLE)設定:");
+    WM_LOGI("- 設備名稱: %s", bleName);
+    WM_LOGI("- 等待連線中...");
     
     if (_bleCallback != NULL) {
-      Serial.println("- 回調函式已設定");
+      WM_LOGI("- 回調函式已設定");
     }
-    Serial.println("--------------------------------");
+    WM_LOGI(WM_SEPARATOR);
   }
 }
 
@@ -308,8 +1042,152 @@ void BLE_setup(const char* bleName, bool silentMode) {
  */
 void BLE_setCallback(BLECallbackFunction callback, bool silentMode) {
   _bleCallback = callback;
+  if (callback != NULL) {
+    Wireless_on(WIRELESS_EVENT_MASK(WIRELESS_EVENT_MESSAGE), _bleLegacyAdapter);
+  } else {
+    Wireless_off(_bleLegacyAdapter);
+  }
   if (!silentMode) {
-    Serial.println("低功耗藍牙回調函式已設定");
+    WM_LOGI("低功耗藍牙回調函式已設定");
+  }
+}
+
+/**
+ * 設定低功耗藍牙二進位資料回調函式
+ * @param callback 回調函式指針
+ * @param ctx 傳給回調函式的使用者資料
+ */
+void BLE_setDataCallback(BLEDataCallback callback, void* ctx, bool silentMode) {
+  _bleDataCallback = callback;
+  _bleDataCtx = ctx;
+  if (callback != NULL) {
+    Wireless_on(WIRELESS_EVENT_MASK(WIRELESS_EVENT_MESSAGE), _bleDataAdapter);
+  } else {
+    Wireless_off(_bleDataAdapter);
+  }
+  if (!silentMode) {
+    WM_LOGI("低功耗藍牙資料回調函式已設定");
+  }
+}
+
+/**
+ * 取得低功耗藍牙接收佇列統計資訊
+ * @param stats 輸出的統計資訊
+ */
+void BLE_getRxStats(BLERxStats &stats) {
+  uint16_t head = _bleRxHead.load(std::memory_order_acquire);
+  uint16_t tail = _bleRxTail.load(std::memory_order_acquire);
+  stats.depth = (head + BLE_RX_SLOTS - tail) % BLE_RX_SLOTS;
+  stats.capacity = BLE_RX_QUEUE_SIZE;
+  stats.highWater = _bleRxHighWater.load(std::memory_order_relaxed);
+  stats.received = _bleRxReceived.load(std::memory_order_relaxed);
+  stats.dropped = _bleRxDropped.load(std::memory_order_relaxed);
+  stats.truncated = _bleRxTruncated.load(std::memory_order_relaxed);
+}
+
+/**
+ * 以 MESSAGE 事件通知監聽函式 (包含資料與舊版字串回調函式，data 需以 '\0' 結尾)
+ * 服務任務執行中時由 Wireless_dispatch 在應用程式的任務中呼叫
+ */
+void _bleDeliver(uint16_t connId, const uint8_t* data, size_t length) {
+  WirelessEvent event = {};
+  event.type = WIRELESS_EVENT_MESSAGE;
+  event.source = WIRELESS_SOURCE_BLE;
+  event.id = connId;
+  event.data = data;
+  event.length = length;
+  Wireless_emit(event);
+}
+
+/**
+ * 取出接收佇列中的訊息並呼叫回調函式
+ */
+static void _bleDrainRx() {
+  uint16_t tail = _bleRxTail.load(std::memory_order_relaxed);
+  // 每次最多處理一輪，避免持續寫入時卡住主迴圈
+  for (uint16_t n = 0; n < BLE_RX_QUEUE_SIZE; n++) {
+    if (tail == _bleRxHead.load(std::memory_order_acquire)) break;
+
+    BLERxSlot &slot = _bleRxSlots[tail];
+    if (_wirelessServiceDefer()) {
+      _wirelessServicePostInbound(WIRELESS_INBOUND_BLE, slot.connId, NULL, slot.data, slot.length);
+    } else {
+      _bleDeliver(slot.connId, slot.data, slot.length);
+    }
+
+    tail = (tail + 1) % BLE_RX_SLOTS;
+    _bleRxTail.store(tail, std::memory_order_release);
+  }
+}
+
+// 已發出 LINK_UP 事件的連線 (只在 BLE_loop 中存取)
+typedef struct {
+  bool used;
+  uint16_t connId;
+  uint32_t generation;
+  uint8_t address[6];
+} BLEAnnounced;
+
+static BLEAnnounced _bleAnnounced[BLE_MAX_CONNECTIONS];
+
+/**
+ * 比對連線表與已通知的連線，在主迴圈中發出 LINK_UP/LINK_DOWN 事件
+ * 以連線的世代比對，兩次呼叫之間斷線後又以相同 connId 連線時仍會發出兩個事件
+ */
+static void _bleEmitLinkEvents() {
+  BLEConnSlot conns[BLE_MAX_CONNECTIONS];
+  portENTER_CRITICAL(&_bleConnMux);
+  memcpy(conns, _bleConns, sizeof(conns));
+  portEXIT_CRITICAL(&_bleConnMux);
+
+  WirelessEvent event = {};
+  event.source = WIRELESS_SOURCE_BLE;
+
+  // 已斷線的連線
+  for (int a = 0; a < BLE_MAX_CONNECTIONS; a++) {
+    if (!_bleAnnounced[a].used) continue;
+    bool alive = false;
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+      if (conns[i].active && conns[i].generation == _bleAnnounced[a].generation) alive = true;
+    }
+    if (alive) continue;
+    _bleAnnounced[a].used = false;
+    event.type = WIRELESS_EVENT_LINK_DOWN;
+    event.id = _bleAnnounced[a].connId;
+    event.address = _bleAnnounced[a].address;
+    Wireless_emit(event);
+  }
+
+  // 新建立的連線
+  for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+    if (!conns[i].active) continue;
+    int freeSlot = -1;
+    bool known = false;
+    for (int a = 0; a < BLE_MAX_CONNECTIONS; a++) {
+      if (_bleAnnounced[a].used && _bleAnnounced[a].generation == conns[i].generation) known = true;
+      if (!_bleAnnounced[a].used && freeSlot < 0) freeSlot = a;
+    }
+    if (known || freeSlot < 0) continue;
+    _bleAnnounced[freeSlot].used = true;
+    _bleAnnounced[freeSlot].connId = conns[i].info.connId;
+    _bleAnnounced[freeSlot].generation = conns[i].generation;
+    memcpy(_bleAnnounced[freeSlot].address, conns[i].info.address, 6);
+    event.type = WIRELESS_EVENT_LINK_UP;
+    event.id = conns[i].info.connId;
+    event.address = _bleAnnounced[freeSlot].address;
+    Wireless_emit(event);
+  }
+}
+
+/**
+ * 設定同時連線的中央設備數上限
+ * @param maxConnections 連線數上限 (1 ~ BLE_MAX_CONNECTIONS)
+ * @param silentMode 是否安靜模式
+ */
+void BLE_setMaxConnections(uint8_t maxConnections, bool silentMode) {
+  _bleMaxConns = constrain(maxConnections, 1, BLE_MAX_CONNECTIONS);
+  if (!silentMode) {
+    WM_LOGI("BLE 連線數上限: %u", _bleMaxConns);
   }
 }
 
@@ -318,39 +1196,327 @@ void BLE_setCallback(BLECallbackFunction callback, bool silentMode) {
  * 此函式應在主迴圈中定期呼叫
  */
 void BLE_loop() {
-  // 處理重新連線
-  if (!deviceConnected && oldDeviceConnected) {
-    delay(500); // 給藍牙堆疊時間處理
-    pServer->startAdvertising(); // 重新開始廣播
-    oldDeviceConnected = deviceConnected;
+  _bleDrainRx();
+
+  if (pServer == NULL) return;
+
+  // 連線數相同不代表連線未變動 (兩次呼叫之間可能一斷一連)，以世代判斷
+  portENTER_CRITICAL(&_bleConnMux);
+  uint32_t generation = _bleConnGeneration;
+  portEXIT_CRITICAL(&_bleConnMux);
+  bool changed = generation != _bleLastGeneration;
+  _bleLastGeneration = generation;
+
+  uint8_t count = _bleConnCount;
+  unsigned long now = millis();
+
+  if (changed) {
+    _bleEmitLinkEvents();
   }
-  
-  // 已連線
-  if (deviceConnected && !oldDeviceConnected) {
-    oldDeviceConnected = deviceConnected;
+
+  if (count >= _bleMaxConns) {
+    // 已達連線上限，停止廣播
+    if (_bleAdvState != BLE_ADV_IDLE) {
+      BLEDevice::getAdvertising()->stop();
+      _bleAdvState = BLE_ADV_IDLE;
+    }
+  } else if (changed || _bleAdvState == BLE_ADV_IDLE) {
+    // 連線數變動 (藍牙堆疊在建立連線時會停止廣播): 給堆疊時間處理，到期後再重新廣播
+    _bleAdvState = BLE_ADV_PENDING;
+    _bleAdvDeadline = now + BLE_ADV_RESTART_DELAY_MS;
   }
+
+  if (_bleAdvState == BLE_ADV_PENDING && (long)(now - _bleAdvDeadline) >= 0) {
+    _bleStartAdvertising(true);
+  } else if (_bleAdvState == BLE_ADV_FAST && _bleAdvFastDuration > 0 &&
+             (long)(now - _bleAdvDeadline) >= 0) {
+    _bleStartAdvertising(false);
+  }
+}
+
+/**
+ * 讀取連線的壅塞狀態
+ * @param active 輸出連線是否仍存在
+ * @return 是否壅塞中
+ */
+static bool _bleConnCongested(uint16_t connId, bool &active) {
+  portENTER_CRITICAL(&_bleConnMux);
+  int i = _bleConnFind(connId);
+  active = i >= 0;
+  bool congested = active && _bleConns[i].congested;
+  portEXIT_CRITICAL(&_bleConnMux);
+  return congested;
 }
 
 /**
- * 透過低功耗藍牙發送訊息
+ * 發送單一通知，必要時等待壅塞解除並重試
+ * @return 是否成功交給藍牙堆疊
+ */
+static bool _bleNotify(uint16_t connId, uint8_t* data, size_t length) {
+  bool active;
+  if (_bleConnCongested(connId, active)) {
+    _bleTxStats.congestionWaits++;
+    unsigned long waitStart = millis();
+    while (_bleConnCongested(connId, active)) {
+      if (millis() - waitStart >= BLE_CONGEST_TIMEOUT_MS) return false;
+      delay(1);
+    }
+  }
+  if (!active) return false;
+
+  for (uint8_t attempt = 0; ; attempt++) {
+    esp_err_t err = esp_ble_gatts_send_indicate(
+      pServer->getGattsIf(), connId, pCharacteristic->getHandle(),
+      length, data, false
+    );
+    if (err == ESP_OK) return true;
+    _bleConnCongested(connId, active);
+    if (attempt >= BLE_TX_MAX_RETRIES || !active) return false;
+    _bleTxStats.retries++;
+    delay(2 << attempt);
+  }
+}
+
+/**
+ * 將資料切成 MTU 大小的通知依序送給單一連線
+ * @param connId 連線識別碼
+ * @param mtu 該連線的 ATT MTU
+ * @param data 資料
+ * @param length 資料長度
+ * @param newline 是否在資料後附加換行
+ * @return 是否全部送出
+ */
+static bool _bleSendChunks(uint16_t connId, uint16_t mtu, const uint8_t* data, size_t length, bool newline) {
+  size_t total = length + (newline ? 1 : 0);
+  size_t header = _bleChunkHeader ? 1 : 0;
+  if (mtu > BLE_MTU) mtu = BLE_MTU;
+  size_t perChunk = mtu - 3 - header;   // 扣除 ATT 通知標頭 (3 位元組)
+
+  unsigned long start = millis();
+  unsigned long startUs = micros();
+  size_t sent = 0;
+  uint8_t seq = 0;
+  do {
+    size_t n = total - sent;
+    if (n > perChunk) n = perChunk;
+
+    size_t pos = 0;
+    if (header) {
+      uint8_t flags = 0;
+      if (sent == 0) flags |= BLE_CHUNK_FIRST;
+      if (sent + n == total) flags |= BLE_CHUNK_LAST;
+      _bleChunk[pos++] = flags | (seq++ & BLE_CHUNK_SEQ_MASK);
+    }
+    size_t fromData = (sent < length) ? length - sent : 0;
+    if (fromData > n) fromData = n;
+    memcpy(_bleChunk + pos, data + sent, fromData);
+    pos += fromData;
+    if (fromData < n) _bleChunk[pos++] = '\n';
+
+    if (!_bleNotify(connId, _bleChunk, pos)) {
+      _bleTxStats.failed++;
+      _wirelessMetricAdd(WIRELESS_METRIC_BLE_NOTIFY_FAILURES);
+      return false;
+    }
+    _bleTxStats.chunks++;
+    sent += n;
+  } while (sent < total);
+
+  unsigned long elapsed = millis() - start;
+  _bleTxStats.messages++;
+  _bleTxStats.bytes += total;
+  _bleTxStats.bytesPerSec = elapsed > 0 ? (uint32_t)(total * 1000UL / elapsed) : total * 1000UL;
+  _wirelessMetricAdd(WIRELESS_METRIC_BLE_TX_BYTES, total);
+  _wirelessMetricLatency(WIRELESS_HIST_BLE_SEND, micros() - startUs);
+
+  portENTER_CRITICAL(&_bleConnMux);
+  int i = _bleConnFind(connId);
+  if (i >= 0) {
+    _bleConns[i].info.txMessages++;
+    _bleConns[i].info.txBytes += total;
+  }
+  portEXIT_CRITICAL(&_bleConnMux);
+  return true;
+}
+
+/**
+ * 發送給指定連線，或 connId 為 -1 時發送給所有已啟用通知的連線
+ * @return 成功送達的連線數
+ */
+static int _bleSend(int connId, const uint8_t* data, size_t length, bool newline, bool silentMode) {
+  // 先複製目標連線，傳送期間不持有鎖
+  uint16_t ids[BLE_MAX_CONNECTIONS];
+  uint16_t mtus[BLE_MAX_CONNECTIONS];
+  int targets = 0;
+  bool found = false;
+
+  portENTER_CRITICAL(&_bleConnMux);
+  for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+    if (!_bleConns[i].active) continue;
+    if (connId >= 0 && _bleConns[i].info.connId != connId) continue;
+    found = true;
+    if (!_bleConns[i].info.subscribed) continue;
+    ids[targets] = _bleConns[i].info.connId;
+    mtus[targets] = _bleConns[i].info.mtu;
+    targets++;
+  }
+  portEXIT_CRITICAL(&_bleConnMux);
+
+  if (!found) {
+    if (!silentMode) {
+      WM_LOGW("低功耗藍牙未連接，無法發送訊息");
+    }
+    return 0;
+  }
+  if (targets == 0) {
+    if (!silentMode) {
+      WM_LOGW("低功耗藍牙用戶端未啟用通知，無法發送訊息");
+    }
+    return 0;
+  }
+
+  xSemaphoreTake(_bleTxLock, portMAX_DELAY);
+
+  // 讀取特徵值時回傳最後一則訊息
+  pCharacteristic->setValue((uint8_t*)data, length);
+
+  int delivered = 0;
+  for (int t = 0; t < targets; t++) {
+    if (_bleSendChunks(ids[t], mtus[t], data, length, newline)) {
+      delivered++;
+    } else if (!silentMode) {
+      WM_LOGW("低功耗藍牙發送失敗 (連線 %u, %u 位元組)", ids[t], (unsigned)length);
+    }
+  }
+
+  xSemaphoreGive(_bleTxLock);
+  return delivered;
+}
+
+/**
+ * 透過低功耗藍牙發送訊息給所有已啟用通知的連線
+ * 超過 MTU 的訊息會自動分段
  * @param message 要發送的訊息
- * @return 是否成功發送
+ * @return 是否至少送達一個連線
  */
 bool BLE_sendMessage(const String &message, bool ln, bool silentMode) {
-  if (deviceConnected) {
-    String sendStr = message;
-    if (ln) {
-      sendStr += "\n";
-    }
-    pCharacteristic->setValue(sendStr.c_str());
-    pCharacteristic->notify();
-    return true;
-  } else {
+  return _bleSend(-1, (const uint8_t*)message.c_str(), message.length(), ln, silentMode) > 0;
+}
+
+/**
+ * 透過低功耗藍牙發送二進位資料給所有已啟用通知的連線
+ * 超過 MTU 的資料會自動分段
+ * @param data 資料
+ * @param length 資料長度
+ * @return 是否至少送達一個連線
+ */
+bool BLE_sendData(const uint8_t* data, size_t length, bool silentMode) {
+  return _bleSend(-1, data, length, false, silentMode) > 0;
+}
+
+/**
+ * 透過低功耗藍牙發送以 CborWriter 編碼的資料給所有已啟用通知的連線
+ * @param writer 已完成編碼的 CBOR 內容
+ * @return 是否至少送達一個連線 (編碼時緩衝區不足則不發送)
+ */
+bool BLE_sendCbor(const CborWriter &writer, bool silentMode) {
+  if (writer.overflow) {
     if (!silentMode) {
-      Serial.println("低功耗藍牙未連接，無法發送訊息");
+      WM_LOGW("CBOR 編碼緩衝區不足，未發送");
     }
     return false;
   }
+  return _bleSend(-1, writer.buffer, writer.length, false, silentMode) > 0;
+}
+
+/**
+ * 透過低功耗藍牙發送二進位資料給指定連線
+ * @param connId 連線識別碼
+ * @param data 資料
+ * @param length 資料長度
+ * @return 是否成功發送
+ */
+bool BLE_sendTo(uint16_t connId, const uint8_t* data, size_t length, bool silentMode) {
+  return _bleSend(connId, data, length, false, silentMode) > 0;
+}
+
+/**
+ * 透過低功耗藍牙發送二進位資料給所有已啟用通知的連線
+ * @param data 資料
+ * @param length 資料長度
+ * @return 成功送達的連線數
+ */
+int BLE_broadcast(const uint8_t* data, size_t length, bool silentMode) {
+  return _bleSend(-1, data, length, false, silentMode);
+}
+
+/**
+ * 設定是否在每個通知前加上分段標頭
+ * @param enable 啟用時第一個位元組為 BLE_CHUNK_FIRST/BLE_CHUNK_LAST 旗標與段序號
+ */
+void BLE_setChunkHeader(bool enable) {
+  _bleChunkHeader = enable;
+}
+
+/**
+ * 取得 ATT MTU
+ * @param connId 連線識別碼，-1 表示取各連線中最小的值
+ * @return MTU (沒有對應連線時為預設值 23)
+ */
+uint16_t BLE_getMTU(int connId) {
+  uint16_t mtu = 0;
+  portENTER_CRITICAL(&_bleConnMux);
+  for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+    if (!_bleConns[i].active) continue;
+    if (connId >= 0 && _bleConns[i].info.connId != connId) continue;
+    if (mtu == 0 || _bleConns[i].info.mtu < mtu) mtu = _bleConns[i].info.mtu;
+  }
+  portEXIT_CRITICAL(&_bleConnMux);
+  return mtu > 0 ? mtu : 23;
+}
+
+/**
+ * 取得目前的連線數
+ * @return 連線數
+ */
+uint8_t BLE_getConnectionCount() {
+  return _bleConnCount;
+}
+
+/**
+ * 取得單一連線資訊
+ * @param index 連線索引 (0 ~ BLE_getConnectionCount() - 1)
+ * @param info 輸出的連線資訊
+ * @return 索引是否有效
+ */
+bool BLE_getConnection(uint8_t index, BLEConnectionInfo &info) {
+  bool found = false;
+  portENTER_CRITICAL(&_bleConnMux);
+  for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+    if (!_bleConns[i].active) continue;
+    if (index-- == 0) {
+      info = _bleConns[i].info;
+      found = true;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&_bleConnMux);
+  return found;
+}
+
+/**
+ * 取得低功耗藍牙傳送統計資訊
+ * @param stats 輸出的統計資訊
+ */
+void BLE_getTxStats(BLETxStats &stats) {
+  if (_bleTxLock != NULL) {
+    xSemaphoreTake(_bleTxLock, portMAX_DELAY);
+    stats = _bleTxStats;
+    xSemaphoreGive(_bleTxLock);
+  } else {
+    stats = _bleTxStats;
+  }
+  stats.mtu = BLE_getMTU();
 }
 
 /**
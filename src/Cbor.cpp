@@ -0,0 +1,435 @@
+#include "Wireless_mgmt.h"
+#include "Arduino.h"
+
+// ==========================================
+// CBOR (RFC 8949)
+// ==========================================
+
+// 主要類型 (首位元組的高 3 位元)
+#define CBOR_MAJOR_UINT     0
+#define CBOR_MAJOR_NEGINT   1
+#define CBOR_MAJOR_BYTES    2
+#define CBOR_MAJOR_TEXT     3
+#define CBOR_MAJOR_ARRAY    4
+#define CBOR_MAJOR_MAP      5
+#define CBOR_MAJOR_TAG      6
+#define CBOR_MAJOR_SIMPLE   7
+
+#define CBOR_FALSE          0xF4
+#define CBOR_TRUE           0xF5
+#define CBOR_NULL           0xF6
+#define CBOR_FLOAT32        0xFA
+#define CBOR_FLOAT64        0xFB
+
+static uint8_t _cborShared[CBOR_SHARED_BUFFER_LEN];
+
+/**
+ * 初始化編碼器
+ * @param buffer 輸出緩衝區
+ * @param capacity 緩衝區大小
+ */
+void Cbor_writerInit(CborWriter &writer, uint8_t* buffer, size_t capacity) {
+  writer.buffer = buffer;
+  writer.capacity = buffer != NULL ? capacity : 0;
+  writer.length = 0;
+  writer.overflow = false;
+}
+
+/**
+ * 以函式庫的共用緩衝區初始化編碼器
+ * 共用緩衝區只能由一個任務使用 (例如主迴圈)，下次初始化時內容即被覆寫
+ */
+void Cbor_writerInitShared(CborWriter &writer) {
+  Cbor_writerInit(writer, _cborShared, sizeof(_cborShared));
+}
+
+/**
+ * 保留輸出空間，不足時標記溢位
+ */
+static uint8_t* _cborReserve(CborWriter &writer, size_t size) {
+  if (writer.overflow || writer.capacity - writer.length < size) {
+    writer.overflow = true;
+    return NULL;
+  }
+  uint8_t* out = writer.buffer + writer.length;
+  writer.length += size;
+  return out;
+}
+
+/**
+ * 寫入大端序整數
+ */
+static void _cborPutBE(uint8_t* out, uint64_t value, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    out[i] = (uint8_t)(value >> (8 * (size - 1 - i)));
+  }
+}
+
+/**
+ * 寫入項目首部: 主要類型與以最短形式編碼的參數
+ */
+static bool _cborWriteHead(CborWriter &writer, uint8_t major, uint64_t value) {
+  uint8_t prefix = major << 5;
+  size_t size;
+  uint8_t info;
+  if (value < 24) {
+    size = 0;
+    info = (uint8_t)value;
+  } else if (value <= 0xFF) {
+    size = 1;
+    info = 24;
+  } else if (value <= 0xFFFF) {
+    size = 2;
+    info = 25;
+  } else if (value <= 0xFFFFFFFFUL) {
+    size = 4;
+    info = 26;
+  } else {
+    size = 8;
+    info = 27;
+  }
+
+  uint8_t* out = _cborReserve(writer, 1 + size);
+  if (out == NULL) return false;
+  out[0] = prefix | info;
+  _cborPutBE(out + 1, value, size);
+  return true;
+}
+
+bool Cbor_writeUint(CborWriter &writer, uint64_t value) {
+  return _cborWriteHead(writer, CBOR_MAJOR_UINT, value);
+}
+
+bool Cbor_writeInt(CborWriter &writer, int64_t value) {
+  if (value >= 0) {
+    return _cborWriteHead(writer, CBOR_MAJOR_UINT, (uint64_t)value);
+  }
+  // 負整數編碼為 -1 - n
+  return _cborWriteHead(writer, CBOR_MAJOR_NEGINT, ~(uint64_t)value);
+}
+
+/**
+ * 寫入單精度浮點數 (5 位元組)
+ */
+bool Cbor_writeFloat(CborWriter &writer, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  uint8_t* out = _cborReserve(writer, 5);
+  if (out == NULL) return false;
+  out[0] = CBOR_FLOAT32;
+  _cborPutBE(out + 1, bits, 4);
+  return true;
+}
+
+/**
+ * 寫入浮點數，可無損轉為單精度時以單精度編碼
+ */
+bool Cbor_writeDouble(CborWriter &writer, double value) {
+  float narrow = (float)value;
+  if ((double)narrow == value || value != value) {
+    return Cbor_writeFloat(writer, narrow);
+  }
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  uint8_t* out = _cborReserve(writer, 9);
+  if (out == NULL) return false;
+  out[0] = CBOR_FLOAT64;
+  _cborPutBE(out + 1, bits, 8);
+  return true;
+}
+
+bool Cbor_writeBool(CborWriter &writer, bool value) {
+  uint8_t* out = _cborReserve(writer, 1);
+  if (out == NULL) return false;
+  out[0] = value ? CBOR_TRUE : CBOR_FALSE;
+  return true;
+}
+
+bool Cbor_writeNull(CborWriter &writer) {
+  uint8_t* out = _cborReserve(writer, 1);
+  if (out == NULL) return false;
+  out[0] = CBOR_NULL;
+  return true;
+}
+
+bool Cbor_writeText(CborWriter &writer, const char* text) {
+  return Cbor_writeText(writer, text, text != NULL ? strlen(text) : 0);
+}
+
+/**
+ * 寫入 UTF-8 字串
+ * @param text 字串內容
+ * @param length 位元組數
+ */
+bool Cbor_writeText(CborWriter &writer, const char* text, size_t length) {
+  if (!_cborWriteHead(writer, CBOR_MAJOR_TEXT, length)) return false;
+  uint8_t* out = _cborReserve(writer, length);
+  if (out == NULL) return false;
+  memcpy(out, text, length);
+  return true;
+}
+
+bool Cbor_writeBytes(CborWriter &writer, const uint8_t* data, size_t length) {
+  if (!_cborWriteHead(writer, CBOR_MAJOR_BYTES, length)) return false;
+  uint8_t* out = _cborReserve(writer, length);
+  if (out == NULL) return false;
+  memcpy(out, data, length);
+  return true;
+}
+
+/**
+ * 開始陣列，之後須寫入 count 個項目
+ */
+bool Cbor_beginArray(CborWriter &writer, size_t count) {
+  return _cborWriteHead(writer, CBOR_MAJOR_ARRAY, count);
+}
+
+/**
+ * 開始映射表，之後須依序寫入 pairs 組鍵與值
+ */
+bool Cbor_beginMap(CborWriter &writer, size_t pairs) {
+  return _cborWriteHead(writer, CBOR_MAJOR_MAP, pairs);
+}
+
+/**
+ * 寫入標籤，之後須寫入被標記的項目 (例如 1 為 epoch 時間)
+ */
+bool Cbor_writeTag(CborWriter &writer, uint64_t tag) {
+  return _cborWriteHead(writer, CBOR_MAJOR_TAG, tag);
+}
+
+/**
+ * 初始化解碼器，資料須在解碼期間保持有效
+ * @param data 編碼後的資料 (例如 MQTT 或 BLE 回調函式收到的內容)
+ * @param length 資料長度
+ */
+void Cbor_readerInit(CborReader &reader, const uint8_t* data, size_t length) {
+  reader.data = data;
+  reader.length = data != NULL ? length : 0;
+  reader.pos = 0;
+  reader.error = false;
+}
+
+/**
+ * 讀取大端序整數，資料不足時標記錯誤
+ */
+static bool _cborGetBE(CborReader &reader, size_t size, uint64_t &value) {
+  if (reader.length - reader.pos < size) {
+    reader.error = true;
+    return false;
+  }
+  value = 0;
+  for (size_t i = 0; i < size; i++) {
+    value = (value << 8) | reader.data[reader.pos++];
+  }
+  return true;
+}
+
+/**
+ * 將半精度浮點數轉為 double
+ */
+static double _cborHalfToDouble(uint16_t half) {
+  int exponent = (half >> 10) & 0x1F;
+  int mantissa = half & 0x3FF;
+  double value;
+  if (exponent == 0) {
+    value = ldexp(mantissa, -24);
+  } else if (exponent != 31) {
+    value = ldexp(mantissa + 1024, exponent - 25);
+  } else {
+    value = mantissa == 0 ? INFINITY : NAN;
+  }
+  return (half & 0x8000) ? -value : value;
+}
+
+/**
+ * 讀取下一個項目
+ * 陣列與映射表只讀取首部，其元素由之後的 Cbor_read 依序取得
+ * @param item 輸出的項目
+ * @return 是否讀到項目 (資料結尾或格式錯誤時為 false，錯誤時 reader.error 為 true)
+ */
+bool Cbor_read(CborReader &reader, CborItem &item) {
+  if (reader.error || reader.pos >= reader.length) {
+    return false;
+  }
+
+  uint8_t initial = reader.data[reader.pos++];
+  uint8_t major = initial >> 5;
+  uint8_t info = initial & 0x1F;
+
+  uint64_t value = info;
+  if (info >= 24) {
+    if (info > 27) {
+      // 不支援不定長度 (31) 與保留值
+      reader.error = true;
+      return false;
+    }
+    if (!_cborGetBE(reader, (size_t)1 << (info - 24), value)) return false;
+  }
+
+  memset(&item, 0, sizeof(item));
+  switch (major) {
+    case CBOR_MAJOR_UINT:
+      item.type = CBOR_TYPE_UINT;
+      item.uintValue = value;
+      item.intValue = (int64_t)value;
+      break;
+    case CBOR_MAJOR_NEGINT:
+      // 值為 -1 - value，超出 int64_t 範圍時 intValue 保持為 0，由 Cbor_getInt 回報
+      item.type = CBOR_TYPE_NEGINT;
+      item.uintValue = value;
+      if (value <= (uint64_t)INT64_MAX) item.intValue = -1 - (int64_t)value;
+      break;
+    case CBOR_MAJOR_BYTES:
+    case CBOR_MAJOR_TEXT:
+      if (value > reader.length - reader.pos) {
+        reader.error = true;
+        return false;
+      }
+      item.type = major == CBOR_MAJOR_TEXT ? CBOR_TYPE_TEXT : CBOR_TYPE_BYTES;
+      item.data = reader.data + reader.pos;
+      item.length = (size_t)value;
+      reader.pos += (size_t)value;
+      break;
+    case CBOR_MAJOR_ARRAY:
+      item.type = CBOR_TYPE_ARRAY;
+      item.length = (size_t)value;
+      break;
+    case CBOR_MAJOR_MAP:
+      item.type = CBOR_TYPE_MAP;
+      item.length = (size_t)value;
+      break;
+    case CBOR_MAJOR_TAG:
+      item.type = CBOR_TYPE_TAG;
+      item.uintValue = value;
+      break;
+    default:
+      if (info == 20 || info == 21) {
+        item.type = CBOR_TYPE_BOOL;
+        item.boolValue = info == 21;
+      } else if (info == 22) {
+        item.type = CBOR_TYPE_NULL;
+      } else if (info == 25) {
+        item.type = CBOR_TYPE_FLOAT;
+        item.floatValue = _cborHalfToDouble((uint16_t)value);
+      } else if (info == 26) {
+        uint32_t bits = (uint32_t)value;
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        item.type = CBOR_TYPE_FLOAT;
+        item.floatValue = f;
+      } else if (info == 27) {
+        item.type = CBOR_TYPE_FLOAT;
+        memcpy(&item.floatValue, &value, sizeof(item.floatValue));
+      } else {
+        // undefined 與其他簡單值
+        item.type = CBOR_TYPE_UNDEFINED;
+        item.uintValue = value;
+      }
+      break;
+  }
+  return true;
+}
+
+/**
+ * 跳過下一個完整的項目 (含陣列、映射表與標籤的所有內容)，不使用遞迴
+ * @return 是否成功跳過
+ */
+bool Cbor_skip(CborReader &reader) {
+  uint32_t remaining = 1;
+  CborItem item;
+  while (remaining > 0) {
+    if (!Cbor_read(reader, item)) {
+      reader.error = true;
+      return false;
+    }
+    remaining--;
+
+    uint64_t children = 0;
+    if (item.type == CBOR_TYPE_ARRAY) {
+      children = item.length;
+    } else if (item.type == CBOR_TYPE_MAP) {
+      children = (uint64_t)item.length * 2;
+    } else if (item.type == CBOR_TYPE_TAG) {
+      children = 1;
+    }
+    // 每個元素至少 1 位元組，超過剩餘資料即為格式錯誤
+    if (remaining + children > reader.length - reader.pos) {
+      reader.error = true;
+      return false;
+    }
+    remaining += (uint32_t)children;
+  }
+  return true;
+}
+
+/**
+ * 在映射表中尋找文字鍵，鍵之前的配對會被跳過
+ * 找到時 reader 停在值的首部之後 (值為陣列或映射表時可繼續讀取其元素)；
+ * 同一個映射表要再次尋找需重新初始化 reader
+ * @param pairs 映射表剩餘的配對數 (Cbor_read 讀到的 MAP 項目的 length)
+ * @param key 要尋找的鍵
+ * @param value 輸出的值
+ * @return 是否找到
+ */
+bool Cbor_mapFind(CborReader &reader, size_t pairs, const char* key, CborItem &value) {
+  CborItem item;
+  for (size_t i = 0; i < pairs; i++) {
+    size_t keyStart = reader.pos;
+    if (!Cbor_read(reader, item)) return false;
+    bool match = Cbor_textEquals(item, key);
+    if (item.type == CBOR_TYPE_ARRAY || item.type == CBOR_TYPE_MAP || item.type == CBOR_TYPE_TAG) {
+      // 非純量的鍵: 回到鍵的首部再整個跳過
+      reader.pos = keyStart;
+      if (!Cbor_skip(reader)) return false;
+    }
+    if (match) {
+      return Cbor_read(reader, value);
+    }
+    if (!Cbor_skip(reader)) return false;
+  }
+  return false;
+}
+
+/**
+ * 比較文字項目與 C 字串
+ */
+bool Cbor_textEquals(const CborItem &item, const char* text) {
+  if (item.type != CBOR_TYPE_TEXT || text == NULL) return false;
+  return strlen(text) == item.length && memcmp(item.data, text, item.length) == 0;
+}
+
+/**
+ * 取得整數值
+ * @return 項目是否為可表示為 int64_t 的整數
+ */
+bool Cbor_getInt(const CborItem &item, int64_t &value) {
+  if (item.type == CBOR_TYPE_UINT) {
+    if (item.uintValue > (uint64_t)INT64_MAX) return false;
+    value = (int64_t)item.uintValue;
+    return true;
+  }
+  if (item.type == CBOR_TYPE_NEGINT) {
+    if (item.uintValue > (uint64_t)INT64_MAX) return false;
+    value = item.intValue;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * 取得數值 (浮點數或整數)
+ * @return 項目是否為數值
+ */
+bool Cbor_getFloat(const CborItem &item, double &value) {
+  int64_t integer;
+  if (item.type == CBOR_TYPE_FLOAT) {
+    value = item.floatValue;
+    return true;
+  }
+  if (Cbor_getInt(item, integer)) {
+    value = (double)integer;
+    return true;
+  }
+  return false;
+}
\ No newline at end of file
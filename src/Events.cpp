@@ -0,0 +1,114 @@
+#include "Wireless_mgmt.h"
+#include "Arduino.h"
+
+// ==========================================
+// Events
+// ==========================================
+
+typedef struct {
+  uint32_t mask;
+  WirelessEventListener listener;
+  void* ctx;
+} WirelessListenerEntry;
+
+// 監聽函式表，listener 為 NULL 表示空位
+// WiFi 事件任務、服務任務與應用程式都會發出事件，讀寫項目時需持有 _eventMux
+static WirelessListenerEntry _eventListeners[WIRELESS_MAX_LISTENERS];
+static portMUX_TYPE _eventMux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * 註冊事件監聽函式，同一組 listener 與 ctx 重複註冊時只更新事件遮罩
+ * @param eventMask 要監聽的事件 (WIRELESS_EVENT_MASK 的組合或 WIRELESS_EVENT_ALL)
+ * @param listener 監聽函式
+ * @param ctx 傳給監聽函式的使用者資料
+ * @return 是否成功註冊 (監聽函式表已滿時返回 false)
+ */
+bool Wireless_on(uint32_t eventMask, WirelessEventListener listener, void* ctx) {
+  if (listener == NULL) {
+    return false;
+  }
+
+  bool registered = true;
+  int freeSlot = -1;
+  portENTER_CRITICAL(&_eventMux);
+  int i = 0;
+  for (; i < WIRELESS_MAX_LISTENERS; i++) {
+    if (_eventListeners[i].listener == listener && _eventListeners[i].ctx == ctx) {
+      _eventListeners[i].mask = eventMask;
+      break;
+    }
+    if (_eventListeners[i].listener == NULL && freeSlot < 0) {
+      freeSlot = i;
+    }
+  }
+  if (i == WIRELESS_MAX_LISTENERS) {
+    if (freeSlot >= 0) {
+      _eventListeners[freeSlot].mask = eventMask;
+      _eventListeners[freeSlot].ctx = ctx;
+      _eventListeners[freeSlot].listener = listener;
+    } else {
+      registered = false;
+    }
+  }
+  portEXIT_CRITICAL(&_eventMux);
+
+  if (!registered) {
+    WM_LOGW("事件監聽函式已達上限 (%d)", WIRELESS_MAX_LISTENERS);
+  }
+  return registered;
+}
+
+/**
+ * 取消註冊事件監聽函式
+ * @param listener 監聽函式
+ * @param ctx 註冊時使用的使用者資料
+ * @return 是否找到並移除
+ */
+bool Wireless_off(WirelessEventListener listener, void* ctx) {
+  bool found = false;
+  portENTER_CRITICAL(&_eventMux);
+  for (int i = 0; i < WIRELESS_MAX_LISTENERS; i++) {
+    if (_eventListeners[i].listener == listener && _eventListeners[i].ctx == ctx) {
+      _eventListeners[i].listener = NULL;
+      _eventListeners[i].mask = 0;
+      found = true;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&_eventMux);
+  return found;
+}
+
+/**
+ * 是否有監聽指定事件的函式 (供來源在複製資料前判斷是否需要處理)
+ * @param eventMask 事件遮罩
+ */
+bool _wirelessHasListener(uint32_t eventMask) {
+  bool found = false;
+  portENTER_CRITICAL(&_eventMux);
+  for (int i = 0; i < WIRELESS_MAX_LISTENERS; i++) {
+    if (_eventListeners[i].listener != NULL && (_eventListeners[i].mask & eventMask)) {
+      found = true;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&_eventMux);
+  return found;
+}
+
+/**
+ * 將事件交給所有監聽該類型的函式，不配置記憶體
+ * 每個項目在臨界區內複製後才呼叫，監聽函式中可註冊或取消註冊
+ * @param event 事件內容
+ */
+void Wireless_emit(const WirelessEvent &event) {
+  uint32_t bit = WIRELESS_EVENT_MASK(event.type);
+  for (int i = 0; i < WIRELESS_MAX_LISTENERS; i++) {
+    portENTER_CRITICAL(&_eventMux);
+    WirelessListenerEntry entry = _eventListeners[i];
+    portEXIT_CRITICAL(&_eventMux);
+    if (entry.listener != NULL && (entry.mask & bit)) {
+      entry.listener(event, entry.ctx);
+    }
+  }
+}
\ No newline at end of file
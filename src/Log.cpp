@@ -0,0 +1,94 @@
+#include "Wireless_mgmt.h"
+#include "Arduino.h"
+#include <stdarg.h>
+
+// ==========================================
+// Logging
+// ==========================================
+
+// 目前使用的輸出端，NULL表示捨棄所有日誌
+static WirelessLogSink _logSink = Wireless_logSinkSerial;
+
+// 環形緩衝區輸出端，滿時覆寫最舊的內容
+static char _logRing[WIRELESS_LOG_RING_SIZE];
+static size_t _logRingHead = 0;     // 下一個寫入位置
+static size_t _logRingUsed = 0;
+static portMUX_TYPE _logRingMux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * 格式化一行日誌並交給輸出端，格式化在固定大小的堆疊緩衝區中進行，不配置堆積記憶體
+ * 一般不直接呼叫，請使用 WM_LOGE/WM_LOGW/WM_LOGI/WM_LOGD 巨集，
+ * 低於 WIRELESS_LOG_LEVEL 的呼叫在編譯時即被移除
+ * @param level 日誌等級
+ * @param format printf 格式字串
+ */
+void Wireless_log(uint8_t level, const char* format, ...) {
+  WirelessLogSink sink = _logSink;
+  if (sink == NULL) {
+    return;
+  }
+  
+  char line[WIRELESS_LOG_BUFFER_SIZE];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  
+  if (length < 0) {
+    return;
+  }
+  // 超出緩衝區的內容會被截斷
+  if ((size_t)length >= sizeof(line)) {
+    length = sizeof(line) - 1;
+  }
+  sink(level, line, length);
+}
+
+/**
+ * 設定日誌輸出端
+ * @param sink 輸出函式，可使用 Wireless_logSinkSerial、Wireless_logSinkRing，NULL為關閉輸出
+ */
+void Wireless_setLogSink(WirelessLogSink sink) {
+  _logSink = sink;
+}
+
+/**
+ * 輸出到序列埠 (預設)
+ */
+void Wireless_logSinkSerial(uint8_t level, const char* line, size_t length) {
+  Serial.write((const uint8_t*)line, length);
+  Serial.println();
+}
+
+/**
+ * 輸出到環形緩衝區，之後以 Wireless_logRingRead 取出，可在任何任務中使用
+ */
+void Wireless_logSinkRing(uint8_t level, const char* line, size_t length) {
+  portENTER_CRITICAL(&_logRingMux);
+  for (size_t i = 0; i <= length; i++) {
+    _logRing[_logRingHead] = (i < length) ? line[i] : '\n';
+    _logRingHead = (_logRingHead + 1) % WIRELESS_LOG_RING_SIZE;
+    if (_logRingUsed < WIRELESS_LOG_RING_SIZE) {
+      _logRingUsed++;
+    }
+  }
+  portEXIT_CRITICAL(&_logRingMux);
+}
+
+/**
+ * 由環形緩衝區取出最舊的日誌內容 (各行以 '\n' 分隔)
+ * @param buffer 輸出緩衝區
+ * @param size 緩衝區大小
+ * @return 取出的位元組數
+ */
+size_t Wireless_logRingRead(char* buffer, size_t size) {
+  portENTER_CRITICAL(&_logRingMux);
+  size_t count = (_logRingUsed < size) ? _logRingUsed : size;
+  size_t tail = (_logRingHead + WIRELESS_LOG_RING_SIZE - _logRingUsed) % WIRELESS_LOG_RING_SIZE;
+  for (size_t i = 0; i < count; i++) {
+    buffer[i] = _logRing[(tail + i) % WIRELESS_LOG_RING_SIZE];
+  }
+  _logRingUsed -= count;
+  portEXIT_CRITICAL(&_logRingMux);
+  return count;
+}
@@ -0,0 +1,274 @@
+#include "Wireless_mgmt.h"
+#include "Arduino.h"
+#include <WiFi.h>
+#include <stdarg.h>
+#include <atomic>
+
+// ==========================================
+// Metrics
+// ==========================================
+
+// 直方圖各區間的上限 (微秒)，最後一個區間無上限
+static const uint32_t _metricBounds[WIRELESS_HIST_BUCKETS] = {
+  1000, 5000, 20000, 100000, 500000, 2000000, 10000000, 0xFFFFFFFFUL
+};
+
+// 發布時使用的精簡名稱
+static const char* const _metricNames[WIRELESS_METRIC_COUNT] = {
+  "wifi_conn", "wifi_fail", "wifi_disc",
+  "mqtt_conn", "mqtt_fail", "mqtt_reconn", "mqtt_pub", "mqtt_pub_fail",
+  "mqtt_tx", "mqtt_rx", "mqtt_qdrop",
+  "bt_tx", "bt_rx",
+  "ble_tx", "ble_rx", "ble_nfail", "ble_rxdrop",
+  "svc_drop"
+};
+
+static const char* const _histogramNames[WIRELESS_HIST_COUNT] = {
+  "wifi_conn", "mqtt_conn", "mqtt_pub", "bt_conn", "ble_send"
+};
+
+// 計數器可能在藍牙堆疊任務或服務任務中累加，使用不需鎖定的原子操作
+static std::atomic<uint32_t> _metricCounters[WIRELESS_METRIC_COUNT];
+
+// 直方圖與 RSSI 取樣需要一次更新多個欄位，以臨界區段保護
+static WirelessHistogram _metricHistograms[WIRELESS_HIST_COUNT];
+static uint32_t _metricRssiSamples = 0;
+static int32_t _metricRssiSum = 0;
+static int8_t _metricRssiMin = 0;
+static int8_t _metricRssiMax = 0;
+static int8_t _metricRssiLast = 0;
+static unsigned long _metricsSince = 0;
+static portMUX_TYPE _metricsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// 定期發布設定
+static char _metricsTopic[MQTT_QUEUE_TOPIC_LEN] = "";
+static unsigned long _metricsInterval = 0;
+static unsigned long _metricsNextPublish = 0;
+static unsigned long _metricsNextSample = 0;
+
+/**
+ * 累加計數器
+ */
+void _wirelessMetricAdd(WirelessMetricId id, uint32_t delta) {
+  _metricCounters[id].fetch_add(delta, std::memory_order_relaxed);
+}
+
+/**
+ * 記錄一筆延遲樣本
+ * @param us 延遲 (微秒)
+ */
+void _wirelessMetricLatency(WirelessHistogramId id, uint32_t us) {
+  uint8_t bucket = 0;
+  while (bucket < WIRELESS_HIST_BUCKETS - 1 && us > _metricBounds[bucket]) {
+    bucket++;
+  }
+
+  portENTER_CRITICAL(&_metricsMux);
+  WirelessHistogram &histogram = _metricHistograms[id];
+  if (histogram.count == 0 || us < histogram.minUs) histogram.minUs = us;
+  if (us > histogram.maxUs) histogram.maxUs = us;
+  histogram.count++;
+  histogram.sumUs += us;
+  histogram.buckets[bucket]++;
+  portEXIT_CRITICAL(&_metricsMux);
+}
+
+/**
+ * 記錄一筆 WiFi 信號強度
+ */
+void _wirelessMetricRssi(int8_t rssi) {
+  portENTER_CRITICAL(&_metricsMux);
+  if (_metricRssiSamples == 0 || rssi < _metricRssiMin) _metricRssiMin = rssi;
+  if (_metricRssiSamples == 0 || rssi > _metricRssiMax) _metricRssiMax = rssi;
+  _metricRssiSamples++;
+  _metricRssiSum += rssi;
+  _metricRssiLast = rssi;
+  portEXIT_CRITICAL(&_metricsMux);
+}
+
+/**
+ * 取得所有指標的快照
+ * @param metrics 輸出的指標
+ */
+void Wireless_getMetrics(WirelessMetrics &metrics) {
+  metrics.uptimeMs = millis() - _metricsSince;
+  for (int i = 0; i < WIRELESS_METRIC_COUNT; i++) {
+    metrics.counters[i] = _metricCounters[i].load(std::memory_order_relaxed);
+  }
+
+  portENTER_CRITICAL(&_metricsMux);
+  memcpy(metrics.histograms, _metricHistograms, sizeof(_metricHistograms));
+  metrics.rssi.samples = _metricRssiSamples;
+  metrics.rssi.min = _metricRssiMin;
+  metrics.rssi.max = _metricRssiMax;
+  metrics.rssi.last = _metricRssiLast;
+  metrics.rssi.avg = _metricRssiSamples > 0 ? (int8_t)(_metricRssiSum / (int32_t)_metricRssiSamples) : 0;
+  portEXIT_CRITICAL(&_metricsMux);
+}
+
+/**
+ * 將所有計數器、直方圖與 RSSI 取樣歸零
+ */
+void Wireless_resetMetrics() {
+  for (int i = 0; i < WIRELESS_METRIC_COUNT; i++) {
+    _metricCounters[i].store(0, std::memory_order_relaxed);
+  }
+
+  portENTER_CRITICAL(&_metricsMux);
+  memset(_metricHistograms, 0, sizeof(_metricHistograms));
+  _metricRssiSamples = 0;
+  _metricRssiSum = 0;
+  _metricRssiMin = 0;
+  _metricRssiMax = 0;
+  _metricRssiLast = 0;
+  portEXIT_CRITICAL(&_metricsMux);
+
+  _metricsSince = millis();
+}
+
+/**
+ * 取得直方圖區間的上限
+ * @param bucket 區間索引
+ * @return 上限 (微秒)，最後一個區間為 0xFFFFFFFF
+ */
+uint32_t Wireless_histogramBound(uint8_t bucket) {
+  return bucket < WIRELESS_HIST_BUCKETS ? _metricBounds[bucket] : 0xFFFFFFFFUL;
+}
+
+/**
+ * 取得計數器在發布內容中使用的名稱
+ */
+const char* Wireless_metricName(WirelessMetricId id) {
+  return id < WIRELESS_METRIC_COUNT ? _metricNames[id] : "";
+}
+
+/**
+ * 取得直方圖在發布內容中使用的名稱
+ */
+const char* Wireless_histogramName(WirelessHistogramId id) {
+  return id < WIRELESS_HIST_COUNT ? _histogramNames[id] : "";
+}
+
+/**
+ * 附加格式化文字，空間不足時標記為截斷
+ */
+static void _metricsAppend(char* buffer, size_t size, size_t &pos, bool &truncated, const char* format, ...) {
+  if (truncated) return;
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(buffer + pos, size - pos, format, args);
+  va_end(args);
+  if (n < 0 || (size_t)n >= size - pos) {
+    truncated = true;
+    return;
+  }
+  pos += n;
+}
+
+/**
+ * 將指標格式化為精簡的 JSON，省略為零的計數器與沒有樣本的直方圖
+ * 格式: {"up":毫秒,"rssi":[最小,平均,最大,樣本數],"c":{名稱:值},"h":{名稱:[樣本數,平均,最大,區間0..7]}}
+ * 直方圖的平均與最大值單位為微秒
+ * @param buffer 輸出緩衝區
+ * @param size 緩衝區大小
+ * @return 字串長度，緩衝區不足時為 0
+ */
+size_t Wireless_formatMetrics(char* buffer, size_t size) {
+  if (buffer == NULL || size == 0) return 0;
+
+  // 快照放在堆疊上 (約 250 位元組)，服務任務與應用程式同時呼叫時不會互相覆寫
+  WirelessMetrics metrics;
+  Wireless_getMetrics(metrics);
+
+  size_t pos = 0;
+  bool truncated = false;
+  _metricsAppend(buffer, size, pos, truncated, "{\"up\":%lu", (unsigned long)metrics.uptimeMs);
+
+  if (metrics.rssi.samples > 0) {
+    _metricsAppend(buffer, size, pos, truncated, ",\"rssi\":[%d,%d,%d,%lu]",
+                   metrics.rssi.min, metrics.rssi.avg, metrics.rssi.max, (unsigned long)metrics.rssi.samples);
+  }
+
+  _metricsAppend(buffer, size, pos, truncated, ",\"c\":{");
+  bool first = true;
+  for (int i = 0; i < WIRELESS_METRIC_COUNT; i++) {
+    if (metrics.counters[i] == 0) continue;
+    _metricsAppend(buffer, size, pos, truncated, "%s\"%s\":%lu", first ? "" : ",", _metricNames[i], (unsigned long)metrics.counters[i]);
+    first = false;
+  }
+
+  _metricsAppend(buffer, size, pos, truncated, "},\"h\":{");
+  first = true;
+  for (int i = 0; i < WIRELESS_HIST_COUNT; i++) {
+    const WirelessHistogram &histogram = metrics.histograms[i];
+    if (histogram.count == 0) continue;
+    _metricsAppend(buffer, size, pos, truncated, "%s\"%s\":[%lu,%lu,%lu", first ? "" : ",", _histogramNames[i],
+                   (unsigned long)histogram.count, (unsigned long)(histogram.sumUs / histogram.count), (unsigned long)histogram.maxUs);
+    for (int b = 0; b < WIRELESS_HIST_BUCKETS; b++) {
+      _metricsAppend(buffer, size, pos, truncated, ",%lu", (unsigned long)histogram.buckets[b]);
+    }
+    _metricsAppend(buffer, size, pos, truncated, "]");
+    first = false;
+  }
+  _metricsAppend(buffer, size, pos, truncated, "}}");
+
+  if (truncated) {
+    buffer[0] = '\0';
+    return 0;
+  }
+  return pos;
+}
+
+/**
+ * 設定定期發布指標
+ * @param topic 發布的主題，NULL 表示停止發布
+ * @param intervalMs 發布間隔 (毫秒)，0 表示停止發布
+ * @param silentMode 是否安靜模式
+ */
+void Wireless_setMetricsPublish(const char* topic, unsigned long intervalMs, bool silentMode) {
+  if (topic == NULL || intervalMs == 0) {
+    _metricsInterval = 0;
+    _metricsTopic[0] = '\0';
+    if (!silentMode) WM_LOGI("已停止定期發布指標");
+    return;
+  }
+  if (strlen(topic) >= sizeof(_metricsTopic)) {
+    if (!silentMode) WM_LOGE("指標主題過長: %s", topic);
+    return;
+  }
+
+  strcpy(_metricsTopic, topic);
+  _metricsInterval = intervalMs;
+  _metricsNextPublish = millis() + intervalMs;
+
+  if (!silentMode) {
+    WM_LOGI("每 %lu 毫秒發布指標至主題: %s", intervalMs, topic);
+  }
+}
+
+/**
+ * 定期取樣 RSSI，並在到期且 MQTT 已連接時發布指標
+ * 此函式由 Mqtt_loop 呼叫，每次呼叫都會立即返回
+ */
+void Wireless_metricsLoop() {
+  unsigned long now = millis();
+
+  if ((long)(now - _metricsNextSample) >= 0) {
+    _metricsNextSample = now + WIRELESS_METRICS_SAMPLE_MS;
+    if (WiFi.status() == WL_CONNECTED) {
+      _wirelessMetricRssi(WiFi.RSSI());
+    }
+  }
+
+  if (_metricsInterval == 0 || (long)(now - _metricsNextPublish) < 0) return;
+  _metricsNextPublish = now + _metricsInterval;
+  if (!Mqtt_checkStatus(true)) return;
+
+  static char payload[WIRELESS_METRICS_PAYLOAD_LEN];
+  size_t length = Wireless_formatMetrics(payload, sizeof(payload));
+  if (length == 0) {
+    WM_LOGW("指標內容超過 %d 位元組，未發布", WIRELESS_METRICS_PAYLOAD_LEN);
+    return;
+  }
+  Mqtt_publishBinary(_metricsTopic, (const uint8_t*)payload, length, false, true);
+}
\ No newline at end of file
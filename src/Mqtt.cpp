@@ -3,13 +3,715 @@
 #include <WiFi.h>
 #include <PubSubClient.h>
 
+static void _mqttOnPuback(uint16_t packetId);
+
+/**
+ * 包裝 WiFiClient 的連線層，在 PubSubClient 讀取資料時解析封包邊界
+ * PubSubClient 會直接丟棄 PUBACK，因此在此攔截以完成 QoS 1 的確認
+ */
+class MqttTapClient : public Client {
+  public:
+    MqttTapClient(Client& client) : _client(client) { reset(); }
+    
+    int connect(IPAddress ip, uint16_t port) { reset(); return _client.connect(ip, port); }
+    int connect(const char* host, uint16_t port) { reset(); return _client.connect(host, port); }
+    size_t write(uint8_t b) { return _client.write(b); }
+    size_t write(const uint8_t* buf, size_t size) { return _client.write(buf, size); }
+    int available() { return _client.available(); }
+    int peek() { return _client.peek(); }
+    void flush() { _client.flush(); }
+    void stop() { reset(); _client.stop(); }
+    uint8_t connected() { return _client.connected(); }
+    operator bool() { return connected(); }
+    
+    int read() {
+      int b = _client.read();
+      if (b >= 0) {
+        parse((uint8_t)b);
+      }
+      return b;
+    }
+    
+    int read(uint8_t* buf, size_t size) {
+      int n = _client.read(buf, size);
+      for (int i = 0; i < n; i++) {
+        parse(buf[i]);
+      }
+      return n;
+    }
+    
+  private:
+    enum { STATE_HEADER, STATE_LENGTH, STATE_BODY };
+    
+    Client& _client;
+    uint8_t _state;
+    uint8_t _type;
+    uint32_t _remaining;
+    uint32_t _multiplier;
+    uint16_t _packetId;
+    uint32_t _bodyIndex;
+    
+    void reset() {
+      _state = STATE_HEADER;
+    }
+    
+    void packetDone() {
+      if (_type == 0x40 && _bodyIndex == 2) {
+        _mqttOnPuback(_packetId);
+      }
+      _state = STATE_HEADER;
+    }
+    
+    void parse(uint8_t b) {
+      switch (_state) {
+        case STATE_HEADER:
+          _type = b & 0xF0;
+          _remaining = 0;
+          _multiplier = 1;
+          _bodyIndex = 0;
+          _packetId = 0;
+          _state = STATE_LENGTH;
+          break;
+        case STATE_LENGTH:
+          _remaining += (b & 0x7F) * _multiplier;
+          _multiplier *= 128;
+          if ((b & 0x80) == 0) {
+            if (_remaining == 0) {
+              packetDone();
+            } else {
+              _state = STATE_BODY;
+            }
+          }
+          break;
+        case STATE_BODY:
+          if (_bodyIndex < 2) {
+            _packetId = (_packetId << 8) | b;
+          }
+          _bodyIndex++;
+          if (_bodyIndex >= _remaining) {
+            packetDone();
+          }
+          break;
+      }
+    }
+};
+
 // MQTT 客戶端實例
 WiFiClient espClient;
-PubSubClient mqttClient(espClient);
+MqttTapClient mqttTap(espClient);
+PubSubClient mqttClient(mqttTap);
+
+/**
+ * 保護所有 MQTT 狀態 (PubSubClient、傳送中視窗、離線佇列、訂閱與路由表) 的遞迴互斥鎖
+ * 服務任務執行 Mqtt_loop 時，其他任務的 MQTT 呼叫會等待這一輪處理完畢；
+ * 使用遞迴鎖，回調函式與事件監聽函式中仍可呼叫 MQTT 函式
+ */
+static SemaphoreHandle_t _mqttMutex() {
+  // 函式內的靜態變數由編譯器保證只初始化一次，多個任務同時首次呼叫也安全
+  static SemaphoreHandle_t mutex = xSemaphoreCreateRecursiveMutex();
+  return mutex;
+}
+
+class MqttLock {
+  public:
+    MqttLock() { xSemaphoreTakeRecursive(_mqttMutex(), portMAX_DELAY); }
+    ~MqttLock() { xSemaphoreGiveRecursive(_mqttMutex()); }
+};
 
 // MQTT 回調函數指針
 void (*_mqttCallback)(char*, byte*, unsigned int) = NULL;
 
+// 主題路由樹 (預先配置的節點池)，每個節點代表主題的一個層級
+typedef struct {
+  char level[MQTT_ROUTER_LEVEL_LEN];
+  int16_t firstChild;
+  int16_t nextSibling;
+  int16_t firstHandler;
+} MqttRouteNode;
+
+typedef struct {
+  MqttTopicHandler handler;
+  void* ctx;
+  int16_t next;
+} MqttRouteHandler;
+
+static MqttRouteNode _mqttRouteNodes[MQTT_ROUTER_MAX_NODES];
+static int16_t _mqttRouteNodeCount = 0;
+static int16_t _mqttRouteFreeNode = -1;   // 已移除節點的串列，經由 nextSibling 連結
+static MqttRouteHandler _mqttRouteHandlers[MQTT_ROUTER_MAX_HANDLERS];
+static int16_t _mqttRouteFreeHandler = -1;
+static int16_t _mqttRouteHandlerCount = 0;
+
+// 已訂閱的主題，重新連線後自動恢復
+typedef struct {
+  char filter[MQTT_FILTER_LEN];
+  uint8_t qos;
+  bool used;
+} MqttSubscription;
+
+static MqttSubscription _mqttSubscriptions[MQTT_MAX_SUBSCRIPTIONS];
+
+/**
+ * 在父節點下尋找指定層級的子節點，不存在時可選擇建立
+ * @return 節點索引，找不到或節點池已滿時返回-1
+ */
+static int16_t _mqttRouteChild(int16_t parent, const char* level, size_t length, bool create) {
+  for (int16_t i = _mqttRouteNodes[parent].firstChild; i >= 0; i = _mqttRouteNodes[i].nextSibling) {
+    if (strlen(_mqttRouteNodes[i].level) == length && strncmp(_mqttRouteNodes[i].level, level, length) == 0) {
+      return i;
+    }
+  }
+  if (!create || length >= MQTT_ROUTER_LEVEL_LEN) {
+    return -1;
+  }
+  
+  int16_t node = _mqttRouteFreeNode;
+  if (node >= 0) {
+    _mqttRouteFreeNode = _mqttRouteNodes[node].nextSibling;
+  } else if (_mqttRouteNodeCount < MQTT_ROUTER_MAX_NODES) {
+    node = _mqttRouteNodeCount++;
+  } else {
+    return -1;
+  }
+  memcpy(_mqttRouteNodes[node].level, level, length);
+  _mqttRouteNodes[node].level[length] = '\0';
+  _mqttRouteNodes[node].firstChild = -1;
+  _mqttRouteNodes[node].firstHandler = -1;
+  _mqttRouteNodes[node].nextSibling = _mqttRouteNodes[parent].firstChild;
+  _mqttRouteNodes[parent].firstChild = node;
+  return node;
+}
+
+/**
+ * 依主題過濾器走訪路由樹，可選擇建立缺少的節點
+ * @return 過濾器對應的節點，格式無效或節點池已滿時返回-1
+ */
+static int16_t _mqttRouteFind(const char* filter, bool create) {
+  if (_mqttRouteNodeCount == 0) {
+    // 節點0為根節點
+    _mqttRouteNodes[0].level[0] = '\0';
+    _mqttRouteNodes[0].firstChild = -1;
+    _mqttRouteNodes[0].nextSibling = -1;
+    _mqttRouteNodes[0].firstHandler = -1;
+    _mqttRouteNodeCount = 1;
+  }
+  
+  int16_t node = 0;
+  const char* level = filter;
+  while (true) {
+    const char* end = strchr(level, '/');
+    size_t length = end ? (size_t)(end - level) : strlen(level);
+    
+    // 萬用字元必須獨佔一個層級，且 '#' 只能在最後一層
+    if (memchr(level, '+', length) != NULL && length != 1) return -1;
+    if (memchr(level, '#', length) != NULL && (length != 1 || end != NULL)) return -1;
+    
+    node = _mqttRouteChild(node, level, length, create);
+    if (node < 0 || end == NULL) {
+      return node;
+    }
+    level = end + 1;
+  }
+}
+
+/**
+ * 沿著過濾器的路徑，將沒有處理函式也沒有子節點的節點移出路由樹並放回節點池
+ * @param parent 由此節點的子節點開始比對
+ * @param level 過濾器的剩餘層級
+ */
+static void _mqttRoutePrune(int16_t parent, const char* level) {
+  const char* end = strchr(level, '/');
+  size_t length = end ? (size_t)(end - level) : strlen(level);
+  
+  int16_t* link = &_mqttRouteNodes[parent].firstChild;
+  while (*link >= 0) {
+    int16_t node = *link;
+    if (strlen(_mqttRouteNodes[node].level) == length && strncmp(_mqttRouteNodes[node].level, level, length) == 0) {
+      if (end != NULL) {
+        _mqttRoutePrune(node, end + 1);
+      }
+      if (_mqttRouteNodes[node].firstChild < 0 && _mqttRouteNodes[node].firstHandler < 0) {
+        *link = _mqttRouteNodes[node].nextSibling;
+        _mqttRouteNodes[node].nextSibling = _mqttRouteFreeNode;
+        _mqttRouteFreeNode = node;
+      }
+      return;
+    }
+    link = &_mqttRouteNodes[node].nextSibling;
+  }
+}
+
+/**
+ * 呼叫節點上所有的處理函式
+ */
+static void _mqttRouteFire(int16_t node, const char* topic, const uint8_t* payload, unsigned int length) {
+  for (int16_t h = _mqttRouteNodes[node].firstHandler; h >= 0; h = _mqttRouteHandlers[h].next) {
+    _mqttRouteHandlers[h].handler(topic, payload, length, _mqttRouteHandlers[h].ctx);
+  }
+}
+
+/**
+ * 由指定節點的子節點開始比對主題的剩餘層級
+ * 比對成本只與主題層級數及各層的分支數有關，與訂閱總數無關
+ */
+static void _mqttRouteMatch(int16_t parent, const char* level, bool firstLevel,
+                            const char* topic, const uint8_t* payload, unsigned int length) {
+  const char* end = strchr(level, '/');
+  size_t levelLength = end ? (size_t)(end - level) : strlen(level);
+  // 以 '$' 開頭的系統主題不會被第一層的萬用字元匹配
+  bool systemTopic = firstLevel && topic[0] == '$';
+  
+  for (int16_t i = _mqttRouteNodes[parent].firstChild; i >= 0; i = _mqttRouteNodes[i].nextSibling) {
+    const char* name = _mqttRouteNodes[i].level;
+    
+    if (name[0] == '#' && name[1] == '\0') {
+      if (!systemTopic) {
+        _mqttRouteFire(i, topic, payload, length);
+      }
+      continue;
+    }
+    
+    bool matched;
+    if (name[0] == '+' && name[1] == '\0') {
+      matched = !systemTopic;
+    } else {
+      matched = strlen(name) == levelLength && strncmp(name, level, levelLength) == 0;
+    }
+    if (!matched) {
+      continue;
+    }
+    
+    if (end != NULL) {
+      _mqttRouteMatch(i, end + 1, false, topic, payload, length);
+      continue;
+    }
+    
+    // 主題已結束，"a/#" 也匹配 "a"
+    _mqttRouteFire(i, topic, payload, length);
+    for (int16_t c = _mqttRouteNodes[i].firstChild; c >= 0; c = _mqttRouteNodes[c].nextSibling) {
+      if (_mqttRouteNodes[c].level[0] == '#' && _mqttRouteNodes[c].level[1] == '\0') {
+        _mqttRouteFire(c, topic, payload, length);
+      }
+    }
+  }
+}
+
+/**
+ * 舊版全域回調函數的事件轉接
+ */
+static void _mqttLegacyAdapter(const WirelessEvent &event, void* ctx) {
+  if (event.source == WIRELESS_SOURCE_MQTT && _mqttCallback != NULL) {
+    _mqttCallback((char*)event.topic, (byte*)event.data, event.length);
+  }
+}
+
+/**
+ * 將訊息交給路由樹，再以 MESSAGE 事件通知監聽函式 (包含舊版全域回調函數)
+ * 服務任務執行中時由 Wireless_dispatch 在應用程式的任務中呼叫
+ */
+void _mqttDeliver(const char* topic, const uint8_t* payload, unsigned int length) {
+  MqttLock lock;
+  if (_mqttRouteNodeCount > 0) {
+    _mqttRouteMatch(0, topic, true, topic, payload, length);
+  }
+
+  WirelessEvent event = {};
+  event.type = WIRELESS_EVENT_MESSAGE;
+  event.source = WIRELESS_SOURCE_MQTT;
+  event.topic = topic;
+  event.data = payload;
+  event.length = length;
+  Wireless_emit(event);
+}
+
+// 上次通知的連線狀態，用來產生 LINK_UP/LINK_DOWN 事件
+static bool _mqttLinkUp = false;
+static unsigned long _mqttLinkUpAt = 0;
+
+// Mqtt_getInfo 使用的伺服器設定與最近一次連線失敗的狀態碼
+static const char* _mqttServer = NULL;
+static uint16_t _mqttPort = 0;
+static int8_t _mqttLastError = 0;
+
+/**
+ * 連線狀態改變時發出事件
+ */
+static void _mqttSetLink(bool up) {
+  if (up == _mqttLinkUp) return;
+  _mqttLinkUp = up;
+  if (up) _mqttLinkUpAt = millis();
+
+  WirelessEvent event = {};
+  event.type = up ? WIRELESS_EVENT_LINK_UP : WIRELESS_EVENT_LINK_DOWN;
+  event.source = WIRELESS_SOURCE_MQTT;
+  Wireless_emit(event);
+}
+
+/**
+ * PubSubClient 收到訊息時的統一入口
+ * 服務任務執行中時先放入接收佇列，不在服務任務中執行使用者的回調函數
+ */
+static void _mqttDispatch(char* topic, byte* payload, unsigned int length) {
+  _wirelessMetricAdd(WIRELESS_METRIC_MQTT_RX_BYTES, length);
+  if (_wirelessServiceDefer()) {
+    _wirelessServicePostInbound(WIRELESS_INBOUND_MQTT, 0, topic, payload, length);
+    return;
+  }
+  _mqttDeliver(topic, payload, length);
+}
+
+/**
+ * 記錄訂閱，供重新連線後恢復
+ */
+static void _mqttTrackSubscription(const char* filter, uint8_t qos) {
+  int16_t freeSlot = -1;
+  for (int16_t i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++) {
+    if (_mqttSubscriptions[i].used) {
+      if (strcmp(_mqttSubscriptions[i].filter, filter) == 0) {
+        _mqttSubscriptions[i].qos = qos;
+        return;
+      }
+    } else if (freeSlot < 0) {
+      freeSlot = i;
+    }
+  }
+  if (freeSlot >= 0 && strlen(filter) < MQTT_FILTER_LEN) {
+    strcpy(_mqttSubscriptions[freeSlot].filter, filter);
+    _mqttSubscriptions[freeSlot].qos = qos;
+    _mqttSubscriptions[freeSlot].used = true;
+  }
+}
+
+static void _mqttUntrackSubscription(const char* filter) {
+  for (int16_t i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++) {
+    if (_mqttSubscriptions[i].used && strcmp(_mqttSubscriptions[i].filter, filter) == 0) {
+      _mqttSubscriptions[i].used = false;
+    }
+  }
+}
+
+/**
+ * 重新送出所有記錄的訂閱
+ */
+static void _mqttRestoreSubscriptions() {
+  for (int16_t i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++) {
+    if (_mqttSubscriptions[i].used) {
+      mqttClient.subscribe(_mqttSubscriptions[i].filter, _mqttSubscriptions[i].qos);
+    }
+  }
+}
+
+// 連線參數，供自動重新連線使用
+static char _mqttClientId[64] = {0};
+static char _mqttUsername[64] = {0};
+static char _mqttPassword[96] = {0};
+static char _mqttWillTopic[MQTT_FILTER_LEN] = {0};
+static char _mqttWillMessage[128] = {0};
+static bool _mqttHasUsername = false;
+static bool _mqttHasWill = false;
+static bool _mqttWillRetain = false;
+static bool _mqttCleanSession = true;
+
+// 自動重新連線 (指數退避加隨機抖動)
+static bool _mqttAutoReconnect = false;
+static bool _mqttSessionActive = false;     // Mqtt_connect 之後、Mqtt_disconnect 之前
+static bool _mqttReconnectPending = false;  // 已偵測到斷線，等待重新連線
+static unsigned long _mqttMinBackoffMs = 1000;
+static unsigned long _mqttMaxBackoffMs = 60000;
+static unsigned long _mqttBackoffMs = 1000;
+static unsigned long _mqttNextAttempt = 0;
+static uint32_t _mqttReconnectAttempts = 0;
+static uint32_t _mqttReconnects = 0;
+
+// QoS 1 發布的傳送中視窗
+typedef struct {
+  bool used;
+  bool sent;          // 目前連線中是否已完整送出
+  bool due;           // 不等待逾時、下次服務時立即送出 (新訊息或重新連線後)
+  bool dup;           // 是否曾經送出過 (重送時設定 DUP 旗標)
+  uint16_t packetId;
+  char topic[MQTT_QUEUE_TOPIC_LEN];
+  uint8_t payload[MQTT_INFLIGHT_PAYLOAD_LEN];
+  uint16_t length;
+  bool retain;
+  uint8_t retries;
+  unsigned long sentAt;   // 最近一次嘗試送出的時間
+  MqttPublishDoneCallback callback;
+  void* ctx;
+} MqttInflightMessage;
+
+static MqttInflightMessage _mqttInflight[MQTT_INFLIGHT_SIZE];
+static uint16_t _mqttInflightDepth = 0;
+static uint16_t _mqttNextPacketId = 1;
+static unsigned long _mqttRetryTimeoutMs = 5000;
+static uint8_t _mqttMaxRetries = 5;
+static uint32_t _mqttQos1Acked = 0;
+static uint32_t _mqttQos1Retransmits = 0;
+static uint32_t _mqttQos1Failed = 0;
+
+/**
+ * 配置傳送中視窗未使用的封包識別碼 (0 為無效值)
+ */
+static uint16_t _mqttAllocPacketId() {
+  while (true) {
+    uint16_t id = _mqttNextPacketId;
+    _mqttNextPacketId = (_mqttNextPacketId == 0xFFFF) ? 1 : _mqttNextPacketId + 1;
+    
+    bool inUse = false;
+    for (int i = 0; i < MQTT_INFLIGHT_SIZE; i++) {
+      if (_mqttInflight[i].used && _mqttInflight[i].packetId == id) {
+        inUse = true;
+        break;
+      }
+    }
+    if (!inUse) {
+      return id;
+    }
+  }
+}
+
+/**
+ * 直接寫出 QoS 1 的 PUBLISH 封包
+ * 只寫出部分封包時連線的位元組流已無法復原，直接關閉連線，
+ * 由重新連線流程以 DUP 旗標重送
+ * @return 是否完整寫出
+ */
+static bool _mqttQos1Send(MqttInflightMessage& msg) {
+  uint8_t header[5 + 2 + MQTT_QUEUE_TOPIC_LEN + 2];
+  size_t topicLength = strlen(msg.topic);
+  size_t remaining = 2 + topicLength + 2 + msg.length;
+  size_t pos = 0;
+  
+  // 固定標頭: PUBLISH | QoS 1 | DUP | RETAIN，接著為剩餘長度
+  header[pos++] = 0x30 | 0x02 | (msg.dup ? 0x08 : 0) | (msg.retain ? 0x01 : 0);
+  do {
+    uint8_t digit = remaining % 128;
+    remaining /= 128;
+    if (remaining > 0) {
+      digit |= 0x80;
+    }
+    header[pos++] = digit;
+  } while (remaining > 0);
+  
+  header[pos++] = topicLength >> 8;
+  header[pos++] = topicLength & 0xFF;
+  memcpy(header + pos, msg.topic, topicLength);
+  pos += topicLength;
+  header[pos++] = msg.packetId >> 8;
+  header[pos++] = msg.packetId & 0xFF;
+  
+  size_t total = pos + msg.length;
+  size_t written = mqttClient.write(header, pos);
+  if (written == pos) {
+    written += mqttClient.write(msg.payload, msg.length);
+  }
+  
+  msg.sent = written == total;
+  msg.due = false;
+  msg.sentAt = millis();
+  if (written > 0) {
+    msg.dup = true;
+  }
+  if (written > 0 && written < total) {
+    // 不可送出 DISCONNECT，伺服器會將其視為未完成封包的內容
+    mqttTap.stop();
+  }
+  return msg.sent;
+}
+
+/**
+ * 結束傳送中的訊息並呼叫完成回調
+ */
+static void _mqttQos1Complete(MqttInflightMessage& msg, bool success) {
+  msg.used = false;
+  _mqttInflightDepth--;
+  if (success) {
+    _mqttQos1Acked++;
+  } else {
+    _mqttQos1Failed++;
+  }
+  if (msg.callback != NULL) {
+    msg.callback(msg.packetId, success, msg.ctx);
+  }
+
+  WirelessEvent event = {};
+  event.type = WIRELESS_EVENT_PUBLISH_DONE;
+  event.source = WIRELESS_SOURCE_MQTT;
+  event.id = msg.packetId;
+  event.success = success;
+  event.topic = msg.topic;
+  Wireless_emit(event);
+}
+
+/**
+ * 收到 PUBACK 時由連線層呼叫
+ */
+static void _mqttOnPuback(uint16_t packetId) {
+  for (int i = 0; i < MQTT_INFLIGHT_SIZE; i++) {
+    if (_mqttInflight[i].used && _mqttInflight[i].packetId == packetId) {
+      _mqttQos1Complete(_mqttInflight[i], true);
+      return;
+    }
+  }
+}
+
+/**
+ * 送出新的訊息，並重送逾時未確認或上次未能寫出的訊息
+ * 寫出失敗與未確認的訊息使用相同的逾時與重試次數，避免連線壅塞時反覆寫入
+ */
+static void _mqttServiceInflight() {
+  unsigned long now = millis();
+  for (int i = 0; i < MQTT_INFLIGHT_SIZE; i++) {
+    MqttInflightMessage& msg = _mqttInflight[i];
+    if (!msg.used) {
+      continue;
+    }
+    if (!msg.due) {
+      if (now - msg.sentAt < _mqttRetryTimeoutMs) {
+        continue;
+      }
+      if (msg.retries >= _mqttMaxRetries) {
+        _mqttQos1Complete(msg, false);
+        continue;
+      }
+      msg.retries++;
+      _mqttQos1Retransmits++;
+    }
+    _mqttQos1Send(msg);
+    // 只寫出部分封包時連線已關閉，其餘訊息留待重新連線後送出
+    if (!mqttClient.connected()) {
+      break;
+    }
+  }
+}
+
+/**
+ * 重新連線後，所有未確認的訊息都需重送
+ */
+static void _mqttResetInflight() {
+  for (int i = 0; i < MQTT_INFLIGHT_SIZE; i++) {
+    _mqttInflight[i].sent = false;
+    _mqttInflight[i].due = true;
+  }
+}
+
+// 串流發布時尚未寫入的位元組數
+static size_t _mqttStreamRemaining = 0;
+static bool _mqttStreaming = false;
+
+/**
+ * 送出一則訊息，超過 PubSubClient 緩衝區大小時改用串流方式直接寫入，不額外複製
+ * @return 是否成功送出
+ */
+static bool _mqttWrite(const char* topic, const uint8_t* payload, size_t length, bool retain) {
+  // 固定標頭(最多5位元組) + 主題長度欄位(2位元組) + 主題 + 內容
+  size_t packetSize = 5 + 2 + strlen(topic) + length;
+  if (packetSize <= mqttClient.getBufferSize()) {
+    return mqttClient.publish(topic, payload, length, retain);
+  }
+  
+  if (!mqttClient.beginPublish(topic, length, retain)) {
+    return false;
+  }
+  if (mqttClient.write(payload, length) != length) {
+    mqttClient.endPublish();
+    return false;
+  }
+  return mqttClient.endPublish() == 1;
+}
+
+/**
+ * 送出一則 QoS 0 訊息並記錄發布延遲與位元組數
+ */
+static bool _mqttSend(const char* topic, const uint8_t* payload, size_t length, bool retain) {
+  unsigned long start = micros();
+  bool success = _mqttWrite(topic, payload, length, retain);
+  if (success) {
+    _wirelessMetricLatency(WIRELESS_HIST_MQTT_PUBLISH, micros() - start);
+    _wirelessMetricAdd(WIRELESS_METRIC_MQTT_PUBLISHES);
+    _wirelessMetricAdd(WIRELESS_METRIC_MQTT_TX_BYTES, length);
+  } else {
+    _wirelessMetricAdd(WIRELESS_METRIC_MQTT_PUBLISH_FAILURES);
+  }
+  return success;
+}
+
+// 離線發布佇列 (預先配置的環形緩衝區)
+typedef struct {
+  char topic[MQTT_QUEUE_TOPIC_LEN];
+  uint8_t payload[MQTT_QUEUE_PAYLOAD_LEN];
+  uint16_t length;
+  bool retain;
+} MqttQueuedMessage;
+
+static MqttQueuedMessage _mqttQueue[MQTT_QUEUE_SIZE];
+static uint16_t _mqttQueueHead = 0;   // 最舊訊息的位置
+static uint16_t _mqttQueueDepth = 0;
+static bool _mqttQueueEnabled = false;
+static MqttQueuePolicy _mqttQueuePolicy = MQTT_QUEUE_DROP_OLDEST;
+static uint16_t _mqttFlushBatch = 8;
+static uint16_t _mqttFlushBudgetMs = 20;
+static uint32_t _mqttQueueEnqueued = 0;
+static uint32_t _mqttQueueDropped = 0;
+static uint32_t _mqttQueueFlushed = 0;
+static uint32_t _mqttQueueBypassed = 0;
+
+/**
+ * 將訊息放入離線佇列，佇列已滿時依溢出策略捨棄訊息
+ * @return 訊息是否已放入佇列
+ */
+static bool _mqttEnqueue(const char* topic, const uint8_t* payload, size_t length, bool retain) {
+  if (strlen(topic) >= MQTT_QUEUE_TOPIC_LEN || length > MQTT_QUEUE_PAYLOAD_LEN) {
+    _mqttQueueDropped++;
+    _wirelessMetricAdd(WIRELESS_METRIC_MQTT_QUEUE_DROPS);
+    return false;
+  }
+  
+  if (_mqttQueueDepth >= MQTT_QUEUE_SIZE) {
+    _mqttQueueDropped++;
+    _wirelessMetricAdd(WIRELESS_METRIC_MQTT_QUEUE_DROPS);
+    if (_mqttQueuePolicy == MQTT_QUEUE_DROP_NEWEST) {
+      return false;
+    }
+    // 捨棄最舊的訊息以騰出空間
+    _mqttQueueHead = (_mqttQueueHead + 1) % MQTT_QUEUE_SIZE;
+    _mqttQueueDepth--;
+  }
+  
+  MqttQueuedMessage& slot = _mqttQueue[(_mqttQueueHead + _mqttQueueDepth) % MQTT_QUEUE_SIZE];
+  strcpy(slot.topic, topic);
+  memcpy(slot.payload, payload, length);
+  slot.length = length;
+  slot.retain = retain;
+  _mqttQueueDepth++;
+  _mqttQueueEnqueued++;
+  return true;
+}
+
+/**
+ * 連線恢復後分批送出佇列中的訊息，受訊息數量與時間預算限制
+ * @param drain 是否忽略限制，送出所有訊息 (直到發送失敗)
+ */
+static void _mqttFlushQueue(bool drain = false) {
+  unsigned long start = millis();
+  uint16_t sent = 0;
+  
+  while (_mqttQueueDepth > 0 && (drain || sent < _mqttFlushBatch)) {
+    const MqttQueuedMessage& slot = _mqttQueue[_mqttQueueHead];
+    if (!_mqttSend(slot.topic, slot.payload, slot.length, slot.retain)) {
+      break;  // 保留訊息，下次再送
+    }
+    _mqttQueueHead = (_mqttQueueHead + 1) % MQTT_QUEUE_SIZE;
+    _mqttQueueDepth--;
+    _mqttQueueFlushed++;
+    sent++;
+    
+    if (!drain && millis() - start >= _mqttFlushBudgetMs) {
+      break;
+    }
+  }
+}
+
 /**
  * 設定MQTT連接參數
  * @param server MQTT伺服器地址
@@ -18,27 +720,28 @@ void (*_mqttCallback)(char*, byte*, unsigned int) = NULL;
  * @param password MQTT密碼，可為NULL
  */
 void Mqtt_setup(const char* server, int port, bool silentMode) {
+  MqttLock lock;
   mqttClient.setServer(server, port);
+  _mqttServer = server;
+  _mqttPort = port;
   
-  const char* separatorLine = "--------------------------------";
   if (!silentMode) {
-    Serial.println(separatorLine);
-    Serial.println("MQTT 設定:");
-    Serial.print("- 伺服器: ");
-    Serial.println(server);
-    Serial.print("- 埠: ");
-    Serial.println(port);
+    WM_LOGI(WM_SEPARATOR);
+    WM_LOGI("MQTT 設定:");
+    WM_LOGI("- 伺服器: %s", server);
+    WM_LOGI("- 埠: %d", port);
   }
   
+  // 所有訊息都經由路由樹分派
+  mqttClient.setCallback(_mqttDispatch);
   if (_mqttCallback != NULL) {
-    mqttClient.setCallback(_mqttCallback);
     if (!silentMode) {
-      Serial.println("- 回調函數已設定");
+      WM_LOGI("- 回調函數已設定");
     }
   }
 
   if (!silentMode) {
-    Serial.println(separatorLine);
+    WM_LOGI(WM_SEPARATOR);
   }
 }
 
@@ -47,15 +750,129 @@ void Mqtt_setup(const char* server, int port, bool silentMode) {
  * @param callback 回調函數指針(void)(char*, byte*, unsigned int)
  */
 void Mqtt_setCallback(void (*callback)(char*, byte*, unsigned int), bool silentMode) {
+  MqttLock lock;
   _mqttCallback = callback;
-  mqttClient.setCallback(callback);
+  mqttClient.setCallback(_mqttDispatch);
+
+  // 舊版回調函數經由事件匯流排轉接
+  if (callback != NULL) {
+    Wireless_on(WIRELESS_EVENT_MASK(WIRELESS_EVENT_MESSAGE), _mqttLegacyAdapter);
+  } else {
+    Wireless_off(_mqttLegacyAdapter);
+  }
+  if (!silentMode) {
+    WM_LOGI("MQTT回調函數已設定");
+  }
+}
+
+/**
+ * 複製字串到固定緩衝區
+ * @return 字串是否完整放入 (NULL視為空字串)
+ */
+static bool _mqttCopyParam(char* dest, size_t size, const char* src) {
+  if (src == NULL) {
+    dest[0] = '\0';
+    return true;
+  }
+  if (strlen(src) >= size) {
+    return false;
+  }
+  strcpy(dest, src);
+  return true;
+}
+
+/**
+ * 以儲存的參數連接到MQTT伺服器，成功後恢復所有訂閱
+ * @return 是否成功連接
+ */
+static bool _mqttConnectStored(bool silentMode) {
+  const char* username = _mqttHasUsername ? _mqttUsername : NULL;
+  const char* password = _mqttHasUsername ? _mqttPassword : NULL;
+  bool success = false;
+  unsigned long start = millis();
+  
+  if (_mqttHasWill) {
+    success = mqttClient.connect(_mqttClientId, username, password, _mqttWillTopic, 0, _mqttWillRetain, _mqttWillMessage, _mqttCleanSession);
+  } else {
+    success = mqttClient.connect(_mqttClientId, username, password);
+  }
+  
+  if (success) {
+    _wirelessMetricAdd(WIRELESS_METRIC_MQTT_CONNECTS);
+    _wirelessMetricLatency(WIRELESS_HIST_MQTT_CONNECT, (millis() - start) * 1000UL);
+    _mqttRestoreSubscriptions();
+    _mqttResetInflight();
+    _mqttSetLink(true);
+  } else {
+    _mqttLastError = mqttClient.state();
+    _wirelessMetricAdd(WIRELESS_METRIC_MQTT_CONNECT_FAILURES);
+  }
+  
   if (!silentMode) {
-    Serial.println("MQTT回調函數已設定");
+    WM_LOGI(WM_SEPARATOR);
+    if (success) {
+      WM_LOGI("連接到MQTT伺服器... 成功!");
+      WM_LOGI("- 客戶端ID: %s", _mqttClientId);
+      if (username != NULL) {
+        WM_LOGI("- 使用者: %s", username);
+      }
+    } else {
+      WM_LOGW("連接到MQTT伺服器... 失敗! 錯誤碼: %d", mqttClient.state());
+      WM_LOGW("嘗試重新連接...");
+    }
+    WM_LOGI(WM_SEPARATOR);
   }
+
+  return success;
+}
+
+/**
+ * 等待時間加上隨機抖動 (介於退避時間的一半到全部之間)，避免大量設備同時重新連線
+ */
+static unsigned long _mqttJitter(unsigned long backoffMs) {
+  unsigned long half = backoffMs / 2;
+  return half + esp_random() % (half + 1);
+}
+
+/**
+ * 斷線後依退避時間進行重新連線，每次呼叫最多只嘗試一次連線
+ */
+static void _mqttManageReconnect() {
+  unsigned long now = millis();
+  
+  // 剛偵測到斷線，第一次嘗試也加上抖動，分散伺服器恢復後的連線尖峰
+  if (!_mqttReconnectPending) {
+    _mqttReconnectPending = true;
+    _mqttBackoffMs = _mqttMinBackoffMs;
+    _mqttNextAttempt = now + _mqttJitter(_mqttBackoffMs);
+    return;
+  }
+  
+  if ((long)(now - _mqttNextAttempt) < 0) {
+    return;
+  }
+  
+  // WiFi 尚未恢復時不計入退避
+  if (WiFi.status() != WL_CONNECTED) {
+    _mqttNextAttempt = now + _mqttMinBackoffMs;
+    return;
+  }
+  
+  _mqttReconnectAttempts++;
+  if (_mqttConnectStored(true)) {
+    _mqttReconnectPending = false;
+    _mqttReconnects++;
+    _wirelessMetricAdd(WIRELESS_METRIC_MQTT_RECONNECTS);
+    return;
+  }
+  
+  _mqttBackoffMs = (_mqttBackoffMs * 2 < _mqttMaxBackoffMs) ? _mqttBackoffMs * 2 : _mqttMaxBackoffMs;
+  _mqttNextAttempt = millis() + _mqttJitter(_mqttBackoffMs);
 }
 
 /**
  * 連接到MQTT伺服器
+ * 連線參數(包含遺囑設定)會被保存，啟用自動重新連線時由 Mqtt_loop 使用
  * @param clientId MQTT客戶端ID
  * @param username MQTT使用者名稱，可為NULL
  * @param password MQTT密碼，可為NULL
@@ -67,79 +884,346 @@ void Mqtt_setCallback(void (*callback)(char*, byte*, unsigned int), bool silentM
  */
 bool Mqtt_connect(const char* clientId, const char* username, const char* password, 
                  const char* willTopic, const char* willMessage, bool willRetain, bool cleanSession, bool silentMode) {
-  if (!silentMode) {
-    Serial.println("--------------------------------");
-    Serial.print("連接到MQTT伺服器... ");
+  MqttLock lock;
+  if (!_mqttCopyParam(_mqttClientId, sizeof(_mqttClientId), clientId) ||
+      !_mqttCopyParam(_mqttUsername, sizeof(_mqttUsername), username) ||
+      !_mqttCopyParam(_mqttPassword, sizeof(_mqttPassword), password) ||
+      !_mqttCopyParam(_mqttWillTopic, sizeof(_mqttWillTopic), willTopic) ||
+      !_mqttCopyParam(_mqttWillMessage, sizeof(_mqttWillMessage), willMessage)) {
+    if (!silentMode) {
+      WM_LOGE("MQTT連線參數過長!");
+    }
+    return false;
   }
+  _mqttHasUsername = (username != NULL);
+  _mqttHasWill = (willTopic != NULL && willMessage != NULL);
+  _mqttWillRetain = willRetain;
+  _mqttCleanSession = cleanSession;
+  _mqttSessionActive = true;
+  _mqttReconnectPending = false;
   
-  bool success = false;
+  return _mqttConnectStored(silentMode);
+}
+
+/**
+ * 設定自動重新連線 (受管理的會話)
+ * 啟用後，Mqtt_connect 之後若連線中斷，Mqtt_loop 會以指數退避加隨機抖動自動重新連線，
+ * 並恢復訂閱與遺囑設定；每次 Mqtt_loop 最多只進行一次連線嘗試
+ * @param enable 是否啟用
+ * @param minBackoffMs 最短退避時間(毫秒)
+ * @param maxBackoffMs 最長退避時間(毫秒)
+ */
+void Mqtt_setAutoReconnect(bool enable, unsigned long minBackoffMs, unsigned long maxBackoffMs) {
+  MqttLock lock;
+  _mqttAutoReconnect = enable;
+  _mqttMinBackoffMs = minBackoffMs > 0 ? minBackoffMs : 1;
+  _mqttMaxBackoffMs = maxBackoffMs > _mqttMinBackoffMs ? maxBackoffMs : _mqttMinBackoffMs;
+  _mqttReconnectPending = false;
+}
+
+/**
+ * 取得自動重新連線的統計資訊
+ * @param stats 輸出的統計資訊
+ */
+void Mqtt_getSessionStats(MqttSessionStats &stats) {
+  MqttLock lock;
+  stats.reconnectAttempts = _mqttReconnectAttempts;
+  stats.reconnects = _mqttReconnects;
+  stats.backoffMs = _mqttReconnectPending ? _mqttBackoffMs : 0;
+}
+
+/**
+ * 發布MQTT訊息
+ * @param topic 主題
+ * @param payload 訊息內容
+ * @param retain 是否保留訊息
+ * @return 是否成功發布
+ */
+bool Mqtt_publish(const char* topic, const char* payload, bool retain, bool silentMode) {
+  return Mqtt_publishBinary(topic, (const uint8_t*)payload, strlen(payload), retain, silentMode);
+}
+
+/**
+ * 在目前的任務中發布訊息 (不轉交服務任務)，離線或佇列中仍有較早的訊息時放入離線佇列
+ * 服務任務與直接發送轉交不了的大訊息時使用
+ * @return 是否成功發布或放入離線佇列
+ */
+bool _mqttPublishDirect(const char* topic, const uint8_t* payload, size_t length, bool retain, bool silentMode) {
+  MqttLock lock;
+  bool fitsQueue = strlen(topic) < MQTT_QUEUE_TOPIC_LEN && length <= MQTT_QUEUE_PAYLOAD_LEN;
+  if (_mqttQueueEnabled && _mqttQueueDepth > 0 && !fitsQueue && mqttClient.connected()) {
+    // 已連線時不可因佇列格子過小而捨棄訊息: 先送完較早的訊息再直接發送，
+    // 送不完時 (例如發送失敗) 仍直接發送並計入 bypassed
+    _mqttFlushQueue(true);
+    if (_mqttQueueDepth > 0) {
+      _mqttQueueBypassed++;
+    }
+  } else if (_mqttQueueEnabled && (!mqttClient.connected() || _mqttQueueDepth > 0)) {
+    // 離線時或佇列中仍有較早的訊息時放入佇列，維持發布順序
+    bool queued = _mqttEnqueue(topic, payload, length, retain);
+    if (!silentMode) {
+      if (queued) {
+        WM_LOGD("訊息已放入離線佇列: %s", topic);
+      } else {
+        WM_LOGW("離線佇列已捨棄訊息: %s", topic);
+      }
+    }
+    return queued;
+  }
   
-  if (willTopic != NULL && willMessage != NULL) {
-    success = mqttClient.connect(clientId, username, password, willTopic, 0, willRetain, willMessage, cleanSession);
-  } else {
-    success = mqttClient.connect(clientId, username, password);
+  if (!mqttClient.connected()) {
+    if (!silentMode) {
+      WM_LOGW("MQTT未連接，無法發布訊息");
+    }
+    return false;
   }
   
+  bool success = _mqttSend(topic, payload, length, retain);
+  
   if (!silentMode) {
     if (success) {
-      Serial.println("成功!");
-      Serial.print("- 客戶端ID: ");
-      Serial.println(clientId);
-      if (username != NULL) {
-        Serial.print("- 使用者: ");
-        Serial.println(username);
-      }
+      WM_LOGD("訊息已發布至主題: %s", topic);
     } else {
-      Serial.print("失敗! 錯誤碼: ");
-      Serial.println(mqttClient.state());
-      Serial.println("嘗試重新連接...");
+      WM_LOGW("發布訊息失敗! 主題: %s", topic);
     }
-    Serial.println("--------------------------------");
   }
 
   return success;
 }
 
 /**
- * 發布MQTT訊息
+ * 送出其他任務轉交給服務任務的發布請求
+ * 持有 MQTT 鎖直到佇列清空，之後直接發送的訊息不會排到較早的請求前面
+ */
+void _mqttFlushForwarded() {
+  MqttLock lock;
+  _wirelessServiceDrainPublish();
+}
+
+/**
+ * 發布二進位MQTT訊息，內容直接由呼叫者的緩衝區送出
+ * 超過 PubSubClient 緩衝區大小的訊息會以串流方式發送，不受緩衝區限制
  * @param topic 主題
  * @param payload 訊息內容
+ * @param length 內容長度
  * @param retain 是否保留訊息
  * @return 是否成功發布
  */
-bool Mqtt_publish(const char* topic, const char* payload, bool retain, bool silentMode) {
-  if (!mqttClient.connected()) {
+bool Mqtt_publishBinary(const char* topic, const uint8_t* payload, size_t length, bool retain, bool silentMode) {
+  if (!_wirelessServiceForward()) {
+    return _mqttPublishDirect(topic, payload, length, retain, silentMode);
+  }
+
+  // 服務任務執行中時，放得進服務佇列的訊息由服務任務發送，呼叫者不必等待 Mqtt_loop
+  if (strlen(topic) < WIRELESS_SERVICE_TOPIC_LEN && length <= WIRELESS_SERVICE_PAYLOAD_LEN) {
+    bool queued = _wirelessServicePublish(topic, payload, length, retain);
+    if (!queued && !silentMode) {
+      WM_LOGW("服務任務發布佇列已滿: %s", topic);
+    }
+    return queued;
+  }
+
+  // 較大的訊息在持有 MQTT 鎖時直接發送，先送完已轉交的請求以維持發布順序
+  MqttLock lock;
+  _mqttFlushForwarded();
+  return _mqttPublishDirect(topic, payload, length, retain, silentMode);
+}
+
+/**
+ * 發布以 CborWriter 編碼的訊息
+ * @param topic 主題
+ * @param writer 已完成編碼的 CBOR 內容
+ * @param retain 是否保留訊息
+ * @return 是否成功發布 (編碼時緩衝區不足則不發布)
+ */
+bool Mqtt_publishCbor(const char* topic, const CborWriter &writer, bool retain, bool silentMode) {
+  if (writer.overflow) {
     if (!silentMode) {
-      Serial.println("MQTT未連接，無法發布訊息");
+      WM_LOGW("CBOR 編碼緩衝區不足，未發布: %s", topic);
     }
     return false;
   }
+  return Mqtt_publishBinary(topic, writer.buffer, writer.length, retain, silentMode);
+}
+
+/**
+ * 以 QoS 1 發布訊息 (至少送達一次)
+ * 訊息會保留在傳送中視窗直到收到 PUBACK，逾時未確認時以 DUP 旗標重送；
+ * 未連線時先保留，連線後由 Mqtt_loop 送出
+ * @param topic 主題
+ * @param payload 訊息內容
+ * @param length 內容長度
+ * @param retain 是否保留訊息
+ * @param callback 確認或放棄時呼叫的回調函式，可為NULL
+ * @param ctx 傳給回調函式的使用者資料
+ * @return 封包識別碼，視窗已滿或訊息過大時返回0
+ */
+uint16_t Mqtt_publishQos1(const char* topic, const uint8_t* payload, size_t length, bool retain,
+                          MqttPublishDoneCallback callback, void* ctx, bool silentMode) {
+  MqttLock lock;
+  if (strlen(topic) >= MQTT_QUEUE_TOPIC_LEN || length > MQTT_INFLIGHT_PAYLOAD_LEN) {
+    if (!silentMode) {
+      WM_LOGE("QoS 1 訊息過大: %s", topic);
+    }
+    return 0;
+  }
+  
+  MqttInflightMessage* msg = NULL;
+  for (int i = 0; i < MQTT_INFLIGHT_SIZE; i++) {
+    if (!_mqttInflight[i].used) {
+      msg = &_mqttInflight[i];
+      break;
+    }
+  }
+  if (msg == NULL) {
+    if (!silentMode) {
+      WM_LOGW("QoS 1 傳送中視窗已滿");
+    }
+    return 0;
+  }
+  
+  msg->used = true;
+  msg->sent = false;
+  msg->due = true;
+  msg->dup = false;
+  msg->packetId = _mqttAllocPacketId();
+  strcpy(msg->topic, topic);
+  memcpy(msg->payload, payload, length);
+  msg->length = length;
+  msg->retain = retain;
+  msg->retries = 0;
+  msg->callback = callback;
+  msg->ctx = ctx;
+  _mqttInflightDepth++;
   
-  bool success = mqttClient.publish(topic, payload, retain);
+  if (mqttClient.connected()) {
+    _mqttQos1Send(*msg);
+  }
   
   if (!silentMode) {
-    if (success) {
-      Serial.print("訊息已發布至主題: ");
-      Serial.println(topic);
-    } else {
-      Serial.print("發布訊息失敗! 主題: ");
-      Serial.println(topic);
+    WM_LOGD("QoS 1 訊息已送出至主題: %s (ID: %u)", topic, msg->packetId);
+  }
+  return msg->packetId;
+}
+
+/**
+ * 設定 QoS 1 重送參數
+ * @param timeoutMs 等待 PUBACK 的逾時時間(毫秒)
+ * @param maxRetries 放棄前的最大重送次數
+ */
+void Mqtt_setQos1Retry(unsigned long timeoutMs, uint8_t maxRetries) {
+  MqttLock lock;
+  _mqttRetryTimeoutMs = timeoutMs;
+  _mqttMaxRetries = maxRetries;
+}
+
+/**
+ * 取得 QoS 1 發布的統計資訊
+ * @param stats 輸出的統計資訊
+ */
+void Mqtt_getQos1Stats(MqttQos1Stats &stats) {
+  MqttLock lock;
+  stats.inflight = _mqttInflightDepth;
+  stats.capacity = MQTT_INFLIGHT_SIZE;
+  stats.acked = _mqttQos1Acked;
+  stats.retransmits = _mqttQos1Retransmits;
+  stats.failed = _mqttQos1Failed;
+}
+
+/**
+ * 開始串流發布，之後以 Mqtt_write 分段寫入內容，最後呼叫 Mqtt_endPublish
+ * 內容直接寫入網路連線，適合由DMA等緩衝區送出大型訊息
+ * @param topic 主題
+ * @param length 內容總長度
+ * @param retain 是否保留訊息
+ * @return 是否成功開始發布
+ */
+bool Mqtt_beginPublish(const char* topic, size_t length, bool retain, bool silentMode) {
+  // 成功時持有互斥鎖直到 Mqtt_endPublish，避免服務任務在封包中途寫入 (例如 PINGREQ)
+  MqttLock lock;
+  if (_mqttStreaming) {
+    return false;
+  }
+  if (!mqttClient.connected()) {
+    if (!silentMode) {
+      WM_LOGW("MQTT未連接，無法發布訊息");
     }
+    return false;
   }
+  
+  _mqttStreaming = mqttClient.beginPublish(topic, length, retain);
+  _mqttStreamRemaining = _mqttStreaming ? length : 0;
+  
+  if (_mqttStreaming) {
+    xSemaphoreTakeRecursive(_mqttMutex(), portMAX_DELAY);
+  } else if (!silentMode) {
+    WM_LOGW("發布訊息失敗! 主題: %s", topic);
+  }
+  return _mqttStreaming;
+}
 
-  return success;
+/**
+ * 寫入串流發布的一段內容
+ * @param data 內容
+ * @param length 內容長度 (總和不可超過 Mqtt_beginPublish 宣告的長度)
+ * @return 實際寫入的位元組數
+ */
+size_t Mqtt_write(const uint8_t* data, size_t length) {
+  MqttLock lock;
+  if (!_mqttStreaming || length > _mqttStreamRemaining) {
+    return 0;
+  }
+  size_t written = mqttClient.write(data, length);
+  _mqttStreamRemaining -= written;
+  return written;
+}
+
+/**
+ * 結束串流發布，寫入長度不足宣告長度時會中斷連線
+ * @return 是否已完整寫入宣告的長度並成功送出
+ */
+bool Mqtt_endPublish() {
+  MqttLock lock;
+  if (!_mqttStreaming) {
+    return false;
+  }
+  _mqttStreaming = false;
+  // 釋放 Mqtt_beginPublish 取得的鎖
+  xSemaphoreGiveRecursive(_mqttMutex());
+  if (_mqttStreamRemaining > 0) {
+    // 內容不足時伺服器端的封包邊界已錯亂，只能關閉連線重新同步；
+    // 不可送出 DISCONNECT，伺服器會將其視為未完成封包的內容。之後由 Mqtt_loop 重新連線
+    _mqttStreamRemaining = 0;
+    mqttTap.stop();
+    _mqttSetLink(false);
+    return false;
+  }
+  return mqttClient.endPublish() == 1;
+}
+
+/**
+ * 設定 PubSubClient 的封包緩衝區大小 (影響可接收的最大訊息)
+ * @param size 緩衝區大小(位元組)
+ * @return 是否設定成功
+ */
+bool Mqtt_setBufferSize(uint16_t size) {
+  MqttLock lock;
+  return mqttClient.setBufferSize(size);
 }
 
 /**
- * 訂閱MQTT主題
+ * 訂閱MQTT主題，訂閱會被記錄並在重新連線後自動恢復
  * @param topic 主題
  * @param qos 服務品質 (0, 1, 2)
  * @return 是否成功訂閱
  */
 bool Mqtt_subscribe(const char* topic, int qos, bool silentMode) {
+  MqttLock lock;
+  _mqttTrackSubscription(topic, qos);
+  
   if (!mqttClient.connected()) {
     if (!silentMode) {
-      Serial.println("MQTT未連接，無法訂閱主題");
+      WM_LOGW("MQTT未連接，無法訂閱主題");
     }
     return false;
   }
@@ -148,11 +1232,9 @@ bool Mqtt_subscribe(const char* topic, int qos, bool silentMode) {
 
   if (!silentMode) {
     if (success) {
-      Serial.print("已訂閱主題: ");
-      Serial.println(topic);
+      WM_LOGI("已訂閱主題: %s", topic);
     } else {
-      Serial.print("訂閱主題失敗: ");
-      Serial.println(topic);
+      WM_LOGW("訂閱主題失敗: %s", topic);
     }
   }
   
@@ -165,9 +1247,12 @@ bool Mqtt_subscribe(const char* topic, int qos, bool silentMode) {
  * @return 是否成功取消訂閱
  */
 bool Mqtt_unsubscribe(const char* topic, bool silentMode) {
+  MqttLock lock;
+  _mqttUntrackSubscription(topic);
+  
   if (!mqttClient.connected()) {
     if (!silentMode) {
-      Serial.println("MQTT未連接，無法取消訂閱");
+      WM_LOGW("MQTT未連接，無法取消訂閱");
     }
     return false;
   }
@@ -176,38 +1261,143 @@ bool Mqtt_unsubscribe(const char* topic, bool silentMode) {
 
   if (!silentMode) {
     if (success) {
-      Serial.print("已取消訂閱主題: ");
-      Serial.println(topic);
+      WM_LOGI("已取消訂閱主題: %s", topic);
     } else {
-      Serial.print("取消訂閱失敗: ");
-      Serial.println(topic);
+      WM_LOGW("取消訂閱失敗: %s", topic);
     }
   }
   
   return success;
 }
 
+/**
+ * 為主題過濾器註冊處理函式，並訂閱該過濾器
+ * 支援 '+' (單一層級) 與 '#' (剩餘所有層級) 萬用字元，同一則訊息可匹配多個處理函式
+ * @param filter 主題過濾器，例如 "sensor/+/temp" 或 "cmd/#"
+ * @param handler 處理函式
+ * @param ctx 傳給處理函式的使用者資料，可為NULL
+ * @param qos 訂閱的服務品質
+ * @return 是否成功註冊 (未連線時會在連線後自動訂閱)
+ */
+bool Mqtt_on(const char* filter, MqttTopicHandler handler, void* ctx, int qos, bool silentMode) {
+  MqttLock lock;
+  if (filter == NULL || handler == NULL) {
+    return false;
+  }
+  
+  int16_t slot = _mqttRouteFreeHandler;
+  if (slot >= 0) {
+    _mqttRouteFreeHandler = _mqttRouteHandlers[slot].next;
+  } else if (_mqttRouteHandlerCount < MQTT_ROUTER_MAX_HANDLERS) {
+    slot = _mqttRouteHandlerCount++;
+  } else {
+    if (!silentMode) {
+      WM_LOGE("主題處理函式已達上限");
+    }
+    return false;
+  }
+  
+  int16_t node = _mqttRouteFind(filter, true);
+  if (node < 0) {
+    _mqttRouteHandlers[slot].next = _mqttRouteFreeHandler;
+    _mqttRouteFreeHandler = slot;
+    // 節點池已滿時可能留下部分建立的路徑
+    _mqttRoutePrune(0, filter);
+    if (!silentMode) {
+      WM_LOGE("主題過濾器無效或路由表已滿: %s", filter);
+    }
+    return false;
+  }
+  
+  _mqttRouteHandlers[slot].handler = handler;
+  _mqttRouteHandlers[slot].ctx = ctx;
+  _mqttRouteHandlers[slot].next = _mqttRouteNodes[node].firstHandler;
+  _mqttRouteNodes[node].firstHandler = slot;
+  
+  Mqtt_subscribe(filter, qos, silentMode);
+  return true;
+}
+
+/**
+ * 移除主題過濾器上的處理函式，過濾器上沒有其他處理函式時一併取消訂閱
+ * @param filter 主題過濾器
+ * @param handler 處理函式
+ * @param ctx 註冊時使用的使用者資料
+ * @return 是否找到並移除
+ */
+bool Mqtt_off(const char* filter, MqttTopicHandler handler, void* ctx, bool silentMode) {
+  MqttLock lock;
+  int16_t node = (_mqttRouteNodeCount > 0) ? _mqttRouteFind(filter, false) : -1;
+  if (node < 0) {
+    return false;
+  }
+  
+  int16_t* link = &_mqttRouteNodes[node].firstHandler;
+  while (*link >= 0) {
+    int16_t h = *link;
+    if (_mqttRouteHandlers[h].handler == handler && _mqttRouteHandlers[h].ctx == ctx) {
+      *link = _mqttRouteHandlers[h].next;
+      _mqttRouteHandlers[h].next = _mqttRouteFreeHandler;
+      _mqttRouteFreeHandler = h;
+      
+      if (_mqttRouteNodes[node].firstHandler < 0) {
+        _mqttRoutePrune(0, filter);
+        Mqtt_unsubscribe(filter, silentMode);
+      }
+      return true;
+    }
+    link = &_mqttRouteHandlers[h].next;
+  }
+  return false;
+}
+
+/**
+ * 取得MQTT連線資訊，不配置堆積記憶體，可於迴圈中高頻率呼叫
+ * @param info 輸出的連線資訊
+ * @return 是否已連接
+ */
+bool Mqtt_getInfo(MqttInfo &info) {
+  MqttLock lock;
+  info.connected = mqttClient.connected();
+  info.state = mqttClient.state();
+  info.lastError = _mqttLastError;
+  info.server = _mqttServer;
+  info.port = _mqttPort;
+  info.uptimeMs = info.connected && _mqttLinkUp ? millis() - _mqttLinkUpAt : 0;
+  info.inflight = _mqttInflightDepth;
+  info.queued = _mqttQueueDepth;
+  info.reconnects = _mqttReconnects;
+  return info.connected;
+}
+
 /**
  * 檢查MQTT連接狀態
  * @param silentMode 是否靜默模式 (不顯示連線資訊)
  * @return 是否已連接
  */
 bool Mqtt_checkStatus(bool silentMode) {
-  bool isConnected = mqttClient.connected();
-  
-  if (!silentMode) {
-    Serial.println("----------- MQTT 狀態 -----------");
-    Serial.print("連接狀態: ");
-    Serial.println(isConnected ? "已連接" : "未連接");
-    
-    if (!isConnected) {
-      Serial.print("錯誤碼: ");
-      Serial.println(mqttClient.state());
-    }
-    Serial.println("--------------------------------");
+  MqttLock lock;
+  if (silentMode) {
+    return mqttClient.connected();
   }
-  
-  return isConnected;
+
+  MqttInfo info;
+  Mqtt_getInfo(info);
+
+  WM_LOGI("----------- MQTT 狀態 -----------");
+  WM_LOGI("連接狀態: %s", info.connected ? "已連接" : "未連接");
+  if (info.server != NULL) {
+    WM_LOGI("伺服器: %s:%u", info.server, info.port);
+  }
+  if (info.connected) {
+    WM_LOGI("連線時間: %lu ms", (unsigned long)info.uptimeMs);
+    WM_LOGI("待確認/佇列: %u/%u", info.inflight, info.queued);
+  } else {
+    WM_LOGI("錯誤碼: %d", info.state);
+  }
+  WM_LOGI(WM_SEPARATOR);
+
+  return info.connected;
 }
 
 /**
@@ -216,20 +1406,78 @@ bool Mqtt_checkStatus(bool silentMode) {
  * @return 目前的連線狀態
  */
 bool Mqtt_loop() {
-  return mqttClient.loop();
+  MqttLock lock;
+  bool connected = mqttClient.loop();
+  
+  if (!connected && _mqttAutoReconnect && _mqttSessionActive) {
+    _mqttManageReconnect();
+    connected = mqttClient.connected();
+  }
+  
+  if (connected && _mqttInflightDepth > 0) {
+    _mqttServiceInflight();
+  }
+  
+  if (connected && _mqttQueueDepth > 0) {
+    _mqttFlushQueue();
+  }
+  
+  _mqttSetLink(connected);
+  Wireless_metricsLoop();
+  return connected;
+}
+
+/**
+ * 設定離線發布佇列
+ * 啟用後，未連線時 Mqtt_publish 會將訊息放入佇列，連線恢復後由 Mqtt_loop 分批送出
+ * @param enable 是否啟用
+ * @param policy 佇列已滿時的策略 (捨棄最舊或最新的訊息)
+ * @param flushBatch 每次 Mqtt_loop 最多送出的訊息數
+ * @param flushBudgetMs 每次 Mqtt_loop 送出佇列的時間預算(毫秒)
+ */
+void Mqtt_setOfflineQueue(bool enable, MqttQueuePolicy policy, uint16_t flushBatch, uint16_t flushBudgetMs) {
+  MqttLock lock;
+  _mqttQueueEnabled = enable;
+  _mqttQueuePolicy = policy;
+  _mqttFlushBatch = flushBatch > 0 ? flushBatch : 1;
+  _mqttFlushBudgetMs = flushBudgetMs;
+}
+
+/**
+ * 取得離線佇列的統計資訊
+ * @param stats 輸出的統計資訊
+ */
+void Mqtt_getQueueStats(MqttQueueStats &stats) {
+  MqttLock lock;
+  stats.depth = _mqttQueueDepth;
+  stats.capacity = MQTT_QUEUE_SIZE;
+  stats.enqueued = _mqttQueueEnqueued;
+  stats.dropped = _mqttQueueDropped;
+  stats.flushed = _mqttQueueFlushed;
+  stats.bypassed = _mqttQueueBypassed;
+}
+
+/**
+ * 清空離線佇列
+ */
+void Mqtt_clearQueue() {
+  MqttLock lock;
+  _mqttQueueHead = 0;
+  _mqttQueueDepth = 0;
 }
 
 /**
  * 斷開MQTT連線
  */
 void Mqtt_disconnect(bool silentMode) {
-  if (!silentMode) {
-    Serial.println("--------------------------------");
-    Serial.print("斷開MQTT連線... ");
-  }
+  MqttLock lock;
+  _mqttSessionActive = false;
+  _mqttReconnectPending = false;
   mqttClient.disconnect();
+  _mqttSetLink(false);
   if (!silentMode) {
-    Serial.println("已斷開MQTT連線");
-    Serial.println("--------------------------------");
+    WM_LOGI(WM_SEPARATOR);
+    WM_LOGI("已斷開MQTT連線");
+    WM_LOGI(WM_SEPARATOR);
   }
 }
\ No newline at end of file
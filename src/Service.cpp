@@ -0,0 +1,274 @@
+#include "Wireless_mgmt.h"
+#include "Arduino.h"
+#include <atomic>
+
+// ==========================================
+// Wireless Service
+// ==========================================
+
+// 其他任務轉交的發布請求
+typedef struct {
+  char topic[WIRELESS_SERVICE_TOPIC_LEN];
+  uint16_t length;
+  bool retain;
+  uint8_t payload[WIRELESS_SERVICE_PAYLOAD_LEN];
+} WirelessPublishRequest;
+
+// 服務任務收到、等待 Wireless_dispatch 處理的訊息
+typedef struct {
+  uint8_t source;
+  uint16_t connId;
+  uint16_t length;
+  char topic[WIRELESS_SERVICE_TOPIC_LEN];
+  uint8_t payload[WIRELESS_SERVICE_PAYLOAD_LEN + 1];  // 多留一個位元組給結尾的 '\0'
+} WirelessInbound;
+
+static TaskHandle_t _serviceTask = NULL;
+static QueueHandle_t _servicePublishQueue = NULL;
+static QueueHandle_t _serviceInboundQueue = NULL;
+static std::atomic<bool> _serviceRunning(false);
+static std::atomic<bool> _serviceStopping(false);
+static SemaphoreHandle_t _serviceStopped = NULL;    // 服務任務結束前發出
+static uint8_t _serviceModules = WIRELESS_SERVICE_ALL;
+
+static std::atomic<uint32_t> _serviceLoops(0);
+static std::atomic<uint32_t> _servicePublishQueued(0);
+static std::atomic<uint32_t> _servicePublishDropped(0);
+static std::atomic<uint32_t> _serviceInboundQueued(0);
+static std::atomic<uint32_t> _serviceInboundDropped(0);
+
+/**
+ * 呼叫者是否應把發布請求轉交給服務任務 (服務執行中且不在服務任務內)
+ */
+bool _wirelessServiceForward() {
+  return _serviceRunning && xTaskGetCurrentTaskHandle() != _serviceTask;
+}
+
+/**
+ * 收到的訊息是否應延後到 Wireless_dispatch 處理 (服務執行中且在服務任務內)
+ */
+bool _wirelessServiceDefer() {
+  return _serviceRunning && xTaskGetCurrentTaskHandle() == _serviceTask;
+}
+
+/**
+ * 將發布請求複製到服務任務的佇列
+ * @return 是否成功放入佇列
+ */
+bool _wirelessServicePublish(const char* topic, const uint8_t* payload, size_t length, bool retain) {
+  size_t topicLength = strlen(topic);
+  if (topicLength >= WIRELESS_SERVICE_TOPIC_LEN || length > WIRELESS_SERVICE_PAYLOAD_LEN) {
+    _servicePublishDropped++;
+    _wirelessMetricAdd(WIRELESS_METRIC_SERVICE_DROPS);
+    return false;
+  }
+
+  WirelessPublishRequest request;
+  memcpy(request.topic, topic, topicLength + 1);
+  memcpy(request.payload, payload, length);
+  request.length = length;
+  request.retain = retain;
+
+  if (xQueueSend(_servicePublishQueue, &request, 0) != pdTRUE) {
+    _servicePublishDropped++;
+    _wirelessMetricAdd(WIRELESS_METRIC_SERVICE_DROPS);
+    return false;
+  }
+  _servicePublishQueued++;
+  return true;
+}
+
+/**
+ * 送出發布佇列中所有的請求，呼叫者需持有 MQTT 鎖 (經由 _mqttFlushForwarded)
+ */
+void _wirelessServiceDrainPublish() {
+  if (_servicePublishQueue == NULL) return;
+
+  WirelessPublishRequest request;
+  while (xQueueReceive(_servicePublishQueue, &request, 0) == pdTRUE) {
+    _mqttPublishDirect(request.topic, request.payload, request.length, request.retain, true);
+  }
+}
+
+/**
+ * 將收到的訊息複製到接收佇列，等待 Wireless_dispatch 處理
+ * @return 是否成功放入佇列
+ */
+bool _wirelessServicePostInbound(uint8_t source, uint16_t connId, const char* topic, const uint8_t* data, size_t length) {
+  size_t topicLength = topic != NULL ? strlen(topic) : 0;
+  if (topicLength >= WIRELESS_SERVICE_TOPIC_LEN || length > WIRELESS_SERVICE_PAYLOAD_LEN) {
+    _serviceInboundDropped++;
+    _wirelessMetricAdd(WIRELESS_METRIC_SERVICE_DROPS);
+    return false;
+  }
+
+  WirelessInbound message;
+  message.source = source;
+  message.connId = connId;
+  message.length = length;
+  memcpy(message.topic, topic != NULL ? topic : "", topicLength + 1);
+  memcpy(message.payload, data, length);
+  message.payload[length] = '\0';
+
+  if (xQueueSend(_serviceInboundQueue, &message, 0) != pdTRUE) {
+    _serviceInboundDropped++;
+    _wirelessMetricAdd(WIRELESS_METRIC_SERVICE_DROPS);
+    return false;
+  }
+  _serviceInboundQueued++;
+  return true;
+}
+
+/**
+ * 服務任務主體
+ */
+static void _serviceLoop(void* arg) {
+  while (!_serviceStopping) {
+    // 先送出其他任務轉交的發布請求
+    _mqttFlushForwarded();
+
+    if (_serviceModules & WIRELESS_SERVICE_WIFI) Wifi_poll();
+    if (_serviceModules & WIRELESS_SERVICE_MQTT) Mqtt_loop();
+    if (_serviceModules & WIRELESS_SERVICE_BT) BT_loop();
+    if (_serviceModules & WIRELESS_SERVICE_BLE) BLE_loop();
+
+    _serviceLoops++;
+    vTaskDelay(pdMS_TO_TICKS(WIRELESS_SERVICE_PERIOD_MS));
+  }
+
+  _serviceRunning = false;
+  xSemaphoreGive(_serviceStopped);
+  vTaskDelete(NULL);
+}
+
+/**
+ * 啟動無線服務任務
+ * 啟動後應用程式不需要再呼叫 Mqtt_loop/BT_loop/BLE_loop，
+ * 但需在自己的迴圈中呼叫 Wireless_dispatch 以處理收到的訊息
+ * @param core 執行的核心 (ESP32 的協定堆疊位於核心 0)
+ * @param priority 任務優先權
+ * @param stackSize 任務堆疊大小 (位元組)
+ * @param modules 要處理的模組 (WIRELESS_SERVICE_* 的組合)
+ * @param silentMode 是否安靜模式
+ * @return 是否成功啟動
+ */
+bool Wireless_startService(int core, uint8_t priority, uint32_t stackSize, uint8_t modules, bool silentMode) {
+  if (_serviceRunning) {
+    if (!silentMode) WM_LOGW("無線服務任務已在執行中");
+    return false;
+  }
+
+  if (_servicePublishQueue == NULL) {
+    _servicePublishQueue = xQueueCreate(WIRELESS_SERVICE_QUEUE_SIZE, sizeof(WirelessPublishRequest));
+  }
+  if (_serviceInboundQueue == NULL) {
+    _serviceInboundQueue = xQueueCreate(WIRELESS_SERVICE_QUEUE_SIZE, sizeof(WirelessInbound));
+  }
+  if (_serviceStopped == NULL) {
+    _serviceStopped = xSemaphoreCreateBinary();
+  }
+  if (_servicePublishQueue == NULL || _serviceInboundQueue == NULL || _serviceStopped == NULL) {
+    if (!silentMode) WM_LOGE("無法建立無線服務佇列");
+    return false;
+  }
+
+  _serviceModules = modules;
+  _serviceStopping = false;
+  _serviceRunning = true;
+
+  if (xTaskCreatePinnedToCore(_serviceLoop, "wireless", stackSize, NULL, priority, &_serviceTask, core) != pdPASS) {
+    _serviceRunning = false;
+    _serviceTask = NULL;
+    if (!silentMode) WM_LOGE("無法建立無線服務任務");
+    return false;
+  }
+
+  if (!silentMode) {
+    WM_LOGI(WM_SEPARATOR);
+    WM_LOGI("無線服務任務已啟動:");
+    WM_LOGI("- 核心: %d, 優先權: %u, 堆疊: %lu", core, priority, (unsigned long)stackSize);
+    WM_LOGI("- 模組:%s%s%s%s",
+            (modules & WIRELESS_SERVICE_WIFI) ? " WiFi" : "",
+            (modules & WIRELESS_SERVICE_MQTT) ? " MQTT" : "",
+            (modules & WIRELESS_SERVICE_BT) ? " BT" : "",
+            (modules & WIRELESS_SERVICE_BLE) ? " BLE" : "");
+    WM_LOGI(WM_SEPARATOR);
+  }
+  return true;
+}
+
+/**
+ * 停止無線服務任務，等待目前這一輪處理完畢
+ * 停止後回到由應用程式呼叫各模組 loop 函式的模式
+ * @return 是否已停止 (在服務任務中呼叫時無法等待自己結束，返回 false)
+ */
+bool Wireless_stopService(bool silentMode) {
+  if (!_serviceRunning) return true;
+  if (xTaskGetCurrentTaskHandle() == _serviceTask) {
+    if (!silentMode) WM_LOGE("無法在服務任務中停止服務任務");
+    return false;
+  }
+
+  _serviceStopping = true;
+  xSemaphoreTake(_serviceStopped, portMAX_DELAY);
+  _serviceTask = NULL;
+
+  // 處理停止前尚未送出的發布請求
+  _mqttFlushForwarded();
+
+  if (!silentMode) {
+    WM_LOGI("無線服務任務已停止");
+  }
+  return true;
+}
+
+/**
+ * 檢查無線服務任務是否執行中
+ * @return 是否執行中
+ */
+bool Wireless_serviceRunning() {
+  return _serviceRunning;
+}
+
+/**
+ * 在呼叫者的任務中處理服務任務收到的訊息 (呼叫 MQTT/BT/BLE 的回調函式)
+ * @param maxMessages 最多處理的訊息數
+ * @return 處理的訊息數
+ */
+int Wireless_dispatch(int maxMessages) {
+  if (_serviceInboundQueue == NULL) return 0;
+
+  // 使用區域變數，回調函式中再次呼叫或多個任務同時呼叫時不會互相覆寫
+  WirelessInbound message;
+  int handled = 0;
+  while (handled < maxMessages && xQueueReceive(_serviceInboundQueue, &message, 0) == pdTRUE) {
+    switch (message.source) {
+      case WIRELESS_INBOUND_MQTT:
+        _mqttDeliver(message.topic, message.payload, message.length);
+        break;
+      case WIRELESS_INBOUND_BT:
+        _btDeliver(message.payload, message.length);
+        break;
+      case WIRELESS_INBOUND_BLE:
+        _bleDeliver(message.connId, message.payload, message.length);
+        break;
+      default:
+        break;
+    }
+    handled++;
+  }
+  return handled;
+}
+
+/**
+ * 取得無線服務任務統計資訊
+ * @param stats 輸出的統計資訊
+ */
+void Wireless_getServiceStats(WirelessServiceStats &stats) {
+  stats.loops = _serviceLoops;
+  stats.publishQueued = _servicePublishQueued;
+  stats.publishDropped = _servicePublishDropped;
+  stats.inboundQueued = _serviceInboundQueued;
+  stats.inboundDropped = _serviceInboundDropped;
+  stats.stackHighWater = (_serviceRunning && _serviceTask != NULL) ? uxTaskGetStackHighWaterMark(_serviceTask) : 0;
+}
\ No newline at end of file
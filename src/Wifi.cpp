@@ -1,198 +1,1226 @@
 #include "Wireless_mgmt.h"
 #include "Arduino.h"
 #include <WiFi.h>
+#include <esp_wifi.h>
+#include <esp_idf_version.h>
+#include "ping/ping_sock.h"
+#include <atomic>
+
+static bool _wifiPowerActive();
+static void _wifiApplyPower(bool beforeConnect);
+static void _wifiApplyListenInterval();
+
+/**
+ * 保護 WiFi 連線狀態機 (掃描、連線狀態、候選與排序清單、配網與省電設定) 的遞迴互斥鎖
+ * 服務任務的 Wifi_poll 與其他任務的連線函式互斥；阻塞式連線只在每次推進時持有，
+ * 等待期間服務任務仍可繼續執行。連線完成回調函式在持有此鎖時執行
+ */
+static SemaphoreHandle_t _wifiMutex() {
+    // 函式內的靜態變數由編譯器保證只初始化一次，多個任務同時首次呼叫也安全
+    static SemaphoreHandle_t mutex = xSemaphoreCreateRecursiveMutex();
+    return mutex;
+}
+
+class WifiLock {
+    public:
+        WifiLock() { xSemaphoreTakeRecursive(_wifiMutex(), portMAX_DELAY); }
+        ~WifiLock() { xSemaphoreGiveRecursive(_wifiMutex()); }
+};
 
 // ==========================================
 // WiFi Client Mode
 // ==========================================
 
+// 非同步掃描的內部狀態，結果存放於固定大小的表格，不使用 String
+static WifiScanResult _wifiScanTable[WIFI_SCAN_MAX_RESULTS];
+static int _wifiScanCount = 0;
+static WifiScanConfig _wifiScanConfig = {0, false, 0, false};
+static uint8_t _wifiScanChannel = 0;    // 目前掃描的頻道 (0為全頻道)
+static bool _wifiScanRunning = false;
+
 /**
- * 連接到指定的 WiFi 網路，可選擇使用靜態IP
- * @param ssid WiFi 網路名稱
- * @param password WiFi 密碼
- * @param silentMode 是否靜默連接
- * @param timeoutSeconds WiFi連接的最長等待時間(秒)
- * @param staticIP 靜態IP地址 (可選，格式如 "192.168.1.100")
- * @param gateway 閘道地址 (可選，使用靜態IP時必須提供)
- * @param subnet 子網掩碼 (可選，使用靜態IP時必須提供)
- * @param dns1 主要DNS伺服器 (可選)
- * @param dns2 次要DNS伺服器 (可選)
- * @return 連接結果 (true: 成功, false: 失敗)
+ * 由目前頻道之後找出遮罩中的下一個頻道
+ * @return 下一個頻道，沒有時返回0
  */
-bool Wifi_connect(
-    const char* ssid,
-    const char* password,
-    int timeoutSeconds,
-    bool silentMode,
-    const char* staticIP,
-    const char* gateway,
-    const char* subnet,
-    const char* dns1,
-    const char* dns2
-){
-    if (!silentMode) {
-        Serial.println("正在掃描WiFi網路...");
+static uint8_t _wifiScanNextChannel(uint8_t after) {
+    for (uint8_t ch = after + 1; ch <= 14; ch++) {
+        if (_wifiScanConfig.channelMask & (1 << (ch - 1))) {
+            return ch;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 將驅動程式的掃描結果複製到表格，表格已滿時取代信號最弱的項目
+ */
+static void _wifiScanCollect(int networkCount) {
+    for (int i = 0; i < networkCount; i++) {
+        const wifi_ap_record_t* record = (const wifi_ap_record_t*)WiFi.getScanInfoByIndex(i);
+        if (record == NULL) {
+            continue;
+        }
+        
+        int slot = _wifiScanCount;
+        if (slot >= WIFI_SCAN_MAX_RESULTS) {
+            slot = 0;
+            for (int j = 1; j < WIFI_SCAN_MAX_RESULTS; j++) {
+                if (_wifiScanTable[j].rssi < _wifiScanTable[slot].rssi) {
+                    slot = j;
+                }
+            }
+            if (_wifiScanTable[slot].rssi >= record->rssi) {
+                continue;
+            }
+        } else {
+            _wifiScanCount++;
+        }
+        
+        WifiScanResult& entry = _wifiScanTable[slot];
+        size_t ssidLen = strnlen((const char*)record->ssid, sizeof(entry.ssid) - 1);
+        memcpy(entry.ssid, record->ssid, ssidLen);
+        entry.ssid[ssidLen] = '\0';
+        entry.ssidLen = ssidLen;
+        memcpy(entry.bssid, record->bssid, sizeof(entry.bssid));
+        entry.channel = record->primary;
+        entry.rssi = record->rssi;
+        entry.auth = record->authmode;
+    }
+}
+
+/**
+ * 開始掃描單一頻道 (0為全頻道)
+ */
+static bool _wifiScanLaunch(uint8_t channel) {
+    // 驅動程式仍在掃描時 scanNetworks(true) 同樣返回 WIFI_SCAN_RUNNING，
+    // 無法與成功啟動區分，因此先確認沒有進行中的掃描
+    if (WiFi.scanComplete() == WIFI_SCAN_RUNNING) {
+        return false;
+    }
+    _wifiScanChannel = channel;
+    int16_t result = WiFi.scanNetworks(
+        true, _wifiScanConfig.showHidden, _wifiScanConfig.passive,
+        _wifiScanConfig.dwellMs > 0 ? _wifiScanConfig.dwellMs : 300, channel
+    );
+    return result != WIFI_SCAN_FAILED;
+}
+
+/**
+ * 開始非同步掃描，之後需定期呼叫 Wifi_scanPoll() 取得結果
+ * @param config 掃描設定 (頻道遮罩、主動/被動、每頻道停留時間)
+ * @return 是否成功開始掃描
+ */
+bool Wifi_scanStart(const WifiScanConfig &config) {
+    WifiLock lock;
+    if (_wifiScanRunning) {
+        return false;
     }
     
-    // 掃描可用的WiFi網路
-    int networkCount = WiFi.scanNetworks();
+    _wifiScanConfig = config;
+    _wifiScanConfig.channelMask &= WIFI_SCAN_ALL_CHANNELS;
+    _wifiScanCount = 0;
     
-    if (networkCount == 0) {
-        if (!silentMode) {
-            Serial.println();
-            Serial.println("- 未找到WiFi網路 -");
-        }
+    // 未指定頻道時以單次全頻道掃描完成
+    uint8_t first = (_wifiScanConfig.channelMask == 0) ? 0 : _wifiScanNextChannel(0);
+    if (!_wifiScanLaunch(first)) {
         return false;
     }
+    _wifiScanRunning = true;
+    return true;
+}
+
+/**
+ * 推進非同步掃描，每次呼叫都會立即返回
+ * @return WIFI_SCAN_RUNNING 掃描中、WIFI_SCAN_FAILED 失敗，否則為結果數量
+ */
+int Wifi_scanPoll() {
+    WifiLock lock;
+    if (!_wifiScanRunning) {
+        return _wifiScanCount;
+    }
     
-    // 查找匹配的SSID
-    bool foundNetwork = false;
-    for (int i = 0; i < networkCount; i++) {
-        if (strcmp(WiFi.SSID(i).c_str(), ssid) == 0) {
-            foundNetwork = true;
-            if (!silentMode) {
-                Serial.print("找到 ");
-                Serial.print(ssid);
-                Serial.print(" (信號強度: ");
-                Serial.print(WiFi.RSSI(i));
-                Serial.println(" dBm)");
+    int16_t result = WiFi.scanComplete();
+    if (result == WIFI_SCAN_RUNNING) {
+        return WIFI_SCAN_RUNNING;
+    }
+    if (result == WIFI_SCAN_FAILED) {
+        _wifiScanRunning = false;
+        return WIFI_SCAN_FAILED;
+    }
+    
+    _wifiScanCollect(result);
+    WiFi.scanDelete();
+    
+    // 繼續掃描遮罩中的下一個頻道
+    uint8_t next = (_wifiScanChannel == 0) ? 0 : _wifiScanNextChannel(_wifiScanChannel);
+    if (next != 0) {
+        if (_wifiScanLaunch(next)) {
+            return WIFI_SCAN_RUNNING;
+        }
+        _wifiScanRunning = false;
+        return WIFI_SCAN_FAILED;
+    }
+    
+    _wifiScanRunning = false;
+    return _wifiScanCount;
+}
+
+/**
+ * 取消進行中的掃描
+ */
+void Wifi_scanCancel() {
+    WifiLock lock;
+    if (_wifiScanRunning) {
+        // scanDelete() 只釋放結果，需另外停止驅動程式的掃描
+        esp_wifi_scan_stop();
+        WiFi.scanDelete();
+        _wifiScanRunning = false;
+    }
+}
+
+/**
+ * 取得最近一次掃描的結果表格
+ * @param count 輸出結果數量，可為NULL
+ * @return 結果表格 (掃描中時內容可能不完整)
+ */
+const WifiScanResult* Wifi_scanResults(int* count) {
+    if (count != NULL) {
+        *count = _wifiScanCount;
+    }
+    return _wifiScanTable;
+}
+
+// 非阻塞連線狀態機的內部狀態
+static WifiConnState _wifiConnState = WIFI_CONN_IDLE;
+static WifiConnectCallback _wifiConnectCallback = NULL;
+static char _wifiSsid[33] = {0};
+static char _wifiPassword[65] = {0};
+static bool _wifiSilentMode = false;
+static bool _wifiUseStaticIP = false;
+static unsigned long _wifiTimeoutMs = 0;
+static unsigned long _wifiBeginTime = 0;
+static WifiScanConfig _wifiConnectScanConfig = {0, false, 0, false};
+
+// 候選網路登錄表 (Wifi_addCandidate)
+typedef struct {
+    char ssid[33];
+    char password[65];
+    int priority;
+} WifiCandidate;
+
+static WifiCandidate _wifiCandidates[WIFI_MAX_CANDIDATES];
+static int _wifiCandidateCount = 0;
+
+// 單一SSID連線時使用的臨時候選
+static WifiCandidate _wifiSingleCandidate;
+
+// 本次連線使用的候選清單
+static const WifiCandidate* _wifiActive = NULL;
+static int _wifiActiveCount = 0;
+
+// 由單次掃描排序出的 BSSID 清單，失敗時依序切換而不需重新掃描
+static WifiRankedAP _wifiRanked[WIFI_MAX_RANKED];
+static int _wifiRankedCount = 0;
+static int _wifiRankedIndex = -1;
+
+// 由 WiFi 事件任務設定，表示已與 AP 完成關聯 (尚未取得 IP)
+static volatile bool _wifiAssociated = false;
+static bool _wifiEventsRegistered = false;
+
+static void _wifiOnStaConnected(arduino_event_id_t event, arduino_event_info_t info) {
+    _wifiAssociated = true;
+}
+
+// 上次通知的連線狀態，用來產生 LINK_UP/LINK_DOWN 事件
+static bool _wifiLinkUp = false;
+static unsigned long _wifiLinkUpAt = 0;
+static uint8_t _wifiLastReason = 0;
+static unsigned long _wifiAPStartedAt = 0;
+
+// AP 站台表，由 WiFi 事件任務寫入，以臨界區段保護
+typedef struct {
+    bool used;
+    WifiAPStation station;
+} WifiAPStationSlot;
+
+static WifiAPStationSlot _wifiAPStations[WIFI_AP_MAX_STATIONS];
+static portMUX_TYPE _wifiAPMux = portMUX_INITIALIZER_UNLOCKED;
+static WifiAPStationCallback _wifiAPStationCallback = NULL;
+static void* _wifiAPStationCtx = NULL;
+
+/**
+ * 依 MAC 位址尋找站台 (呼叫前需進入臨界區段)
+ */
+static int _wifiAPFind(const uint8_t mac[6]) {
+    for (int i = 0; i < WIFI_AP_MAX_STATIONS; i++) {
+        if (_wifiAPStations[i].used && memcmp(_wifiAPStations[i].station.mac, mac, 6) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * 記錄加入的站台，重複加入時沿用原本的欄位
+ */
+static void _wifiAPJoin(const uint8_t mac[6], uint8_t aid) {
+    portENTER_CRITICAL(&_wifiAPMux);
+    int i = _wifiAPFind(mac);
+    if (i < 0) {
+        for (int j = 0; j < WIFI_AP_MAX_STATIONS; j++) {
+            if (!_wifiAPStations[j].used) {
+                i = j;
+                memset(&_wifiAPStations[i].station, 0, sizeof(WifiAPStation));
+                memcpy(_wifiAPStations[i].station.mac, mac, 6);
+                _wifiAPStations[i].used = true;
+                break;
             }
+        }
+    }
+    if (i >= 0) {
+        _wifiAPStations[i].station.aid = aid;
+        _wifiAPStations[i].station.joinedAt = millis();
+    }
+    portEXIT_CRITICAL(&_wifiAPMux);
+}
+
+/**
+ * 記錄分配的 IP，傳回對應站台的 MAC 位址
+ * ESP-IDF 5 的事件帶有 MAC 位址；舊版只有 IP，指派給最近加入且尚未取得 IP 的站台
+ */
+static bool _wifiAPAssignIP(const arduino_event_info_t &info, uint8_t mac[6]) {
+    uint32_t ip = info.wifi_ap_staipassigned.ip.addr;
+    portENTER_CRITICAL(&_wifiAPMux);
+#if ESP_IDF_VERSION_MAJOR >= 5
+    int i = _wifiAPFind(info.wifi_ap_staipassigned.mac);
+#else
+    int i = -1;
+    for (int j = 0; j < WIFI_AP_MAX_STATIONS; j++) {
+        const WifiAPStationSlot &slot = _wifiAPStations[j];
+        if (slot.used && slot.station.ip == 0 &&
+            (i < 0 || (long)(slot.station.joinedAt - _wifiAPStations[i].station.joinedAt) > 0)) {
+            i = j;
+        }
+    }
+#endif
+    if (i >= 0) {
+        _wifiAPStations[i].station.ip = ip;
+        memcpy(mac, _wifiAPStations[i].station.mac, 6);
+    }
+    portEXIT_CRITICAL(&_wifiAPMux);
+    return i >= 0;
+}
+
+/**
+ * 移除離開的站台
+ */
+static void _wifiAPLeave(const uint8_t mac[6]) {
+    portENTER_CRITICAL(&_wifiAPMux);
+    int i = _wifiAPFind(mac);
+    if (i >= 0) _wifiAPStations[i].used = false;
+    portEXIT_CRITICAL(&_wifiAPMux);
+}
+
+/**
+ * 清空站台表 (AP 啟動或停止時)
+ */
+static void _wifiAPClearStations() {
+    portENTER_CRITICAL(&_wifiAPMux);
+    for (int i = 0; i < WIFI_AP_MAX_STATIONS; i++) {
+        _wifiAPStations[i].used = false;
+    }
+    portEXIT_CRITICAL(&_wifiAPMux);
+}
+
+/**
+ * WiFi 事件任務中的事件轉換: STA 連線狀態與 AP 站台進出
+ */
+static void _wifiOnLinkEvent(arduino_event_id_t id, arduino_event_info_t info) {
+    WirelessEvent event = {};
+    uint8_t mac[6];
+    bool leaving = false;
+    switch (id) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            if (_wifiLinkUp) return;
+            _wifiLinkUp = true;
+            _wifiLinkUpAt = millis();
+            event.type = WIRELESS_EVENT_LINK_UP;
+            event.source = WIRELESS_SOURCE_WIFI;
             break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            _wifiLastReason = info.wifi_sta_disconnected.reason;
+            if (!_wifiLinkUp) return;
+            _wifiLinkUp = false;
+            _wirelessMetricAdd(WIRELESS_METRIC_WIFI_DISCONNECTS);
+            event.type = WIRELESS_EVENT_LINK_DOWN;
+            event.source = WIRELESS_SOURCE_WIFI;
+            event.address = info.wifi_sta_disconnected.bssid;
+            break;
+        case ARDUINO_EVENT_WIFI_AP_STACONNECTED:
+            _wifiAPJoin(info.wifi_ap_staconnected.mac, info.wifi_ap_staconnected.aid);
+            event.type = WIRELESS_EVENT_STATION_JOINED;
+            event.source = WIRELESS_SOURCE_AP;
+            event.id = info.wifi_ap_staconnected.aid;
+            event.address = info.wifi_ap_staconnected.mac;
+            break;
+        case ARDUINO_EVENT_WIFI_AP_STADISCONNECTED:
+            event.type = WIRELESS_EVENT_STATION_LEFT;
+            event.source = WIRELESS_SOURCE_AP;
+            event.id = info.wifi_ap_stadisconnected.aid;
+            event.address = info.wifi_ap_stadisconnected.mac;
+            leaving = true;
+            break;
+        case ARDUINO_EVENT_WIFI_AP_STAIPASSIGNED:
+            if (!_wifiAPAssignIP(info, mac)) return;
+            event.type = WIRELESS_EVENT_STATION_IP;
+            event.source = WIRELESS_SOURCE_AP;
+            event.address = mac;
+            break;
+        default:
+            return;
+    }
+    Wireless_emit(event);
+    
+    // 監聽函式執行完才移除，讓站台回調函式仍能取得離開站台的資料
+    if (leaving) {
+        _wifiAPLeave(info.wifi_ap_stadisconnected.mac);
+    }
+}
+
+/**
+ * 註冊 WiFi 事件處理 (只註冊一次)
+ */
+static void _wifiRegisterEvents() {
+    if (_wifiEventsRegistered) return;
+    WiFi.onEvent(_wifiOnStaConnected, ARDUINO_EVENT_WIFI_STA_CONNECTED);
+    WiFi.onEvent(_wifiOnLinkEvent, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    WiFi.onEvent(_wifiOnLinkEvent, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    WiFi.onEvent(_wifiOnLinkEvent, ARDUINO_EVENT_WIFI_AP_STACONNECTED);
+    WiFi.onEvent(_wifiOnLinkEvent, ARDUINO_EVENT_WIFI_AP_STADISCONNECTED);
+    WiFi.onEvent(_wifiOnLinkEvent, ARDUINO_EVENT_WIFI_AP_STAIPASSIGNED);
+    _wifiEventsRegistered = true;
+}
+
+// 快速重連快取，存放於RTC記憶體，深度睡眠後仍保留
+#define WIFI_FAST_CACHE_MAGIC 0x57464331UL
+
+typedef struct {
+    uint32_t magic;
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t channel;
+    bool hasLease;      // 是否保存了可重用的IP設定
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns1;
+    uint32_t dns2;
+    uint32_t checksum;
+} WifiFastCache;
+
+RTC_DATA_ATTR static WifiFastCache _wifiFastCache;
+
+static bool _wifiFastReconnect = false;
+static bool _wifiReuseLease = false;
+static unsigned long _wifiFastTimeoutMs = 3000;
+static bool _wifiFastPath = false;      // 目前是否正在走快速重連路徑
+static bool _wifiLeaseApplied = false;  // 快速路徑是否套用了快取的IP設定
+static bool _wifiIPConfigured = false;  // 介面上是否仍有先前套用的固定IP設定 (靜態IP或快取的租約)
+static unsigned long _wifiConnectStart = 0;
+static unsigned long _wifiScanStart = 0;
+static WifiConnectTiming _wifiTiming = {WIFI_PATH_NONE, 0, 0, 0};
+
+static uint32_t _wifiFastCacheChecksum(const WifiFastCache& cache) {
+    // FNV-1a，涵蓋 checksum 欄位之前的所有位元組
+    const uint8_t* data = (const uint8_t*)&cache;
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < offsetof(WifiFastCache, checksum); i++) {
+        hash = (hash ^ data[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+/**
+ * 檢查快取是否有效且屬於本次的候選網路
+ * @return 對應的候選索引，無效時返回-1
+ */
+static int _wifiFastCacheCandidate() {
+    if (_wifiFastCache.magic != WIFI_FAST_CACHE_MAGIC ||
+        _wifiFastCache.checksum != _wifiFastCacheChecksum(_wifiFastCache)) {
+        return -1;
+    }
+    for (int i = 0; i < _wifiActiveCount; i++) {
+        if (strcmp(_wifiFastCache.ssid, _wifiActive[i].ssid) == 0) {
+            return i;
         }
     }
+    return -1;
+}
+
+static void _wifiFastCacheSave() {
+    memset(&_wifiFastCache, 0, sizeof(_wifiFastCache));
+    strcpy(_wifiFastCache.ssid, _wifiSsid);
     
-    // 清理掃描結果
-    WiFi.scanDelete();
+    uint8_t* bssid = WiFi.BSSID();
+    if (bssid == NULL) {
+        return;
+    }
+    memcpy(_wifiFastCache.bssid, bssid, sizeof(_wifiFastCache.bssid));
+    _wifiFastCache.channel = WiFi.channel();
+    
+    // 使用者指定的靜態IP不需快取
+    if (!_wifiUseStaticIP) {
+        _wifiFastCache.hasLease = true;
+        _wifiFastCache.ip = WiFi.localIP();
+        _wifiFastCache.gateway = WiFi.gatewayIP();
+        _wifiFastCache.subnet = WiFi.subnetMask();
+        _wifiFastCache.dns1 = WiFi.dnsIP(0);
+        _wifiFastCache.dns2 = WiFi.dnsIP(1);
+    }
+    
+    _wifiFastCache.magic = WIFI_FAST_CACHE_MAGIC;
+    _wifiFastCache.checksum = _wifiFastCacheChecksum(_wifiFastCache);
+}
+
+/**
+ * 解析並套用靜態IP設定
+ * @return 設定是否成功 (未提供靜態IP時直接返回true)
+ */
+static bool _wifiApplyStaticIP(
+    const char* staticIP, const char* gateway, const char* subnet,
+    const char* dns1, const char* dns2, bool silentMode
+){
+    // 確定是否使用靜態IP
+    if (staticIP == NULL || strlen(staticIP) == 0) {
+        return true;
+    }
     
-    // 如果沒有找到匹配的SSID，返回false
-    if (!foundNetwork) {
+    // 檢查必須的參數是否都提供了
+    if (gateway == NULL || strlen(gateway) == 0 || subnet == NULL || strlen(subnet) == 0) {
         if (!silentMode) {
-            Serial.println();
-            Serial.println("找不到 " + String(ssid));
+            WM_LOGE("使用靜態IP時，必須提供閘道和子網掩碼!");
         }
         return false;
     }
     
-    // 確定是否使用靜態IP
-    bool useStaticIP = (staticIP != NULL && strlen(staticIP) > 0);
+    // 將字串轉換為IPAddress對象
+    IPAddress ip, gw, sn, dns1IP, dns2IP;
+    if (!ip.fromString(staticIP)) {
+        if (!silentMode) {
+            WM_LOGE("靜態IP格式無效!");
+        }
+        return false;
+    }
     
-    if (!silentMode) {
-        Serial.print("正在連接到: " + String(ssid));
-        if (useStaticIP) {
-            Serial.println(" (使用靜態IP)");
-        } else {
-            Serial.println(" (使用DHCP)");
+    if (!gw.fromString(gateway)) {
+        if (!silentMode) {
+            WM_LOGE("閘道地址格式無效!");
         }
+        return false;
     }
     
-    // 如果提供了靜態IP，就配置靜態IP
-    if (useStaticIP) {
-        // 檢查必須的參數是否都提供了
-        if (gateway == NULL || strlen(gateway) == 0 || subnet == NULL || strlen(subnet) == 0) {
+    if (!sn.fromString(subnet)) {
+        if (!silentMode) {
+            WM_LOGE("子網掩碼格式無效!");
+        }
+        return false;
+    }
+    
+    // 如果提供了DNS，則轉換它們
+    if (dns1 != NULL && strlen(dns1) > 0) {
+        if (!dns1IP.fromString(dns1)) {
             if (!silentMode) {
-                Serial.println("使用靜態IP時，必須提供閘道和子網掩碼!");
+                WM_LOGE("DNS1格式無效!");
             }
             return false;
         }
-        
-        // 將字串轉換為IPAddress對象
-        IPAddress ip, gw, sn, dns1IP, dns2IP;
-        if (!ip.fromString(staticIP)) {
+    }
+    
+    if (dns2 != NULL && strlen(dns2) > 0) {
+        if (!dns2IP.fromString(dns2)) {
             if (!silentMode) {
-                Serial.println("靜態IP格式無效!");
+                WM_LOGE("DNS2格式無效!");
             }
             return false;
         }
+    }
+    
+    // 配置靜態IP
+    if (!WiFi.config(ip, gw, sn, dns1IP, dns2IP)) {
+        if (!silentMode) {
+            WM_LOGE("靜態IP配置失敗!");
+        }
+        return false;
+    }
+    _wifiIPConfigured = true;
+    return true;
+}
+
+/**
+ * 清除先前套用的靜態IP或快取租約，恢復使用DHCP
+ * WiFi.config 的設定會保留到下一次連線，未使用靜態IP的連線開始前都需清除
+ */
+static void _wifiRestoreDhcp() {
+    if (!_wifiIPConfigured) {
+        return;
+    }
+    // 全為0的設定會恢復使用DHCP
+    WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+    _wifiIPConfigured = false;
+    _wifiLeaseApplied = false;
+}
+
+/**
+ * 切換連線狀態，進入終止狀態時觸發完成回調
+ */
+static void _wifiSetState(WifiConnState state) {
+    _wifiConnState = state;
+    
+    if (state == WIFI_CONN_CONNECTED || state == WIFI_CONN_FAILED) {
+        unsigned long now = millis();
+        if (_wifiFastPath) {
+            _wifiTiming.path = WIFI_PATH_FAST;
+            _wifiTiming.fastPathMs = now - _wifiConnectStart;
+        } else {
+            _wifiTiming.path = WIFI_PATH_SCAN;
+            _wifiTiming.scanPathMs = now - _wifiScanStart;
+        }
+        _wifiTiming.totalMs = now - _wifiConnectStart;
         
-        if (!gw.fromString(gateway)) {
-            if (!silentMode) {
-                Serial.println("閘道地址格式無效!");
-            }
-            return false;
+        if (state == WIFI_CONN_CONNECTED) {
+            _wirelessMetricAdd(WIRELESS_METRIC_WIFI_CONNECTS);
+            _wirelessMetricLatency(WIRELESS_HIST_WIFI_CONNECT, _wifiTiming.totalMs * 1000UL);
+            _wirelessMetricRssi(WiFi.RSSI());
+        } else {
+            _wirelessMetricAdd(WIRELESS_METRIC_WIFI_CONNECT_FAILURES);
         }
         
-        if (!sn.fromString(subnet)) {
-            if (!silentMode) {
-                Serial.println("子網掩碼格式無效!");
+        if (_wifiConnectCallback != NULL) {
+            _wifiConnectCallback(state);
+        }
+    }
+}
+
+/**
+ * 開始非同步掃描 (完整掃描路徑)
+ * @return 是否成功啟動掃描
+ */
+static bool _wifiStartScan() {
+    if (!_wifiSilentMode) {
+        WM_LOGI("正在掃描WiFi網路...");
+    }
+    
+    // 以非同步方式掃描，結果由 Wifi_poll() 取回
+    Wifi_scanCancel();
+    if (!Wifi_scanStart(_wifiConnectScanConfig)) {
+        if (!_wifiSilentMode) {
+            WM_LOGW("啟動WiFi掃描失敗");
+        }
+        return false;
+    }
+    _wifiFastPath = false;
+    _wifiScanStart = millis();
+    _wifiSetState(WIFI_CONN_SCANNING);
+    return true;
+}
+
+/**
+ * 設定 STA 並開始與指定的AP關聯
+ * WiFi.begin 會以 listen_interval 為 0 的新設定取代目前的設定，
+ * 因此先不關聯，套用省電設定的 listen interval 後才開始關聯
+ */
+static void _wifiBeginSta(uint8_t channel, const uint8_t* bssid) {
+    WiFi.begin(_wifiSsid, _wifiPassword, channel, bssid, false);
+    _wifiApplyListenInterval();
+    esp_wifi_connect();
+}
+
+/**
+ * 以快取的 BSSID 與頻道直接關聯，略過掃描 (快速重連路徑)
+ */
+static void _wifiStartFastPath() {
+    if (!_wifiSilentMode) {
+        WM_LOGI("快速重連到: %s (頻道 %u)", _wifiSsid, _wifiFastCache.channel);
+    }
+    
+    // 重用上次的IP設定以略過DHCP
+    _wifiLeaseApplied = false;
+    if (_wifiReuseLease && !_wifiUseStaticIP && _wifiFastCache.hasLease) {
+        _wifiLeaseApplied = WiFi.config(
+            IPAddress(_wifiFastCache.ip), IPAddress(_wifiFastCache.gateway),
+            IPAddress(_wifiFastCache.subnet), IPAddress(_wifiFastCache.dns1),
+            IPAddress(_wifiFastCache.dns2)
+        );
+        _wifiIPConfigured = _wifiLeaseApplied;
+    }
+    
+    _wifiFastPath = true;
+    _wifiAssociated = false;
+    _wifiBeginSta(_wifiFastCache.channel, _wifiFastCache.bssid);
+    _wifiBeginTime = millis();
+    _wifiSetState(WIFI_CONN_ASSOCIATING);
+}
+
+/**
+ * 快速重連失敗，清除快取並退回完整掃描路徑
+ */
+static void _wifiFallbackToScan() {
+    _wifiTiming.fastPathMs = millis() - _wifiConnectStart;
+    _wifiFastCache.magic = 0;
+    
+    if (!_wifiSilentMode) {
+        WM_LOGW("快速重連失敗，改用完整掃描");
+    }
+    
+    WiFi.disconnect();
+    if (_wifiLeaseApplied) {
+        _wifiRestoreDhcp();
+    }
+    
+    _wifiFastPath = false;
+    _wifiScanStart = millis();
+    if (!_wifiStartScan()) {
+        _wifiSetState(WIFI_CONN_FAILED);
+    }
+}
+
+/**
+ * 將掃描到的AP插入排序清單 (優先級高者在前，同優先級依信號強度)
+ * 清單已滿時捨棄排名最後者
+ */
+static void _wifiRankInsert(const WifiRankedAP& ap) {
+    int pos = _wifiRankedCount;
+    while (pos > 0) {
+        const WifiRankedAP& prev = _wifiRanked[pos - 1];
+        if (prev.priority > ap.priority ||
+            (prev.priority == ap.priority && prev.rssi >= ap.rssi)) {
+            break;
+        }
+        pos--;
+    }
+    if (pos >= WIFI_MAX_RANKED) {
+        return;
+    }
+    
+    int last = (_wifiRankedCount < WIFI_MAX_RANKED) ? _wifiRankedCount : WIFI_MAX_RANKED - 1;
+    for (int i = last; i > pos; i--) {
+        _wifiRanked[i] = _wifiRanked[i - 1];
+    }
+    _wifiRanked[pos] = ap;
+    if (_wifiRankedCount < WIFI_MAX_RANKED) {
+        _wifiRankedCount++;
+    }
+}
+
+/**
+ * 與排序清單中的指定項目關聯
+ */
+static void _wifiTryRanked(int index) {
+    const WifiRankedAP& ap = _wifiRanked[index];
+    const WifiCandidate& candidate = _wifiActive[ap.candidate];
+    _wifiRankedIndex = index;
+    strcpy(_wifiSsid, candidate.ssid);
+    strcpy(_wifiPassword, candidate.password);
+    
+    if (!_wifiSilentMode) {
+        WM_LOGI("正在連接到: %s [" WM_MAC_FMT ", 頻道 %u] (%s)",
+                _wifiSsid, WM_MAC_ARGS(ap.bssid), ap.channel,
+                _wifiUseStaticIP ? "使用靜態IP" : "使用DHCP");
+    }
+    
+    // 指定 BSSID 與頻道，連到排名最佳的AP而非由驅動程式自行挑選，逾時從此刻起算
+    _wifiAssociated = false;
+    _wifiBeginSta(ap.channel, ap.bssid);
+    _wifiBeginTime = millis();
+    _wifiSetState(WIFI_CONN_ASSOCIATING);
+}
+
+/**
+ * 掃描完成後將符合候選的AP排序，並與排名最佳者關聯
+ */
+static void _wifiHandleScanResult(int networkCount) {
+    _wifiRankedCount = 0;
+    _wifiRankedIndex = -1;
+    
+    if (networkCount <= 0) {
+        if (!_wifiSilentMode) {
+            WM_LOGW("- 未找到WiFi網路 -");
+        }
+        _wifiSetState(WIFI_CONN_FAILED);
+        return;
+    }
+    
+    // 單次掃描中找出所有符合候選SSID的AP
+    const WifiScanResult* results = Wifi_scanResults(NULL);
+    for (int i = 0; i < networkCount; i++) {
+        const WifiScanResult& found = results[i];
+        for (int c = 0; c < _wifiActiveCount; c++) {
+            if (strcmp(found.ssid, _wifiActive[c].ssid) != 0) {
+                continue;
             }
-            return false;
+            WifiRankedAP ap;
+            ap.candidate = c;
+            ap.priority = _wifiActive[c].priority;
+            ap.rssi = found.rssi;
+            ap.channel = found.channel;
+            memcpy(ap.bssid, found.bssid, sizeof(ap.bssid));
+            _wifiRankInsert(ap);
+            
+            if (!_wifiSilentMode) {
+                WM_LOGI("找到 %s (信號強度: %d dBm)", _wifiActive[c].ssid, ap.rssi);
+            }
+            break;
         }
-        
-        // 如果提供了DNS，則轉換它們
-        if (dns1 != NULL && strlen(dns1) > 0) {
-            if (!dns1IP.fromString(dns1)) {
-                if (!silentMode) {
-                    Serial.println("DNS1格式無效!");
+    }
+    
+    // 如果沒有找到任何候選SSID，連線失敗
+    if (_wifiRankedCount == 0) {
+        if (!_wifiSilentMode) {
+            WM_LOGW("找不到 %s", _wifiActiveCount == 1 ? _wifiActive[0].ssid : "任何候選網路");
+        }
+        _wifiSetState(WIFI_CONN_FAILED);
+        return;
+    }
+    
+    _wifiTryRanked(0);
+}
+
+/**
+ * 依目前的候選清單開始連線流程，有可用的快取時先嘗試快速重連
+ */
+static bool _wifiBeginConnect(WifiConnectCallback callback, int timeoutSeconds, bool silentMode) {
+    // 取消尚未完成的掃描
+    if (_wifiConnState == WIFI_CONN_SCANNING) {
+        Wifi_scanCancel();
+    }
+    
+    _wifiRegisterEvents();
+    
+    // 協定與 listen interval 只能在關聯前變更
+    if (_wifiPowerActive()) {
+        WiFi.enableSTA(true);
+        _wifiApplyPower(true);
+    }
+    
+    // 上一次連線套用的靜態IP或快取租約仍在介面上，改用DHCP時需先清除
+    if (!_wifiUseStaticIP) {
+        _wifiRestoreDhcp();
+    }
+    
+    _wifiConnectCallback = callback;
+    _wifiSilentMode = silentMode;
+    _wifiTimeoutMs = (unsigned long)timeoutSeconds * 1000;
+    _wifiConnState = WIFI_CONN_IDLE;
+    
+    _wifiTiming.path = WIFI_PATH_NONE;
+    _wifiTiming.fastPathMs = 0;
+    _wifiTiming.scanPathMs = 0;
+    _wifiTiming.totalMs = 0;
+    _wifiFastPath = false;
+    _wifiConnectStart = millis();
+    
+    // 候選清單可能已變更，舊的排序不再有效
+    _wifiRankedCount = 0;
+    _wifiRankedIndex = -1;
+    
+    // 有可用的快取時先嘗試快速重連，失敗再退回完整掃描
+    int cached = _wifiFastReconnect ? _wifiFastCacheCandidate() : -1;
+    if (cached >= 0) {
+        strcpy(_wifiSsid, _wifiActive[cached].ssid);
+        strcpy(_wifiPassword, _wifiActive[cached].password);
+        _wifiStartFastPath();
+        return true;
+    }
+    return _wifiStartScan();
+}
+
+/**
+ * 非阻塞地開始連接到指定的 WiFi 網路，之後需定期呼叫 Wifi_poll() 推進連線流程
+ * @param ssid WiFi 網路名稱
+ * @param password WiFi 密碼
+ * @param callback 連線完成(成功或失敗)時呼叫的回調函式，可為NULL
+ * @param timeoutSeconds 關聯與取得IP的最長等待時間(秒)
+ * @param silentMode 是否靜默連接
+ * @param staticIP 靜態IP地址 (可選，格式如 "192.168.1.100")
+ * @param gateway 閘道地址 (可選，使用靜態IP時必須提供)
+ * @param subnet 子網掩碼 (可選，使用靜態IP時必須提供)
+ * @param dns1 主要DNS伺服器 (可選)
+ * @param dns2 次要DNS伺服器 (可選)
+ * @return 是否成功開始連線流程
+ */
+bool Wifi_connectAsync(
+    const char* ssid,
+    const char* password,
+    WifiConnectCallback callback,
+    int timeoutSeconds,
+    bool silentMode,
+    const char* staticIP,
+    const char* gateway,
+    const char* subnet,
+    const char* dns1,
+    const char* dns2
+){
+    WifiLock lock;
+    if (ssid == NULL || strlen(ssid) == 0 || strlen(ssid) >= sizeof(_wifiSsid)) {
+        if (!silentMode) {
+            WM_LOGE("WiFi SSID無效!");
+        }
+        return false;
+    }
+    if (password != NULL && strlen(password) >= sizeof(_wifiPassword)) {
+        if (!silentMode) {
+            WM_LOGE("WiFi 密碼過長!");
+        }
+        return false;
+    }
+    
+    _wifiUseStaticIP = (staticIP != NULL && strlen(staticIP) > 0);
+    if (!_wifiApplyStaticIP(staticIP, gateway, subnet, dns1, dns2, silentMode)) {
+        return false;
+    }
+    
+    strcpy(_wifiSingleCandidate.ssid, ssid);
+    strcpy(_wifiSingleCandidate.password, password != NULL ? password : "");
+    _wifiSingleCandidate.priority = 0;
+    _wifiActive = &_wifiSingleCandidate;
+    _wifiActiveCount = 1;
+    
+    return _wifiBeginConnect(callback, timeoutSeconds, silentMode);
+}
+
+/**
+ * 推進非阻塞連線流程，此函式應在主迴圈中定期呼叫，每次呼叫都會立即返回
+ * @return 目前的連線狀態
+ */
+WifiConnState Wifi_poll() {
+    WifiLock lock;
+    switch (_wifiConnState) {
+        case WIFI_CONN_SCANNING: {
+            int result = Wifi_scanPoll();
+            if (result == WIFI_SCAN_RUNNING) {
+                break;
+            }
+            if (result == WIFI_SCAN_FAILED) {
+                if (!_wifiSilentMode) {
+                    WM_LOGW("WiFi掃描失敗");
                 }
-                return false;
+                _wifiSetState(WIFI_CONN_FAILED);
+                break;
             }
+            _wifiHandleScanResult(result);
+            break;
         }
         
-        if (dns2 != NULL && strlen(dns2) > 0) {
-            if (!dns2IP.fromString(dns2)) {
-                if (!silentMode) {
-                    Serial.println("DNS2格式無效!");
+        case WIFI_CONN_ASSOCIATING:
+        case WIFI_CONN_DHCP: {
+            if (WiFi.status() == WL_CONNECTED) {
+                if (!_wifiSilentMode) {
+                    IPAddress ip = WiFi.localIP();
+                    uint8_t mac[6];
+                    WiFi.macAddress(mac);
+                    
+                    WM_LOGI(WM_SEPARATOR);
+                    WM_LOGI("- %s 連接成功！", _wifiSsid);
+                    WM_LOGI("- IP: " WM_IP_FMT, WM_IP_ARGS(ip));
+                    WM_LOGI("- MAC: " WM_MAC_FMT, WM_MAC_ARGS(mac));
+                    WM_LOGI("- RSSI: %d dBm", WiFi.RSSI());
+                    WM_LOGI(WM_SEPARATOR);
                 }
-                return false;
+                // 更新快速重連快取
+                if (_wifiFastReconnect) {
+                    _wifiFastCacheSave();
+                }
+                
+                _wifiSetState(WIFI_CONN_CONNECTED);
+                break;
+            }
+            
+            // 已關聯但尚未取得IP，進入DHCP階段
+            if (_wifiConnState == WIFI_CONN_ASSOCIATING && _wifiAssociated) {
+                _wifiSetState(WIFI_CONN_DHCP);
             }
+            
+            if (_wifiFastPath) {
+                if (millis() - _wifiBeginTime >= _wifiFastTimeoutMs) {
+                    _wifiFallbackToScan();
+                }
+                break;
+            }
+            
+            if (millis() - _wifiBeginTime >= _wifiTimeoutMs) {
+                // 依排序切換到下一個AP，不需重新掃描
+                if (_wifiRankedIndex + 1 < _wifiRankedCount) {
+                    if (!_wifiSilentMode) {
+                        WM_LOGW("連接逾時，嘗試下一個AP");
+                    }
+                    WiFi.disconnect();
+                    _wifiTryRanked(_wifiRankedIndex + 1);
+                    break;
+                }
+                if (!_wifiSilentMode) {
+                    WM_LOGW("- WiFi 連接失敗 -");
+                }
+                _wifiSetState(WIFI_CONN_FAILED);
+            }
+            break;
         }
         
-        // 配置靜態IP
-        if (!WiFi.config(ip, gw, sn, dns1IP, dns2IP)) {
-            if (!silentMode) {
-                Serial.println("靜態IP配置失敗!");
-            }
-            return false;
+        default:
+            break;
+    }
+    
+    return _wifiConnState;
+}
+
+/**
+ * 以阻塞方式推進狀態機，直到連線成功或失敗
+ * 每次 Wifi_poll 各自持有鎖，服務任務同時推進時兩者依序執行，等待期間不佔用鎖
+ */
+static bool _wifiWaitForConnect() {
+    WifiConnState state = Wifi_poll();
+    
+    while (state != WIFI_CONN_CONNECTED && state != WIFI_CONN_FAILED) {
+        delay(10);
+        state = Wifi_poll();
+    }
+    
+    return state == WIFI_CONN_CONNECTED;
+}
+
+/**
+ * 新增或更新候選網路，供 Wifi_connectBest() 由單次掃描中挑選最佳AP
+ * @param ssid WiFi 網路名稱 (已存在時更新其密碼與優先級)
+ * @param password WiFi 密碼
+ * @param priority 優先級，數值越大越優先；同優先級時選擇信號較強者
+ * @return 是否成功加入
+ */
+bool Wifi_addCandidate(const char* ssid, const char* password, int priority) {
+    WifiLock lock;
+    if (ssid == NULL || strlen(ssid) == 0 || strlen(ssid) >= sizeof(_wifiCandidates[0].ssid)) {
+        return false;
+    }
+    if (password != NULL && strlen(password) >= sizeof(_wifiCandidates[0].password)) {
+        return false;
+    }
+    
+    int index = _wifiCandidateCount;
+    for (int i = 0; i < _wifiCandidateCount; i++) {
+        if (strcmp(_wifiCandidates[i].ssid, ssid) == 0) {
+            index = i;
+            break;
+        }
+    }
+    if (index >= WIFI_MAX_CANDIDATES) {
+        return false;
+    }
+    
+    strcpy(_wifiCandidates[index].ssid, ssid);
+    strcpy(_wifiCandidates[index].password, password != NULL ? password : "");
+    _wifiCandidates[index].priority = priority;
+    if (index == _wifiCandidateCount) {
+        _wifiCandidateCount++;
+    }
+    return true;
+}
+
+/**
+ * 清除所有候選網路
+ */
+void Wifi_clearCandidates() {
+    WifiLock lock;
+    _wifiCandidateCount = 0;
+}
+
+/**
+ * 非阻塞地連接到候選網路中排名最佳的AP，之後需定期呼叫 Wifi_poll()
+ * 單次掃描即排序所有符合的 BSSID，關聯逾時會依序切換到下一個AP
+ * @param callback 連線完成(成功或失敗)時呼叫的回調函式，可為NULL
+ * @param timeoutSeconds 每個AP關聯與取得IP的最長等待時間(秒)
+ * @param silentMode 是否靜默連接
+ * @return 是否成功開始連線流程
+ */
+bool Wifi_connectBestAsync(WifiConnectCallback callback, int timeoutSeconds, bool silentMode) {
+    WifiLock lock;
+    if (_wifiCandidateCount == 0) {
+        if (!silentMode) {
+            WM_LOGE("未設定任何候選網路!");
         }
+        return false;
+    }
+    
+    _wifiUseStaticIP = false;
+    _wifiActive = _wifiCandidates;
+    _wifiActiveCount = _wifiCandidateCount;
+    
+    return _wifiBeginConnect(callback, timeoutSeconds, silentMode);
+}
+
+/**
+ * 連接到候選網路中排名最佳的AP (阻塞直到成功或全部失敗)
+ * @param timeoutSeconds 每個AP關聯與取得IP的最長等待時間(秒)
+ * @param silentMode 是否靜默連接
+ * @return 連接結果 (true: 成功, false: 失敗)
+ */
+bool Wifi_connectBest(int timeoutSeconds, bool silentMode) {
+    if (!Wifi_connectBestAsync(NULL, timeoutSeconds, silentMode)) {
+        return false;
+    }
+    return _wifiWaitForConnect();
+}
+
+/**
+ * 切換到上次掃描排序清單中的下一個AP，不重新掃描
+ * 適用於連線中斷後的快速故障轉移，之後需定期呼叫 Wifi_poll()
+ * @param callback 連線完成(成功或失敗)時呼叫的回調函式，可為NULL
+ * @return 是否還有可切換的AP
+ */
+bool Wifi_failover(WifiConnectCallback callback) {
+    WifiLock lock;
+    if (_wifiActive == NULL || _wifiRankedIndex + 1 >= _wifiRankedCount) {
+        return false;
+    }
+    
+    _wifiConnectCallback = callback;
+    _wifiFastPath = false;
+    _wifiConnectStart = millis();
+    _wifiScanStart = _wifiConnectStart;
+    _wifiTiming.path = WIFI_PATH_NONE;
+    _wifiTiming.fastPathMs = 0;
+    _wifiTiming.scanPathMs = 0;
+    _wifiTiming.totalMs = 0;
+    
+    WiFi.disconnect();
+    _wifiTryRanked(_wifiRankedIndex + 1);
+    return true;
+}
+
+/**
+ * 取得上次掃描排序清單的項目數
+ */
+int Wifi_getRankedCount() {
+    WifiLock lock;
+    return _wifiRankedCount;
+}
+
+/**
+ * 取得上次掃描排序清單中的指定項目
+ * @param index 排名 (0為最佳)
+ * @param ap 輸出的AP資訊
+ * @return 索引是否有效
+ */
+bool Wifi_getRanked(int index, WifiRankedAP &ap) {
+    WifiLock lock;
+    if (index < 0 || index >= _wifiRankedCount) {
+        return false;
+    }
+    ap = _wifiRanked[index];
+    return true;
+}
+
+/**
+ * 設定連線流程使用的掃描參數，例如只掃描已知的頻道以縮短掃描時間
+ * @param config 掃描設定
+ */
+void Wifi_setConnectScanConfig(const WifiScanConfig &config) {
+    WifiLock lock;
+    _wifiConnectScanConfig = config;
+}
+
+/**
+ * 設定快速重連模式
+ * 啟用後，連線成功時會將 BSSID、頻道與IP設定保存於RTC記憶體，
+ * 下次連線(包含深度睡眠喚醒後)直接以 WiFi.begin(ssid, pass, channel, bssid) 關聯，失敗才退回完整掃描
+ * @param enable 是否啟用
+ * @param reuseLease 是否重用上次取得的IP設定以略過DHCP (需確保租約尚未被其他設備取得)
+ * @param fastTimeoutMs 快速路徑的最長等待時間(毫秒)，逾時即退回完整掃描
+ */
+void Wifi_setFastReconnect(bool enable, bool reuseLease, unsigned long fastTimeoutMs) {
+    WifiLock lock;
+    _wifiFastReconnect = enable;
+    _wifiReuseLease = reuseLease;
+    _wifiFastTimeoutMs = fastTimeoutMs;
+}
+
+/**
+ * 清除快速重連快取，下次連線將執行完整掃描
+ */
+void Wifi_clearFastReconnect() {
+    WifiLock lock;
+    _wifiFastCache.magic = 0;
+}
+
+/**
+ * 取得最近一次連線的路徑與耗時
+ * @param timing 輸出的耗時資訊
+ * @return 是否已有完成的連線紀錄
+ */
+bool Wifi_getConnectTiming(WifiConnectTiming &timing) {
+    WifiLock lock;
+    timing = _wifiTiming;
+    return _wifiConnState == WIFI_CONN_CONNECTED || _wifiConnState == WIFI_CONN_FAILED;
+}
+
+/**
+ * 連接到指定的 WiFi 網路，可選擇使用靜態IP
+ * @param ssid WiFi 網路名稱
+ * @param password WiFi 密碼
+ * @param silentMode 是否靜默連接
+ * @param timeoutSeconds WiFi連接的最長等待時間(秒)
+ * @param staticIP 靜態IP地址 (可選，格式如 "192.168.1.100")
+ * @param gateway 閘道地址 (可選，使用靜態IP時必須提供)
+ * @param subnet 子網掩碼 (可選，使用靜態IP時必須提供)
+ * @param dns1 主要DNS伺服器 (可選)
+ * @param dns2 次要DNS伺服器 (可選)
+ * @return 連接結果 (true: 成功, false: 失敗)
+ */
+bool Wifi_connect(
+    const char* ssid,
+    const char* password,
+    int timeoutSeconds,
+    bool silentMode,
+    const char* staticIP,
+    const char* gateway,
+    const char* subnet,
+    const char* dns1,
+    const char* dns2
+){
+    if (!Wifi_connectAsync(ssid, password, NULL, timeoutSeconds, silentMode,
+                           staticIP, gateway, subnet, dns1, dns2)) {
+        return false;
     }
     
-    // 開始連接 WiFi
-    WiFi.begin(ssid, password);
-    
-    // 等待連接，設置超時
-    int attempts = 0;
-    const int delayMs = 500; // 每次延遲的毫秒數
-    const int maxAttempts = timeoutSeconds * 1000 / delayMs; // 將秒轉換為嘗試次數
-    
-    while (WiFi.status() != WL_CONNECTED && attempts < maxAttempts) {
-        delay(delayMs);
-        attempts++;
-        if (!silentMode) {
-            Serial.print(".");
-            if (attempts % 10 == 0) {
-                Serial.println();
-            }
-        }
+    return _wifiWaitForConnect();
+}
+
+/**
+ * 取得WiFi連線資訊，不配置堆積記憶體，可於迴圈中高頻率呼叫
+ * @param info 輸出的連線資訊
+ * @return 是否已連接
+ */
+bool Wifi_getInfo(WifiInfo &info) {
+    memset(&info, 0, sizeof(info));
+    info.status = WiFi.status();
+    info.connected = info.status == WL_CONNECTED;
+    info.lastReason = _wifiLastReason;
+    WiFi.macAddress(info.mac);
+    if (!info.connected) {
+        return false;
     }
     
-    if (WiFi.status() == WL_CONNECTED) {
-        if (!silentMode) {
-            // 格式化要顯示的資訊
-            String ipStr = "- IP: " + WiFi.localIP().toString();
-            String macStr = "- MAC: " + WiFi.macAddress();
-            String rssiStr = "- RSSI: " + String(WiFi.RSSI()) + " dBm";
-            String titleStr = "- " + WiFi.SSID() + " 連接成功！";
-            
-            // 使用固定長度分隔線，不再動態生成
-            const char* separatorLine = "--------------------------------";
-            
-            // 輸出資訊
-            Serial.println();
-            Serial.println(separatorLine);
-            Serial.println(titleStr);
-            Serial.println(ipStr);
-            Serial.println(macStr);
-            Serial.println(rssiStr);
-            Serial.println(separatorLine);
-        }
-        return true;
-    } else {
-        if (!silentMode) {
-            Serial.println();
-            Serial.println("- WiFi 連接失敗 -");
-        }
-        return false;
+    // 一次取得 SSID、BSSID、頻道與信號強度 (WiFi.RSSI() 內部也是呼叫此函式)
+    wifi_ap_record_t apInfo;
+    if (esp_wifi_sta_get_ap_info(&apInfo) == ESP_OK) {
+        memcpy(info.ssid, apInfo.ssid, sizeof(info.ssid) - 1);
+        memcpy(info.bssid, apInfo.bssid, 6);
+        info.channel = apInfo.primary;
+        info.rssi = apInfo.rssi;
     }
+    info.ip = WiFi.localIP();
+    info.subnet = WiFi.subnetMask();
+    info.gateway = WiFi.gatewayIP();
+    info.dns = WiFi.dnsIP();
+    info.uptimeMs = _wifiLinkUp ? millis() - _wifiLinkUpAt : 0;
+    return true;
 }
 
 /**
@@ -201,21 +1229,20 @@ bool Wifi_connect(
  * @return WiFi狀態代碼 (WL_CONNECTED=3表示已連接) 
  */
 byte Wifi_checkStatus(bool silentMode) {
-    // 取得目前WiFi狀態
-    byte status = WiFi.status();
-    
     // 如果是靜默模式，直接返回狀態碼
     if (silentMode) {
-        return status;
+        return WiFi.status();
     }
     
+    WifiInfo info;
+    Wifi_getInfo(info);
+    
     // 非靜默模式，顯示狀態資訊
-    Serial.println();
-    Serial.println("----------- WiFi 狀態 -----------");
+    WM_LOGI("----------- WiFi 狀態 -----------");
     
     // 根據狀態碼顯示對應的文字說明
-    String statusText = "";
-    switch (status) {
+    const char* statusText;
+    switch (info.status) {
         case WL_CONNECTED:
             statusText = "已連接";
             break;
@@ -241,28 +1268,247 @@ byte Wifi_checkStatus(bool silentMode) {
             statusText = "未連接";
             break;
         default:
-            statusText = "未知狀態 (" + String(status) + ")";
+            statusText = "未知狀態";
     }
     
-    Serial.println("- 狀態: " + statusText);
+    WM_LOGI("- 狀態: %s (%u)", statusText, info.status);
     
     // 如果已連接，則顯示詳細資訊
-    if (status == WL_CONNECTED) {
-        // 基本連接資訊
-        Serial.println("- SSID: " + WiFi.SSID());
-        Serial.println("- 信號強度 (RSSI): " + String(WiFi.RSSI()) + " dBm");
-        Serial.println("- MAC 地址: " + WiFi.macAddress());
-        Serial.println("- IP 地址: " + WiFi.localIP().toString());
-        Serial.println("- 子網掩碼: " + WiFi.subnetMask().toString());
-        Serial.println("- 閘道: " + WiFi.gatewayIP().toString());
-        Serial.println("- DNS: " + WiFi.dnsIP().toString());
-        Serial.println("- WiFi 主機名稱: " + String(WiFi.getHostname()));
+    if (info.connected) {
+        WM_LOGI("- SSID: %s", info.ssid);
+        WM_LOGI("- BSSID: " WM_MAC_FMT " (頻道 %u)", WM_MAC_ARGS(info.bssid), info.channel);
+        WM_LOGI("- 信號強度 (RSSI): %d dBm", info.rssi);
+        WM_LOGI("- MAC 地址: " WM_MAC_FMT, WM_MAC_ARGS(info.mac));
+        WM_LOGI("- IP 地址: " WM_IP_FMT, WM_IP_ARGS(IPAddress(info.ip)));
+        WM_LOGI("- 子網掩碼: " WM_IP_FMT, WM_IP_ARGS(IPAddress(info.subnet)));
+        WM_LOGI("- 閘道: " WM_IP_FMT, WM_IP_ARGS(IPAddress(info.gateway)));
+        WM_LOGI("- DNS: " WM_IP_FMT, WM_IP_ARGS(IPAddress(info.dns)));
+        WM_LOGI("- WiFi 主機名稱: %s", WiFi.getHostname());
+        WM_LOGI("- 連線時間: %lu ms", (unsigned long)info.uptimeMs);
+    } else if (info.lastReason != 0) {
+        WM_LOGI("- 最近斷線原因: %u", info.lastReason);
+    }
+    
+    WM_LOGI(WM_SEPARATOR);
+    
+    return info.status;
+}
+
+// ==========================================
+// WiFi Power Profiles
+// ==========================================
+
+#define WIFI_PROTOCOL_BGN (WIFI_PROTOCOL_11B | WIFI_PROTOCOL_11G | WIFI_PROTOCOL_11N)
+
+// 各設定檔的參數，依 WifiPowerProfile 排列 (DEFAULT 為驅動程式的預設值，CUSTOM 不使用)
+// listen interval 只在 MAX_MODEM 時有效，其他模式設為 0 (驅動程式預設值)
+static const WifiPowerConfig _wifiPowerProfiles[] = {
+    {WIFI_PS_MIN_MODEM, 0, WIFI_POWER_19_5dBm, WIFI_PROTOCOL_BGN},
+    {WIFI_PS_NONE, 0, WIFI_POWER_19_5dBm, WIFI_PROTOCOL_BGN},
+    {WIFI_PS_MIN_MODEM, 0, WIFI_POWER_17dBm, WIFI_PROTOCOL_BGN},
+    {WIFI_PS_MAX_MODEM, 10, WIFI_POWER_11dBm, WIFI_PROTOCOL_BGN}
+};
+
+static const char* const _wifiPowerProfileNames[] = {
+    "預設", "低延遲", "平衡", "低功耗", "自訂"
+};
+
+static WifiPowerProfile _wifiPowerProfile = WIFI_PROFILE_DEFAULT;
+static WifiPowerConfig _wifiPowerConfig = {WIFI_PS_MIN_MODEM, 0, WIFI_POWER_19_5dBm, WIFI_PROTOCOL_BGN};
+static bool _wifiPowerRestore = false;      // 切換回 DEFAULT 後尚未還原協定 (於下次關聯前還原)
+static WifiPowerConfig _wifiCustomConfig;   // 最近一次 Wifi_setPowerConfig 的設定
+static bool _wifiCustomSet = false;
+
+/**
+ * 是否需要套用省電設定 (非 DEFAULT，或切換回 DEFAULT 後尚未還原驅動程式的預設值)
+ */
+static bool _wifiPowerActive() {
+    return _wifiPowerProfile != WIFI_PROFILE_DEFAULT || _wifiPowerRestore;
+}
+
+/**
+ * 套用省電設定，STA 介面未開啟時不做任何事
+ * listen interval 需在 WiFi.begin 之後套用，見 _wifiApplyListenInterval
+ * @param beforeConnect 是否在關聯前 (同時套用協定)
+ */
+static void _wifiApplyPower(bool beforeConnect) {
+    if (!_wifiPowerActive() || (WiFi.getMode() & WIFI_MODE_STA) == 0) {
+        return;
+    }
+    
+    // 經由 WiFi.setSleep 設定 esp_wifi_set_ps，STA 重新啟動時 Arduino 才不會改回預設值
+    WiFi.setSleep((wifi_ps_type_t)_wifiPowerConfig.ps);
+    WiFi.setTxPower((wifi_power_t)_wifiPowerConfig.txPower);
+    if (!beforeConnect) {
+        return;
+    }
+    
+    esp_wifi_set_protocol(WIFI_IF_STA, _wifiPowerConfig.protocol);
+    _wifiPowerRestore = false;
+}
+
+/**
+ * 將省電設定的 listen interval 寫入 WiFi.begin 剛送出的 STA 設定，於關聯前呼叫
+ */
+static void _wifiApplyListenInterval() {
+    if (_wifiPowerProfile == WIFI_PROFILE_DEFAULT) {
+        return;
+    }
+    
+    wifi_config_t config;
+    if (esp_wifi_get_config(WIFI_IF_STA, &config) == ESP_OK &&
+        config.sta.listen_interval != _wifiPowerConfig.listenInterval) {
+        config.sta.listen_interval = _wifiPowerConfig.listenInterval;
+        esp_wifi_set_config(WIFI_IF_STA, &config);
+    }
+}
+
+/**
+ * 套用預先定義的省電設定檔，Wifi_connect 每次關聯前也會重新套用
+ * 省電模式與發射功率立即生效；協定與 listen interval 於下次關聯時生效
+ * @param profile 設定檔 (WIFI_PROFILE_DEFAULT 還原驅動程式的預設值，之後不再變更驅動程式設定；
+ *                WIFI_PROFILE_CUSTOM 重新套用最近一次 Wifi_setPowerConfig 的設定)
+ * @param silentMode 是否靜默模式
+ * @return 設定檔是否有效 (尚未呼叫 Wifi_setPowerConfig 時不可使用 WIFI_PROFILE_CUSTOM)
+ */
+bool Wifi_setPowerProfile(WifiPowerProfile profile, bool silentMode) {
+    WifiLock lock;
+    if ((unsigned)profile >= WIFI_PROFILE_COUNT) {
+        if (!silentMode) {
+            WM_LOGE("無效的 WiFi 省電設定檔: %d", (int)profile);
+        }
+        return false;
+    }
+    if (profile == WIFI_PROFILE_CUSTOM) {
+        // 自訂參數須經由 Wifi_setPowerConfig 指定
+        if (!_wifiCustomSet) {
+            if (!silentMode) {
+                WM_LOGE("尚未以 Wifi_setPowerConfig 指定自訂省電設定");
+            }
+            return false;
+        }
+        Wifi_setPowerConfig(_wifiCustomConfig, silentMode);
+        return true;
+    }
+    
+    // 由其他設定檔切換回 DEFAULT 時還原驅動程式的預設值
+    _wifiPowerRestore = profile == WIFI_PROFILE_DEFAULT &&
+                        (_wifiPowerProfile != WIFI_PROFILE_DEFAULT || _wifiPowerRestore);
+    _wifiPowerProfile = profile;
+    _wifiPowerConfig = _wifiPowerProfiles[profile];
+    _wifiApplyPower(WiFi.status() != WL_CONNECTED);
+    
+    if (!silentMode) {
+        WM_LOGI("WiFi 省電設定檔: %s", _wifiPowerProfileNames[profile]);
+    }
+    return true;
+}
+
+/**
+ * 以自訂參數設定省電模式
+ * @param config 省電設定
+ * @param silentMode 是否靜默模式
+ */
+void Wifi_setPowerConfig(const WifiPowerConfig &config, bool silentMode) {
+    WifiLock lock;
+    _wifiPowerProfile = WIFI_PROFILE_CUSTOM;
+    _wifiPowerConfig = config;
+    _wifiCustomConfig = config;
+    _wifiCustomSet = true;
+    _wifiApplyPower(WiFi.status() != WL_CONNECTED);
+    
+    if (!silentMode) {
+        WM_LOGI("WiFi 省電設定: ps=%u, listen=%u, tx=%d (0.25 dBm), protocol=0x%02x",
+                config.ps, config.listenInterval, config.txPower, config.protocol);
+    }
+}
+
+/**
+ * 取得目前的省電設定檔
+ */
+WifiPowerProfile Wifi_getPowerProfile() {
+    WifiLock lock;
+    return _wifiPowerProfile;
+}
+
+/**
+ * 取得目前的省電設定
+ * @param config 輸出的省電設定
+ * @return 是否有設定 (WIFI_PROFILE_DEFAULT 時為 false)
+ */
+bool Wifi_getPowerConfig(WifiPowerConfig &config) {
+    WifiLock lock;
+    config = _wifiPowerConfig;
+    return _wifiPowerProfile != WIFI_PROFILE_DEFAULT;
+}
+
+// ping 工作中累加，完成後由呼叫者讀取
+static std::atomic<bool> _wifiPingDone(false);
+
+static void _wifiPingSuccess(esp_ping_handle_t session, void* args) {
+    WifiLatencyStats* stats = (WifiLatencyStats*)args;
+    uint32_t rtt = 0;
+    esp_ping_get_profile(session, ESP_PING_PROF_TIMEGAP, &rtt, sizeof(rtt));
+    if (stats->received == 0 || rtt < stats->minMs) stats->minMs = rtt;
+    if (rtt > stats->maxMs) stats->maxMs = rtt;
+    stats->avgMs += rtt;    // 結束後再除以回應數
+    stats->received++;
+    stats->sent++;
+}
+
+static void _wifiPingTimeout(esp_ping_handle_t session, void* args) {
+    ((WifiLatencyStats*)args)->sent++;
+}
+
+static void _wifiPingEnd(esp_ping_handle_t session, void* args) {
+    _wifiPingDone.store(true, std::memory_order_release);
+}
+
+/**
+ * 以 ICMP ping 量測到閘道的往返延遲，用於比較不同省電設定檔 (阻塞直到完成)
+ * @param stats 輸出的量測結果
+ * @param count ping 次數
+ * @param intervalMs 每次 ping 的間隔 (毫秒)
+ * @param timeoutMs 單次 ping 的逾時 (毫秒)
+ * @return 是否至少收到一次回應
+ */
+bool Wifi_measureLatency(WifiLatencyStats &stats, uint16_t count, uint32_t intervalMs, uint32_t timeoutMs) {
+    memset(&stats, 0, sizeof(stats));
+    if (count == 0 || WiFi.status() != WL_CONNECTED) {
+        return false;
+    }
+    
+    IPAddress gateway = WiFi.gatewayIP();
+    esp_ping_config_t config = ESP_PING_DEFAULT_CONFIG();
+    config.count = count;
+    config.interval_ms = intervalMs;
+    config.timeout_ms = timeoutMs;
+    IP_ADDR4(&config.target_addr, gateway[0], gateway[1], gateway[2], gateway[3]);
+    
+    esp_ping_callbacks_t callbacks;
+    callbacks.cb_args = &stats;
+    callbacks.on_ping_success = _wifiPingSuccess;
+    callbacks.on_ping_timeout = _wifiPingTimeout;
+    callbacks.on_ping_end = _wifiPingEnd;
+    
+    esp_ping_handle_t session;
+    if (esp_ping_new_session(&config, &callbacks, &session) != ESP_OK) {
+        return false;
     }
+    _wifiPingDone.store(false, std::memory_order_relaxed);
+    esp_ping_start(session);
     
-    Serial.println("--------------------------------");
-    Serial.println();
+    unsigned long deadline = millis() + (unsigned long)count * (intervalMs + timeoutMs) + timeoutMs;
+    while (!_wifiPingDone.load(std::memory_order_acquire) && (long)(millis() - deadline) < 0) {
+        delay(10);
+    }
+    esp_ping_stop(session);
+    esp_ping_delete_session(session);
     
-    return status;
+    if (stats.received > 0) {
+        stats.avgMs /= stats.received;
+    }
+    return stats.received > 0;
 }
 
 // ==========================================
@@ -270,19 +1516,13 @@ byte Wifi_checkStatus(bool silentMode) {
 // ==========================================
 
 /**
- * 設置並啟動WiFi AP模式
- * @param ssid AP的SSID名稱
- * @param password AP的密碼 (至少8位，若為空則創建開放網絡)
- * @param channel WiFi頻道 (1-13)，預設為1
- * @param hidden 是否隱藏SSID，預設為false
- * @param maxConnection 最大連接數，預設為4
- * @return 是否成功開啟AP
+ * 以指定的模式 (AP 或 AP+STA) 啟動AP
  */
-bool Wifi_AP_start(const char* ssid, const char* password, int channel, bool hidden, int maxConnection) {
-  Serial.println("啟動WiFi AP模式... ");
-  
+static bool _wifiAPLaunch(wifi_mode_t mode, const char* ssid, const char* password, int channel, bool hidden, int maxConnection, bool silentMode) {
   // 配置AP
-  WiFi.mode(WIFI_AP);
+  _wifiRegisterEvents();
+  _wifiAPClearStations();
+  WiFi.mode(mode);
   
   // 啟動AP
   bool success;
@@ -290,61 +1530,411 @@ bool Wifi_AP_start(const char* ssid, const char* password, int channel, bool hid
     success = WiFi.softAP(ssid, password, channel, hidden, maxConnection);
   } else {
     success = WiFi.softAP(ssid, NULL, channel, hidden, maxConnection);
-    if(password != NULL) {
-      Serial.println("警告: 密碼少於8位或無效，創建開放網絡");
+    if(password != NULL && !silentMode) {
+      WM_LOGW("警告: 密碼少於8位或無效，創建開放網絡");
     }
   }
 
-  const char* separatorLine = "--------------------------------";
-  Serial.println(separatorLine);
-  if(success) {
-    Serial.println("- 成功!");
-    Serial.println("- AP SSID: " + String(ssid));
-    Serial.println("- AP IP: " + WiFi.softAPIP().toString());
-    Serial.println("- Password: " + String(password));
-  } else {
-    Serial.println("失敗!");
+  if (success) {
+    _wifiAPStartedAt = millis();
+  }
+
+  if (!silentMode) {
+    WM_LOGI(WM_SEPARATOR);
+    if(success) {
+      IPAddress ip = WiFi.softAPIP();
+      WM_LOGI("- 成功!");
+      WM_LOGI("- AP SSID: %s", ssid);
+      WM_LOGI("- AP IP: " WM_IP_FMT, WM_IP_ARGS(ip));
+      WM_LOGI("- Password: %s", password != NULL ? password : "");
+    } else {
+      WM_LOGE("失敗!");
+    }
+    WM_LOGI(WM_SEPARATOR);
   }
-  Serial.println(separatorLine);
   
   return success;
 }
 
+/**
+ * 設置並啟動WiFi AP模式
+ * @param ssid AP的SSID名稱
+ * @param password AP的密碼 (至少8位，若為空則創建開放網絡)
+ * @param channel WiFi頻道 (1-13)，預設為1
+ * @param hidden 是否隱藏SSID，預設為false
+ * @param maxConnection 最大連接數，預設為4
+ * @param silentMode 是否靜默模式
+ * @return 是否成功開啟AP
+ */
+bool Wifi_AP_start(const char* ssid, const char* password, int channel, bool hidden, int maxConnection, bool silentMode) {
+  if (!silentMode) {
+    WM_LOGI("啟動WiFi AP模式... ");
+  }
+  return _wifiAPLaunch(WIFI_AP, ssid, password, channel, hidden, maxConnection, silentMode);
+}
+
+/**
+ * 取得AP資訊，不配置堆積記憶體
+ * @param info 輸出的AP資訊
+ * @return AP 模式是否開啟
+ */
+bool Wifi_AP_getInfo(WifiAPInfo &info) {
+  memset(&info, 0, sizeof(info));
+  info.active = (WiFi.getMode() & WIFI_MODE_AP) != 0;
+  WiFi.softAPmacAddress(info.mac);
+  if (!info.active) {
+    return false;
+  }
+
+  wifi_config_t config;
+  if (esp_wifi_get_config(WIFI_IF_AP, &config) == ESP_OK) {
+    size_t ssidLen = config.ap.ssid_len > 0 ? config.ap.ssid_len : strnlen((const char*)config.ap.ssid, 32);
+    if (ssidLen > 32) ssidLen = 32;
+    memcpy(info.ssid, config.ap.ssid, ssidLen);
+    info.channel = config.ap.channel;
+    info.maxStations = config.ap.max_connection;
+  }
+  info.stations = WiFi.softAPgetStationNum();
+  info.ip = WiFi.softAPIP();
+  info.uptimeMs = millis() - _wifiAPStartedAt;
+  return true;
+}
+
 /**
  * 檢查WiFi AP狀態並顯示連線資訊
  * @param silentMode 是否靜默模式 (不顯示連線資訊)
  * @return 連接到AP的設備數量
  */
 int Wifi_AP_checkStatus(bool silentMode) {
-  int stationCount = WiFi.softAPgetStationNum();
-  
-  if(!silentMode) {
-    Serial.println("----------- AP 狀態 -----------");
-    Serial.println("- AP IP: " + WiFi.softAPIP().toString());
-    Serial.println("- 連接數量: " + String(stationCount));
-    Serial.println("- AP MAC: " + WiFi.softAPmacAddress());
-    Serial.println("--------------------------------");
+  if (silentMode) {
+    return WiFi.softAPgetStationNum();
   }
-  
-  return stationCount;
+
+  WifiAPInfo info;
+  Wifi_AP_getInfo(info);
+
+  WM_LOGI("----------- AP 狀態 -----------");
+  if (info.active) {
+    WM_LOGI("- AP SSID: %s (頻道 %u)", info.ssid, info.channel);
+  }
+  WM_LOGI("- AP IP: " WM_IP_FMT, WM_IP_ARGS(IPAddress(info.ip)));
+  WM_LOGI("- 連接數量: %u/%u", info.stations, info.maxStations);
+  WM_LOGI("- AP MAC: " WM_MAC_FMT, WM_MAC_ARGS(info.mac));
+
+  WifiAPStation stations[WIFI_AP_MAX_STATIONS];
+  int count = Wifi_AP_getStations(stations, WIFI_AP_MAX_STATIONS);
+  unsigned long now = millis();
+  for (int i = 0; i < count; i++) {
+    WM_LOGI("  %d. " WM_MAC_FMT " " WM_IP_FMT " %d dBm (%lu s)", i + 1,
+            WM_MAC_ARGS(stations[i].mac), WM_IP_ARGS(IPAddress(stations[i].ip)),
+            stations[i].rssi, (unsigned long)(now - stations[i].joinedAt) / 1000);
+  }
+  WM_LOGI(WM_SEPARATOR);
+
+  return info.stations;
+}
+
+/**
+ * 站台事件轉接至站台回調函式
+ */
+static void _wifiAPStationAdapter(const WirelessEvent &event, void* ctx) {
+  if (_wifiAPStationCallback == NULL || event.address == NULL) return;
+
+  WifiAPStation station;
+  portENTER_CRITICAL(&_wifiAPMux);
+  int i = _wifiAPFind(event.address);
+  if (i >= 0) station = _wifiAPStations[i].station;
+  portEXIT_CRITICAL(&_wifiAPMux);
+  if (i < 0) return;  // 站台表已滿，未追蹤此站台
+
+  WifiAPStationEvent type;
+  if (event.type == WIRELESS_EVENT_STATION_JOINED) {
+    type = WIFI_AP_STATION_JOINED;
+  } else if (event.type == WIRELESS_EVENT_STATION_IP) {
+    type = WIFI_AP_STATION_IP_ASSIGNED;
+  } else {
+    type = WIFI_AP_STATION_LEFT;
+  }
+  _wifiAPStationCallback(station, type, _wifiAPStationCtx);
+}
+
+/**
+ * 設定站台加入、取得 IP 與離開時的回調函式
+ * 回調函式於 WiFi 事件任務中執行，站台加入後數毫秒內即會收到通知
+ * @param callback 回調函式，NULL 表示取消
+ * @param ctx 傳給回調函式的使用者資料
+ * @param silentMode 是否靜默模式
+ */
+void Wifi_AP_setStationCallback(WifiAPStationCallback callback, void* ctx, bool silentMode) {
+  _wifiAPStationCallback = callback;
+  _wifiAPStationCtx = ctx;
+  if (callback != NULL) {
+    Wireless_on(WIRELESS_EVENT_MASK(WIRELESS_EVENT_STATION_JOINED) |
+                WIRELESS_EVENT_MASK(WIRELESS_EVENT_STATION_IP) |
+                WIRELESS_EVENT_MASK(WIRELESS_EVENT_STATION_LEFT), _wifiAPStationAdapter);
+  } else {
+    Wireless_off(_wifiAPStationAdapter);
+  }
+
+  if (!silentMode) {
+    WM_LOGI("AP 站台回調函式已%s", callback != NULL ? "設定" : "取消");
+  }
+}
+
+/**
+ * 取得目前連接的站台，並以 esp_wifi_ap_get_sta_list 更新信號強度
+ * @param stations 輸出陣列
+ * @param maxCount 陣列容量
+ * @return 寫入的站台數量
+ */
+int Wifi_AP_getStations(WifiAPStation* stations, int maxCount) {
+  if (stations == NULL || maxCount <= 0) return 0;
+
+  wifi_sta_list_t list;
+  bool haveList = esp_wifi_ap_get_sta_list(&list) == ESP_OK;
+
+  int count = 0;
+  portENTER_CRITICAL(&_wifiAPMux);
+  for (int i = 0; i < WIFI_AP_MAX_STATIONS && count < maxCount; i++) {
+    if (!_wifiAPStations[i].used) continue;
+    WifiAPStation &station = _wifiAPStations[i].station;
+    for (int j = 0; haveList && j < list.num; j++) {
+      if (memcmp(list.sta[j].mac, station.mac, 6) == 0) {
+        station.rssi = list.sta[j].rssi;
+        break;
+      }
+    }
+    stations[count++] = station;
+  }
+  portEXIT_CRITICAL(&_wifiAPMux);
+  return count;
 }
 
 /**
  * 停止WiFi AP模式
+ * @param silentMode 是否靜默模式
  * @return 是否成功停止AP
  */
-bool Wifi_AP_stop() {
-  Serial.println("--------------------------------");
-  Serial.print("停止WiFi AP模式... ");
-  
+bool Wifi_AP_stop(bool silentMode) {
   bool success = WiFi.softAPdisconnect(true);
+  _wifiAPClearStations();
   
-  if(success) {
-    Serial.println("成功!");
-  } else {
-    Serial.println("失敗!");
+  if (!silentMode) {
+    WM_LOGI(WM_SEPARATOR);
+    if(success) {
+      WM_LOGI("停止WiFi AP模式... 成功!");
+    } else {
+      WM_LOGE("停止WiFi AP模式... 失敗!");
+    }
+    WM_LOGI(WM_SEPARATOR);
   }
-  Serial.println("--------------------------------");
   
   return success;
+}
+
+// ==========================================
+// WiFi Provisioning (AP+STA)
+// ==========================================
+
+static WifiProvState _wifiProvState = WIFI_PROV_IDLE;
+static WifiProvTiming _wifiProvTiming;
+static uint8_t _wifiProvChannel = 1;
+static bool _wifiProvHomeOnly = false;          // 目前只掃描AP所在的頻道
+static WifiScanConfig _wifiProvSavedScan;       // 使用者設定的連線掃描參數
+static unsigned long _wifiProvStartAt = 0;
+static unsigned long _wifiProvCredsAt = 0;
+static unsigned long _wifiProvConnectedAt = 0;
+static unsigned long _wifiProvShutdownDelayMs = 5000;
+static int _wifiProvTimeoutSeconds = 10;
+static bool _wifiProvSilentMode = false;
+
+/**
+ * 以 AP+STA 模式啟動AP，等待 Wifi_provisionConnect 提供的 STA 憑證
+ * 之後的 STA 連線不會切換無線模式，連接中的配網設備不會斷線
+ * @param ssid AP的SSID名稱
+ * @param password AP的密碼 (至少8位，若為空則創建開放網絡)
+ * @param channel AP頻道 (1-13)，STA 連線時優先掃描此頻道
+ * @param hidden 是否隱藏SSID
+ * @param maxConnection 最大連接數
+ * @param silentMode 是否靜默模式
+ * @return 是否成功開啟AP
+ */
+bool Wifi_provisionStart(const char* ssid, const char* password, int channel, bool hidden, int maxConnection, bool silentMode) {
+  WifiLock lock;
+  if (!silentMode) {
+    WM_LOGI("啟動配網模式 (AP+STA)... ");
+  }
+
+  unsigned long start = millis();
+  memset(&_wifiProvTiming, 0, sizeof(_wifiProvTiming));
+  if (!_wifiAPLaunch(WIFI_AP_STA, ssid, password, channel, hidden, maxConnection, silentMode)) {
+    _wifiProvState = WIFI_PROV_IDLE;
+    return false;
+  }
+
+  _wifiProvStartAt = millis();
+  _wifiProvTiming.apStartMs = _wifiProvStartAt - start;
+  _wifiProvChannel = channel;
+  _wifiProvSilentMode = silentMode;
+  _wifiProvState = WIFI_PROV_AP_ONLY;
+  return true;
+}
+
+/**
+ * 在AP保持開啟的情況下以 STA 連線到指定網路
+ * 先只掃描AP所在的頻道，找不到時才改為全頻道掃描 (ESP32 單一射頻，STA 換頻道時AP會跟著換)
+ * 連線後須保持 apShutdownDelayMs 才關閉AP，期間配網設備仍可取得結果
+ * @param ssid WiFi 網路名稱
+ * @param password WiFi 密碼
+ * @param apShutdownDelayMs STA 連線穩定多久後關閉AP (毫秒)
+ * @param timeoutSeconds 關聯與取得IP的最長等待時間(秒)
+ * @param silentMode 是否靜默模式
+ * @return 是否成功開始連線流程
+ */
+bool Wifi_provisionConnect(const char* ssid, const char* password, unsigned long apShutdownDelayMs, int timeoutSeconds, bool silentMode) {
+  WifiLock lock;
+  if (_wifiProvState == WIFI_PROV_IDLE || _wifiProvState == WIFI_PROV_DONE) {
+    if (!silentMode) {
+      WM_LOGW("配網模式未啟動");
+    }
+    return false;
+  }
+  if (_wifiProvState == WIFI_PROV_CONNECTING) {
+    _wifiConnectScanConfig = _wifiProvSavedScan;
+  }
+
+  // 確保 STA 介面開啟，不使用 WiFi.mode() 以免重新啟動AP
+  WiFi.enableSTA(true);
+
+  _wifiProvSavedScan = _wifiConnectScanConfig;
+  _wifiConnectScanConfig.channelMask = WIFI_SCAN_CHANNEL(_wifiProvChannel);
+  _wifiProvHomeOnly = true;
+  _wifiProvShutdownDelayMs = apShutdownDelayMs;
+  _wifiProvTimeoutSeconds = timeoutSeconds;
+  _wifiProvSilentMode = silentMode;
+
+  _wifiProvCredsAt = millis();
+  if (_wifiProvTiming.attempts == 0) {
+    _wifiProvTiming.waitMs = _wifiProvCredsAt - _wifiProvStartAt;
+  }
+  _wifiProvTiming.attempts++;
+
+  if (!Wifi_connectAsync(ssid, password, NULL, timeoutSeconds, silentMode)) {
+    _wifiConnectScanConfig = _wifiProvSavedScan;
+    _wifiProvState = WIFI_PROV_FAILED;
+    return false;
+  }
+  _wifiProvState = WIFI_PROV_CONNECTING;
+  return true;
+}
+
+/**
+ * 推進配網流程，此函式應在主迴圈中定期呼叫，每次呼叫都會立即返回
+ * @return 目前的配網狀態
+ */
+WifiProvState Wifi_provisionPoll() {
+  WifiLock lock;
+  switch (_wifiProvState) {
+    case WIFI_PROV_CONNECTING: {
+      WifiConnState state = Wifi_poll();
+      if (state == WIFI_CONN_CONNECTED) {
+        _wifiConnectScanConfig = _wifiProvSavedScan;
+        _wifiProvConnectedAt = millis();
+        _wifiProvTiming.connectMs = _wifiProvConnectedAt - _wifiProvCredsAt;
+        _wifiProvTiming.channelMoved = WiFi.channel() != _wifiProvChannel;
+        _wifiProvState = WIFI_PROV_STABILIZING;
+        if (!_wifiProvSilentMode) {
+          WM_LOGI("STA 已連線 (%lu ms)，%lu ms 後關閉AP",
+                  (unsigned long)_wifiProvTiming.connectMs, _wifiProvShutdownDelayMs);
+        }
+      } else if (state == WIFI_CONN_FAILED) {
+        _wifiConnectScanConfig = _wifiProvSavedScan;
+        if (_wifiProvHomeOnly) {
+          // AP頻道上找不到或連不上，改用使用者的掃描設定
+          _wifiProvHomeOnly = false;
+          if (!_wifiProvSilentMode) {
+            WM_LOGW("AP頻道 %u 上連線失敗，改為全頻道掃描", _wifiProvChannel);
+          }
+          if (_wifiBeginConnect(NULL, _wifiProvTimeoutSeconds, _wifiProvSilentMode)) {
+            break;
+          }
+        }
+        _wifiProvTiming.connectMs = millis() - _wifiProvCredsAt;
+        _wifiProvState = WIFI_PROV_FAILED;
+        if (!_wifiProvSilentMode) {
+          WM_LOGW("STA 連線失敗，AP保持開啟");
+        }
+      }
+      break;
+    }
+
+    case WIFI_PROV_STABILIZING: {
+      unsigned long now = millis();
+      if (WiFi.status() != WL_CONNECTED) {
+        // 穩定期間斷線，保留AP讓配網設備重新提供憑證
+        _wifiProvState = WIFI_PROV_FAILED;
+        if (!_wifiProvSilentMode) {
+          WM_LOGW("STA 在穩定期間斷線，AP保持開啟");
+        }
+        break;
+      }
+      if (now - _wifiProvConnectedAt < _wifiProvShutdownDelayMs) {
+        break;
+      }
+
+      // 只關閉AP介面，STA 連線不受影響
+      WiFi.softAPdisconnect(true);
+      _wifiAPClearStations();
+      _wifiProvTiming.stableMs = now - _wifiProvConnectedAt;
+      _wifiProvTiming.totalMs = now - _wifiProvStartAt + _wifiProvTiming.apStartMs;
+      _wifiProvState = WIFI_PROV_DONE;
+      if (!_wifiProvSilentMode) {
+        WM_LOGI(WM_SEPARATOR);
+        WM_LOGI("配網完成，AP已關閉");
+        WM_LOGI("- AP啟動: %lu ms", (unsigned long)_wifiProvTiming.apStartMs);
+        WM_LOGI("- 等待憑證: %lu ms", (unsigned long)_wifiProvTiming.waitMs);
+        WM_LOGI("- STA連線: %lu ms (%u 次)", (unsigned long)_wifiProvTiming.connectMs, _wifiProvTiming.attempts);
+        WM_LOGI("- 穩定期間: %lu ms", (unsigned long)_wifiProvTiming.stableMs);
+        WM_LOGI("- 總計: %lu ms", (unsigned long)_wifiProvTiming.totalMs);
+        WM_LOGI(WM_SEPARATOR);
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+
+  return _wifiProvState;
+}
+
+/**
+ * 結束配網模式並關閉AP，STA 連線不受影響
+ * @param silentMode 是否靜默模式
+ */
+void Wifi_provisionStop(bool silentMode) {
+  WifiLock lock;
+  if (_wifiProvState == WIFI_PROV_IDLE) return;
+  if (_wifiProvState == WIFI_PROV_CONNECTING) {
+    _wifiConnectScanConfig = _wifiProvSavedScan;
+  }
+  if (_wifiProvState != WIFI_PROV_DONE) {
+    WiFi.softAPdisconnect(true);
+    _wifiAPClearStations();
+  }
+  _wifiProvState = WIFI_PROV_IDLE;
+  if (!silentMode) {
+    WM_LOGI("配網模式已結束");
+  }
+}
+
+/**
+ * 取得配網各階段的耗時
+ * @param timing 輸出的耗時
+ * @return 配網是否已完成
+ */
+bool Wifi_provisionGetTiming(WifiProvTiming &timing) {
+  WifiLock lock;
+  timing = _wifiProvTiming;
+  return _wifiProvState == WIFI_PROV_DONE;
 }
\ No newline at end of file
@@ -9,10 +9,313 @@
 #include <BLEUtils.h>
 #include <BLE2902.h>
 
+// ==========================================
+// Logging
+// ==========================================
+
+// 日誌等級
+#define WIRELESS_LOG_NONE   0
+#define WIRELESS_LOG_ERROR  1
+#define WIRELESS_LOG_WARN   2
+#define WIRELESS_LOG_INFO   3
+#define WIRELESS_LOG_DEBUG  4
+
+// 編譯時的日誌等級，高於此等級的日誌呼叫會被完全移除
+#ifndef WIRELESS_LOG_LEVEL
+#define WIRELESS_LOG_LEVEL WIRELESS_LOG_INFO
+#endif
+
+// 單行日誌的最大長度 (堆疊緩衝區)
+#ifndef WIRELESS_LOG_BUFFER_SIZE
+#define WIRELESS_LOG_BUFFER_SIZE 128
+#endif
+
+// 環形緩衝區輸出端的容量
+#ifndef WIRELESS_LOG_RING_SIZE
+#define WIRELESS_LOG_RING_SIZE 1024
+#endif
+
+// 日誌輸出端函式指針類型 (line 不含換行字元)
+typedef void (*WirelessLogSink)(uint8_t level, const char* line, size_t length);
+
+void Wireless_log(uint8_t level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+void Wireless_setLogSink(WirelessLogSink sink);
+void Wireless_logSinkSerial(uint8_t level, const char* line, size_t length);
+void Wireless_logSinkRing(uint8_t level, const char* line, size_t length);
+size_t Wireless_logRingRead(char* buffer, size_t size);
+
+#if WIRELESS_LOG_LEVEL >= WIRELESS_LOG_ERROR
+#define WM_LOGE(...) Wireless_log(WIRELESS_LOG_ERROR, __VA_ARGS__)
+#else
+#define WM_LOGE(...) do {} while (0)
+#endif
+
+#if WIRELESS_LOG_LEVEL >= WIRELESS_LOG_WARN
+#define WM_LOGW(...) Wireless_log(WIRELESS_LOG_WARN, __VA_ARGS__)
+#else
+#define WM_LOGW(...) do {} while (0)
+#endif
+
+#if WIRELESS_LOG_LEVEL >= WIRELESS_LOG_INFO
+#define WM_LOGI(...) Wireless_log(WIRELESS_LOG_INFO, __VA_ARGS__)
+#else
+#define WM_LOGI(...) do {} while (0)
+#endif
+
+#if WIRELESS_LOG_LEVEL >= WIRELESS_LOG_DEBUG
+#define WM_LOGD(...) Wireless_log(WIRELESS_LOG_DEBUG, __VA_ARGS__)
+#else
+#define WM_LOGD(...) do {} while (0)
+#endif
+
+// IP 與 MAC 地址的格式化輔助巨集，避免建立 String
+#define WM_IP_FMT           "%u.%u.%u.%u"
+#define WM_IP_ARGS(ip)      (ip)[0], (ip)[1], (ip)[2], (ip)[3]
+#define WM_MAC_FMT          "%02X:%02X:%02X:%02X:%02X:%02X"
+#define WM_MAC_ARGS(mac)    (mac)[0], (mac)[1], (mac)[2], (mac)[3], (mac)[4], (mac)[5]
+
+// 分隔線
+#define WM_SEPARATOR        "--------------------------------"
+
+// ==========================================
+// Events
+// ==========================================
+
+// 事件類型
+typedef enum {
+    WIRELESS_EVENT_LINK_UP = 0,     // 連線建立 (WiFi 取得 IP、MQTT 連上伺服器、BT/BLE 對端連入)
+    WIRELESS_EVENT_LINK_DOWN,       // 連線中斷
+    WIRELESS_EVENT_MESSAGE,         // 收到訊息 (MQTT 訊息、BT 訊框、BLE 寫入)
+    WIRELESS_EVENT_PUBLISH_DONE,    // QoS 1 發布完成或放棄
+    WIRELESS_EVENT_STATION_JOINED,  // 有站台連上本機 AP
+    WIRELESS_EVENT_STATION_LEFT,    // 站台離開本機 AP
+    WIRELESS_EVENT_STATION_IP,      // 本機 AP 的 DHCP 分配 IP 給站台
+    WIRELESS_EVENT_COUNT
+} WirelessEventType;
+
+// 事件來源
+typedef enum {
+    WIRELESS_SOURCE_WIFI = 0,
+    WIRELESS_SOURCE_AP,
+    WIRELESS_SOURCE_MQTT,
+    WIRELESS_SOURCE_BT,
+    WIRELESS_SOURCE_BLE
+} WirelessSource;
+
+// 事件內容，指標指向函式庫內部的緩衝區，只在監聽函式執行期間有效
+typedef struct {
+    WirelessEventType type;
+    WirelessSource source;
+    uint16_t id;                // BLE 連線識別碼 / MQTT 封包識別碼 / AP 站台 AID
+    bool success;               // PUBLISH_DONE: 是否收到確認
+    const char* topic;          // MESSAGE/PUBLISH_DONE: MQTT 主題 (其他來源為 NULL)
+    const uint8_t* data;        // MESSAGE: 訊息內容 (不一定以 '\0' 結尾，例如 MQTT，請使用 length)
+    size_t length;              // MESSAGE: 訊息長度
+    const uint8_t* address;     // 對端 MAC 位址 (沒有時為 NULL)
+} WirelessEvent;
+
+// 事件監聽函式指針類型
+typedef void (*WirelessEventListener)(const WirelessEvent &event, void* ctx);
+
+// 監聽的事件遮罩
+#define WIRELESS_EVENT_MASK(type)   (1UL << (type))
+#define WIRELESS_EVENT_ALL          ((1UL << WIRELESS_EVENT_COUNT) - 1)
+
+// 監聽函式數量上限 (含舊版回調函式的轉接)
+#ifndef WIRELESS_MAX_LISTENERS
+#define WIRELESS_MAX_LISTENERS 12
+#endif
+
+// 監聽函式在發出事件的任務中執行 (訊息事件為呼叫 *_loop 或 Wireless_dispatch 的任務，
+// WiFi/AP 事件為 WiFi 事件任務)；可在任何任務中註冊或取消註冊，
+// 但另一個任務正在發出的事件仍可能送給剛取消註冊的監聽函式一次
+bool Wireless_on(uint32_t eventMask, WirelessEventListener listener, void* ctx = NULL);
+bool Wireless_off(WirelessEventListener listener, void* ctx = NULL);
+void Wireless_emit(const WirelessEvent &event);
+
+// ==========================================
+// CBOR
+// ==========================================
+
+// 共用編碼緩衝區大小 (Cbor_writerInitShared)
+#ifndef CBOR_SHARED_BUFFER_LEN
+#define CBOR_SHARED_BUFFER_LEN 256
+#endif
+
+// 串流編碼器，直接寫入呼叫者提供的緩衝區，不配置記憶體
+// 空間不足時 overflow 設為 true，之後的寫入都會被忽略
+typedef struct {
+    uint8_t* buffer;
+    size_t capacity;
+    size_t length;
+    bool overflow;
+} CborWriter;
+
+// 資料項目類型
+typedef enum {
+    CBOR_TYPE_UINT = 0,
+    CBOR_TYPE_NEGINT,
+    CBOR_TYPE_BYTES,
+    CBOR_TYPE_TEXT,
+    CBOR_TYPE_ARRAY,
+    CBOR_TYPE_MAP,
+    CBOR_TYPE_TAG,
+    CBOR_TYPE_BOOL,
+    CBOR_TYPE_NULL,
+    CBOR_TYPE_UNDEFINED,
+    CBOR_TYPE_FLOAT
+} CborType;
+
+// 解碼出的資料項目，字串與位元組直接指向輸入緩衝區，不複製
+typedef struct {
+    CborType type;
+    uint64_t uintValue;     // UINT 的值、NEGINT 的編碼值 (實際值為 -1 - uintValue)、TAG 的標籤
+    int64_t intValue;       // UINT/NEGINT 的有號值
+    double floatValue;      // FLOAT 的值 (半/單/雙精度)
+    bool boolValue;
+    const uint8_t* data;    // BYTES/TEXT 的內容 (不以 '\0' 結尾)
+    size_t length;          // BYTES/TEXT 的長度、ARRAY 的元素數、MAP 的配對數
+} CborItem;
+
+// 串流解碼器 (只支援固定長度的項目，不支援不定長度編碼)
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+    size_t pos;
+    bool error;
+} CborReader;
+
+void Cbor_writerInit(CborWriter &writer, uint8_t* buffer, size_t capacity);
+void Cbor_writerInitShared(CborWriter &writer);
+bool Cbor_writeUint(CborWriter &writer, uint64_t value);
+bool Cbor_writeInt(CborWriter &writer, int64_t value);
+bool Cbor_writeFloat(CborWriter &writer, float value);
+bool Cbor_writeDouble(CborWriter &writer, double value);
+bool Cbor_writeBool(CborWriter &writer, bool value);
+bool Cbor_writeNull(CborWriter &writer);
+bool Cbor_writeText(CborWriter &writer, const char* text);
+bool Cbor_writeText(CborWriter &writer, const char* text, size_t length);
+bool Cbor_writeBytes(CborWriter &writer, const uint8_t* data, size_t length);
+bool Cbor_beginArray(CborWriter &writer, size_t count);
+bool Cbor_beginMap(CborWriter &writer, size_t pairs);
+bool Cbor_writeTag(CborWriter &writer, uint64_t tag);
+
+void Cbor_readerInit(CborReader &reader, const uint8_t* data, size_t length);
+bool Cbor_read(CborReader &reader, CborItem &item);
+bool Cbor_skip(CborReader &reader);
+bool Cbor_mapFind(CborReader &reader, size_t pairs, const char* key, CborItem &value);
+bool Cbor_textEquals(const CborItem &item, const char* text);
+bool Cbor_getInt(const CborItem &item, int64_t &value);
+bool Cbor_getFloat(const CborItem &item, double &value);
+
 // ==========================================
 // WiFi Client Mode
 // ==========================================
 
+// 掃描結果表格容量
+#ifndef WIFI_SCAN_MAX_RESULTS
+#define WIFI_SCAN_MAX_RESULTS 32
+#endif
+
+// 頻道遮罩，第 n-1 位元代表頻道 n
+#define WIFI_SCAN_CHANNEL(ch)   (1U << ((ch) - 1))
+#define WIFI_SCAN_ALL_CHANNELS  0x3FFF
+
+// 掃描設定
+typedef struct {
+    uint16_t channelMask;   // 要掃描的頻道，0為單次全頻道掃描
+    bool passive;           // 是否使用被動掃描
+    uint16_t dwellMs;       // 每頻道停留時間(毫秒)，0為預設值
+    bool showHidden;        // 是否包含隱藏網路
+} WifiScanConfig;
+
+// 掃描結果 (POD，不配置堆積記憶體)
+typedef struct {
+    char ssid[33];
+    uint8_t ssidLen;
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t rssi;
+    uint8_t auth;           // wifi_auth_mode_t
+} WifiScanResult;
+
+bool Wifi_scanStart(const WifiScanConfig &config);
+int Wifi_scanPoll();
+void Wifi_scanCancel();
+const WifiScanResult* Wifi_scanResults(int* count = NULL);
+
+// 非阻塞連線流程的狀態
+typedef enum {
+    WIFI_CONN_IDLE = 0,     // 尚未開始連線
+    WIFI_CONN_SCANNING,     // 掃描目標網路中
+    WIFI_CONN_ASSOCIATING,  // 與 AP 關聯中
+    WIFI_CONN_DHCP,         // 已關聯，等待取得IP
+    WIFI_CONN_CONNECTED,    // 連線成功
+    WIFI_CONN_FAILED        // 連線失敗
+} WifiConnState;
+
+// 連線完成回調函式指針類型 (參數為 WIFI_CONN_CONNECTED 或 WIFI_CONN_FAILED)
+// 於推進狀態機的任務中執行 (服務任務執行中時可能是服務任務)
+typedef void (*WifiConnectCallback)(WifiConnState state);
+
+bool Wifi_connectAsync(
+    const char* ssid, const char* password,
+    WifiConnectCallback callback = NULL,
+    int timeoutSeconds = 10,
+    bool silentMode = false,
+    const char* staticIP = NULL,
+    const char* gateway = NULL,
+    const char* subnet = NULL,
+    const char* dns1 = NULL,
+    const char* dns2 = NULL
+);
+WifiConnState Wifi_poll();
+
+// 連線所使用的路徑
+typedef enum {
+    WIFI_PATH_NONE = 0,
+    WIFI_PATH_FAST,         // 以快取的 BSSID/頻道直接關聯
+    WIFI_PATH_SCAN          // 完整掃描 (fastPathMs > 0 表示快速路徑失敗後退回)
+} WifiConnectPath;
+
+// 最近一次連線的耗時 (毫秒)
+typedef struct {
+    WifiConnectPath path;
+    uint32_t fastPathMs;    // 快速路徑耗時
+    uint32_t scanPathMs;    // 完整掃描路徑耗時
+    uint32_t totalMs;       // 總耗時
+} WifiConnectTiming;
+
+// 候選網路登錄表與排序清單的容量
+#ifndef WIFI_MAX_CANDIDATES
+#define WIFI_MAX_CANDIDATES 8
+#endif
+#ifndef WIFI_MAX_RANKED
+#define WIFI_MAX_RANKED 16
+#endif
+
+// 掃描後依優先級與信號強度排序的AP
+typedef struct {
+    uint8_t candidate;      // 對應的候選索引
+    int priority;
+    int8_t rssi;
+    uint8_t channel;
+    uint8_t bssid[6];
+} WifiRankedAP;
+
+bool Wifi_addCandidate(const char* ssid, const char* password, int priority = 0);
+void Wifi_clearCandidates();
+bool Wifi_connectBestAsync(WifiConnectCallback callback = NULL, int timeoutSeconds = 10, bool silentMode = false);
+bool Wifi_connectBest(int timeoutSeconds = 10, bool silentMode = false);
+bool Wifi_failover(WifiConnectCallback callback = NULL);
+int Wifi_getRankedCount();
+bool Wifi_getRanked(int index, WifiRankedAP &ap);
+
+void Wifi_setConnectScanConfig(const WifiScanConfig &config);
+void Wifi_setFastReconnect(bool enable, bool reuseLease = true, unsigned long fastTimeoutMs = 3000);
+void Wifi_clearFastReconnect();
+bool Wifi_getConnectTiming(WifiConnectTiming &timing);
+
 bool Wifi_connect(
     const char* ssid, const char* password,
     int timeoutSeconds = 10,
@@ -26,6 +329,59 @@ bool Wifi_connect(
 
 byte Wifi_checkStatus(bool silentMode = false);
 
+// WiFi 連線資訊快照 (POD，不配置堆積記憶體)
+// IP 位址與 IPAddress 的 uint32_t 轉換相同 (網路位元組順序)
+typedef struct {
+    uint8_t status;         // wl_status_t
+    bool connected;
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t mac[6];
+    uint8_t channel;
+    int8_t rssi;
+    uint32_t ip;
+    uint32_t subnet;
+    uint32_t gateway;
+    uint32_t dns;
+    uint32_t uptimeMs;      // 本次連線已持續的時間 (未連線時為0)
+    uint8_t lastReason;     // 最近一次斷線原因 (wifi_err_reason_t，0為尚未斷線)
+} WifiInfo;
+
+bool Wifi_getInfo(WifiInfo &info);
+
+// 省電與延遲設定檔
+typedef enum {
+    WIFI_PROFILE_DEFAULT = 0,   // 驅動程式的預設值 (由其他設定檔切換回來時還原，之後不再變更)
+    WIFI_PROFILE_LOW_LATENCY,   // 關閉省電，最大發射功率
+    WIFI_PROFILE_BALANCED,      // 最小省電 (每個 DTIM 醒來)
+    WIFI_PROFILE_LOW_POWER,     // 最大省電 (依 listen interval 醒來)，降低發射功率
+    WIFI_PROFILE_CUSTOM,        // 由 Wifi_setPowerConfig 指定
+    WIFI_PROFILE_COUNT
+} WifiPowerProfile;
+
+// 省電設定
+typedef struct {
+    uint8_t ps;             // wifi_ps_type_t
+    uint16_t listenInterval; // MAX_MODEM 時醒來接收信標的間隔 (信標數)，於下次關聯時生效
+    int8_t txPower;         // wifi_power_t (單位 0.25 dBm)
+    uint8_t protocol;       // WIFI_PROTOCOL_11B/11G/11N 位元組合
+} WifiPowerConfig;
+
+// 往返延遲量測結果 (毫秒)
+typedef struct {
+    uint16_t sent;
+    uint16_t received;
+    uint32_t minMs;
+    uint32_t avgMs;
+    uint32_t maxMs;
+} WifiLatencyStats;
+
+bool Wifi_setPowerProfile(WifiPowerProfile profile, bool silentMode = false);
+void Wifi_setPowerConfig(const WifiPowerConfig &config, bool silentMode = false);
+WifiPowerProfile Wifi_getPowerProfile();
+bool Wifi_getPowerConfig(WifiPowerConfig &config);
+bool Wifi_measureLatency(WifiLatencyStats &stats, uint16_t count = 5, uint32_t intervalMs = 200, uint32_t timeoutMs = 1000);
+
 // ==========================================
 // WiFi Access Point Mode
 // ==========================================
@@ -33,10 +389,90 @@ byte Wifi_checkStatus(bool silentMode = false);
 bool Wifi_AP_start(
     const char* ssid, const char* password,
     int channel = 1, bool hidden = false,
-    int maxConnection = 32
+    int maxConnection = 32, bool silentMode = false
 );
 int Wifi_AP_checkStatus(bool silentMode = false);
-bool Wifi_AP_stop();
+bool Wifi_AP_stop(bool silentMode = false);
+
+// AP 資訊快照 (POD，不配置堆積記憶體)
+typedef struct {
+    bool active;            // AP 模式是否開啟
+    char ssid[33];
+    uint8_t mac[6];
+    uint8_t channel;
+    uint8_t stations;       // 目前連接的設備數量
+    uint8_t maxStations;
+    uint32_t ip;
+    uint32_t uptimeMs;      // AP 已開啟的時間 (未開啟時為0)
+} WifiAPInfo;
+
+bool Wifi_AP_getInfo(WifiAPInfo &info);
+
+// AP 站台表容量
+#ifndef WIFI_AP_MAX_STATIONS
+#define WIFI_AP_MAX_STATIONS 8
+#endif
+
+// 連接到本機 AP 的站台
+typedef struct {
+    uint8_t mac[6];
+    uint8_t aid;            // 關聯識別碼
+    uint32_t ip;            // DHCP 分配的 IP (尚未分配時為0)
+    int8_t rssi;            // 最近一次 Wifi_AP_getStations 取得的信號強度 (0為未知)
+    uint32_t joinedAt;      // 加入時的 millis()
+} WifiAPStation;
+
+// 站台事件類型
+typedef enum {
+    WIFI_AP_STATION_JOINED = 0,
+    WIFI_AP_STATION_IP_ASSIGNED,
+    WIFI_AP_STATION_LEFT
+} WifiAPStationEvent;
+
+// 站台回調函式指針類型 (於 WiFi 事件任務中執行)
+typedef void (*WifiAPStationCallback)(const WifiAPStation &station, WifiAPStationEvent event, void* ctx);
+
+void Wifi_AP_setStationCallback(WifiAPStationCallback callback, void* ctx = NULL, bool silentMode = false);
+int Wifi_AP_getStations(WifiAPStation* stations, int maxCount);
+
+// ==========================================
+// WiFi Provisioning (AP+STA)
+// ==========================================
+
+// 配網流程的狀態
+typedef enum {
+    WIFI_PROV_IDLE = 0,     // 未啟動
+    WIFI_PROV_AP_ONLY,      // AP 已開啟，等待 STA 憑證
+    WIFI_PROV_CONNECTING,   // AP 保持開啟，STA 連線中
+    WIFI_PROV_STABILIZING,  // STA 已連線，等待延遲時間後關閉 AP
+    WIFI_PROV_DONE,         // AP 已關閉，只保留 STA
+    WIFI_PROV_FAILED        // STA 連線失敗或穩定期間斷線，AP 保持開啟
+} WifiProvState;
+
+// 配網各階段的耗時 (毫秒)
+typedef struct {
+    uint32_t apStartMs;     // 啟動 AP
+    uint32_t waitMs;        // AP 開啟到收到第一次憑證
+    uint32_t connectMs;     // 最近一次憑證到 STA 連線成功 (或失敗)
+    uint32_t stableMs;      // STA 連線到 AP 關閉
+    uint32_t totalMs;       // 全部流程
+    uint8_t attempts;       // 提供憑證的次數
+    bool channelMoved;      // STA 不在 AP 頻道上，AP 已跟隨 STA 換頻道
+} WifiProvTiming;
+
+bool Wifi_provisionStart(
+    const char* ssid, const char* password,
+    int channel = 1, bool hidden = false,
+    int maxConnection = 4, bool silentMode = false
+);
+bool Wifi_provisionConnect(
+    const char* ssid, const char* password,
+    unsigned long apShutdownDelayMs = 5000,
+    int timeoutSeconds = 10, bool silentMode = false
+);
+WifiProvState Wifi_provisionPoll();
+void Wifi_provisionStop(bool silentMode = false);
+bool Wifi_provisionGetTiming(WifiProvTiming &timing);
 
 // ==========================================
 // MQTT Client
@@ -50,12 +486,131 @@ bool Mqtt_connect(
     bool willRetain = false, bool cleanSession = true, bool silentMode = false
 );
 bool Mqtt_publish(const char* topic, const char* payload, bool retain = false, bool silentMode = false);
+bool Mqtt_publishBinary(
+    const char* topic, const uint8_t* payload, size_t length,
+    bool retain = false, bool silentMode = false
+);
+bool Mqtt_publishCbor(const char* topic, const CborWriter &writer, bool retain = false, bool silentMode = false);
+// 串流發布: 三個函式需在同一個任務中依序呼叫，期間其他任務的 MQTT 呼叫 (包括服務任務) 會等待
+bool Mqtt_beginPublish(const char* topic, size_t length, bool retain = false, bool silentMode = false);
+size_t Mqtt_write(const uint8_t* data, size_t length);
+bool Mqtt_endPublish();
+bool Mqtt_setBufferSize(uint16_t size);
+
+// QoS 1 傳送中視窗容量
+#ifndef MQTT_INFLIGHT_SIZE
+#define MQTT_INFLIGHT_SIZE 8
+#endif
+#ifndef MQTT_INFLIGHT_PAYLOAD_LEN
+#define MQTT_INFLIGHT_PAYLOAD_LEN 256
+#endif
+
+// QoS 1 完成回調函式指針類型 (success 為 false 表示重送次數用盡)
+typedef void (*MqttPublishDoneCallback)(uint16_t packetId, bool success, void* ctx);
+
+// QoS 1 統計資訊
+typedef struct {
+    uint16_t inflight;      // 目前等待確認的訊息數
+    uint16_t capacity;      // 視窗容量
+    uint32_t acked;         // 累計已確認的訊息數
+    uint32_t retransmits;   // 累計重送次數
+    uint32_t failed;        // 累計放棄的訊息數
+} MqttQos1Stats;
+
+uint16_t Mqtt_publishQos1(
+    const char* topic, const uint8_t* payload, size_t length, bool retain = false,
+    MqttPublishDoneCallback callback = NULL, void* ctx = NULL, bool silentMode = false
+);
+void Mqtt_setQos1Retry(unsigned long timeoutMs = 5000, uint8_t maxRetries = 5);
+void Mqtt_getQos1Stats(MqttQos1Stats &stats);
 bool Mqtt_subscribe(const char* topic, int qos = 0, bool silentMode = false);
 bool Mqtt_unsubscribe(const char* topic, bool silentMode = false);
+
+// 主題路由處理函式指針類型
+typedef void (*MqttTopicHandler)(const char* topic, const uint8_t* payload, unsigned int length, void* ctx);
+
+// 主題路由樹與訂閱記錄的容量
+#ifndef MQTT_ROUTER_MAX_NODES
+#define MQTT_ROUTER_MAX_NODES 48
+#endif
+#ifndef MQTT_ROUTER_MAX_HANDLERS
+#define MQTT_ROUTER_MAX_HANDLERS 16
+#endif
+#ifndef MQTT_ROUTER_LEVEL_LEN
+#define MQTT_ROUTER_LEVEL_LEN 24
+#endif
+#ifndef MQTT_MAX_SUBSCRIPTIONS
+#define MQTT_MAX_SUBSCRIPTIONS 16
+#endif
+#ifndef MQTT_FILTER_LEN
+#define MQTT_FILTER_LEN 64
+#endif
+
+bool Mqtt_on(const char* filter, MqttTopicHandler handler, void* ctx = NULL, int qos = 0, bool silentMode = false);
+bool Mqtt_off(const char* filter, MqttTopicHandler handler, void* ctx = NULL, bool silentMode = false);
 bool Mqtt_checkStatus(bool silentMode = false);
+
+// MQTT 連線資訊快照 (POD，不配置堆積記憶體)
+typedef struct {
+    bool connected;
+    int8_t state;           // PubSubClient::state() (MQTT_CONNECTED=0)
+    int8_t lastError;       // 最近一次連線失敗的狀態碼 (0為尚未失敗)
+    const char* server;     // 指向 Mqtt_setup 傳入的字串，與 PubSubClient 相同不另外複製
+    uint16_t port;
+    uint32_t uptimeMs;      // 本次連線已持續的時間 (未連線時為0)
+    uint16_t inflight;      // QoS 1 等待確認的訊息數
+    uint16_t queued;        // 離線佇列中的訊息數
+    uint32_t reconnects;    // 累計成功重新連線次數
+} MqttInfo;
+
+bool Mqtt_getInfo(MqttInfo &info);
 bool Mqtt_loop();
 void Mqtt_disconnect(bool silentMode = false);
 
+// 自動重新連線統計資訊
+typedef struct {
+    uint32_t reconnectAttempts; // 累計重新連線嘗試次數
+    uint32_t reconnects;        // 累計成功重新連線次數
+    uint32_t backoffMs;         // 目前的退避時間 (已連線時為0)
+} MqttSessionStats;
+
+void Mqtt_setAutoReconnect(bool enable, unsigned long minBackoffMs = 1000, unsigned long maxBackoffMs = 60000);
+void Mqtt_getSessionStats(MqttSessionStats &stats);
+
+// 離線發布佇列容量
+#ifndef MQTT_QUEUE_SIZE
+#define MQTT_QUEUE_SIZE 16
+#endif
+#ifndef MQTT_QUEUE_TOPIC_LEN
+#define MQTT_QUEUE_TOPIC_LEN 64
+#endif
+#ifndef MQTT_QUEUE_PAYLOAD_LEN
+#define MQTT_QUEUE_PAYLOAD_LEN 256
+#endif
+
+// 佇列已滿時的處理策略
+typedef enum {
+    MQTT_QUEUE_DROP_OLDEST = 0, // 捨棄最舊的訊息
+    MQTT_QUEUE_DROP_NEWEST      // 捨棄新進的訊息
+} MqttQueuePolicy;
+
+// 離線佇列統計資訊
+typedef struct {
+    uint16_t depth;         // 目前佇列中的訊息數
+    uint16_t capacity;      // 佇列容量
+    uint32_t enqueued;      // 累計放入佇列的訊息數
+    uint32_t dropped;       // 累計捨棄的訊息數
+    uint32_t flushed;       // 累計送出的訊息數
+    uint32_t bypassed;      // 已連線時因過大而未排入佇列、先於較早訊息送出的訊息數
+} MqttQueueStats;
+
+void Mqtt_setOfflineQueue(
+    bool enable, MqttQueuePolicy policy = MQTT_QUEUE_DROP_OLDEST,
+    uint16_t flushBatch = 8, uint16_t flushBudgetMs = 20
+);
+void Mqtt_getQueueStats(MqttQueueStats &stats);
+void Mqtt_clearQueue();
+
 // ==========================================
 // Bluetooth Classic
 // ==========================================
@@ -66,11 +621,88 @@ bool BT_master_connect(
     bool partialMatch = false, int maxAttempts = 1,
     bool silentMode = false
 );
+
+// 名稱與位址對應快取 (RAM 筆數，另存於 NVS)
+#ifndef BT_PEER_CACHE_SIZE
+#define BT_PEER_CACHE_SIZE 4
+#endif
+
+// 非同步連接完成回調函式指針類型
+typedef void (*BTConnectCallback)(bool connected);
+
+// 藍牙連接統計資訊 (時間單位: 毫秒)
+typedef struct {
+    uint32_t attempts;      // 累計連接請求數
+    uint32_t successes;     // 累計成功次數
+    uint32_t failures;      // 累計失敗次數
+    uint32_t cacheHits;     // 累計使用快取位址的次數
+    uint32_t cacheMisses;   // 累計需要掃描的次數
+    uint32_t lastScanMs;    // 最近一次掃描耗時 (使用快取時為0)
+    uint32_t lastConnectMs; // 最近一次 SerialBT.connect 耗時
+    uint32_t lastTotalMs;   // 最近一次請求的總耗時
+} BTConnectStats;
+
+bool BT_connectAsync(
+    const String &name, uint32_t scanDuration = 5,
+    bool partialMatch = false, int maxAttempts = 1,
+    BTConnectCallback callback = NULL, bool silentMode = false
+);
+bool BT_isConnecting();
+void BT_getConnectStats(BTConnectStats &stats);
+void BT_clearPeerCache();
 void BT_setCallback(void (*callback)(String), bool silentMode = false);
+
+// 藍牙訊框緩衝區容量 (單一訊框最大長度)
+#ifndef BT_FRAME_MAX_LEN
+#define BT_FRAME_MAX_LEN 256
+#endif
+// 每次 BT_loop 最多讀取的位元組數，避免長時間佔用主迴圈
+#ifndef BT_RX_BUDGET
+#define BT_RX_BUDGET 512
+#endif
+
+// 藍牙訊框切割方式
+typedef enum {
+    BT_FRAME_DELIMITER = 0, // 以分隔字元結尾 (預設 '\n'，會去除結尾的 '\r')
+    BT_FRAME_LENGTH_PREFIX  // 2 位元組大端序長度 + 資料
+} BTFrameMode;
+
+// 藍牙訊框回調函式指針類型 (data 於回調返回後失效)
+typedef void (*BTFrameCallback)(const uint8_t* data, size_t length, void* ctx);
+
+// 藍牙訊框統計資訊
+typedef struct {
+    uint32_t frames;        // 累計送出的完整訊框數
+    uint32_t bytes;         // 累計讀取的位元組數
+    uint32_t overflows;     // 累計超過最大長度而捨棄的訊框數
+    uint32_t idleFlushes;   // 累計因閒置逾時送出(分隔模式)或捨棄(長度模式)的訊框數
+} BTFrameStats;
+
+void BT_setFraming(
+    BTFrameMode mode = BT_FRAME_DELIMITER, char delimiter = '\n',
+    size_t maxFrameLen = BT_FRAME_MAX_LEN, unsigned long idleFlushMs = 100,
+    bool silentMode = false
+);
+void BT_setFrameCallback(BTFrameCallback callback, void* ctx = NULL, bool silentMode = false);
+void BT_getFrameStats(BTFrameStats &stats);
 void BT_loop();
 bool BT_sendMessage(const String &message, bool ln = true, bool silentMode = false);
 bool BT_checkStatus();
 
+// 藍牙連線資訊快照 (POD，不配置堆積記憶體)
+typedef struct {
+    bool started;           // 是否已呼叫 BT_setup
+    bool connected;
+    bool connecting;        // 是否正在進行非同步連接
+    uint8_t peer[6];        // 最近一次主動連接的設備位址 (未主動連接時全為0)
+    uint32_t uptimeMs;      // 本次連線已持續的時間 (未連線時為0)
+    uint32_t rxBytes;       // 累計讀取的位元組數
+    uint32_t frames;        // 累計送出的完整訊框數
+    uint32_t lastConnectMs; // 最近一次連接請求的總耗時
+} BTInfo;
+
+bool BT_getInfo(BTInfo &info);
+
 // ==========================================
 // Bluetooth Low Energy
 // ==========================================
@@ -88,13 +720,281 @@ void BLE_setup(const char* bleName, bool silentMode = false);
 // 設定接收訊息回調函式
 void BLE_setCallback(BLECallbackFunction callback, bool silentMode = false);
 
-// BLE 主迴圈處理
+// 本地端要求的 ATT MTU (實際值由連線時的 MTU 交換決定)
+#ifndef BLE_MTU
+#define BLE_MTU 517
+#endif
+
+// 接收佇列容量 (寫入事件於藍牙堆疊任務中放入，由 BLE_loop 取出)
+// 每個槽位需容納一次寫入的最大長度 (ATT MTU 扣除 3 位元組標頭)，否則資料會被截斷
+#ifndef BLE_RX_QUEUE_SIZE
+#define BLE_RX_QUEUE_SIZE 8
+#endif
+#ifndef BLE_RX_SLOT_LEN
+#define BLE_RX_SLOT_LEN (BLE_MTU - 3)
+#endif
+#if BLE_RX_SLOT_LEN < BLE_MTU - 3
+#error "BLE_RX_SLOT_LEN 需至少為 BLE_MTU - 3"
+#endif
+
+// 二進位資料回調函式指針類型 (connId 為寫入資料的連線，data 於回調返回後失效)
+typedef void (*BLEDataCallback)(uint16_t connId, const uint8_t* data, size_t length, void* ctx);
+
+// 接收佇列統計資訊
+typedef struct {
+    uint16_t depth;         // 目前佇列中的訊息數
+    uint16_t capacity;      // 佇列容量
+    uint16_t highWater;     // 佇列曾經達到的最大深度
+    uint32_t received;      // 累計放入佇列的訊息數
+    uint32_t dropped;       // 累計因佇列已滿而捨棄的訊息數
+    uint32_t truncated;     // 累計超過 BLE_RX_SLOT_LEN 而被截斷的訊息數
+} BLERxStats;
+
+// 斷線後重新開始廣播前的等待時間 (毫秒，不阻塞主迴圈)
+#ifndef BLE_ADV_RESTART_DELAY_MS
+#define BLE_ADV_RESTART_DELAY_MS 500
+#endif
+
+// 設定廣播間隔: 啟動或斷線後先以快速間隔廣播 fastDurationMs，之後改用慢速間隔省電
+// 間隔單位為毫秒 (20 ~ 10240)，fastDurationMs 為 0 時一律使用快速間隔
+void BLE_setAdvertisingProfile(
+    uint16_t fastMinMs = 20, uint16_t fastMaxMs = 30, unsigned long fastDurationMs = 30000,
+    uint16_t slowMinMs = 1000, uint16_t slowMaxMs = 1285, bool silentMode = false
+);
+
+// 設定接收二進位資料回調函式 (可與 BLE_setCallback 同時使用)
+void BLE_setDataCallback(BLEDataCallback callback, void* ctx = NULL, bool silentMode = false);
+
+// 取得接收佇列統計
+void BLE_getRxStats(BLERxStats &stats);
+
+// BLE 主迴圈處理 (取出接收佇列並呼叫回調函式)
 void BLE_loop();
 
 // 發送訊息
 bool BLE_sendMessage(const String &message, bool ln = true, bool silentMode = false);
 
+// 等待藍牙堆疊解除壅塞的最長時間 (毫秒)
+#ifndef BLE_CONGEST_TIMEOUT_MS
+#define BLE_CONGEST_TIMEOUT_MS 500
+#endif
+// 單一通知傳送失敗時的重試次數
+#ifndef BLE_TX_MAX_RETRIES
+#define BLE_TX_MAX_RETRIES 3
+#endif
+
+// 分段標頭 (啟用 BLE_setChunkHeader 時每個通知的第一個位元組)
+#define BLE_CHUNK_FIRST     0x80  // 訊息的第一段
+#define BLE_CHUNK_LAST      0x40  // 訊息的最後一段
+#define BLE_CHUNK_SEQ_MASK  0x3F  // 段序號 (0-63 循環)
+
+// 低功耗藍牙傳送統計資訊
+typedef struct {
+    uint16_t mtu;             // 各連線中最小的 ATT MTU
+    uint32_t messages;        // 累計送出的訊息數
+    uint32_t chunks;          // 累計送出的通知數
+    uint32_t bytes;           // 累計送出的資料位元組數 (不含分段標頭)
+    uint32_t retries;         // 累計重試次數
+    uint32_t congestionWaits; // 累計等待壅塞解除的次數
+    uint32_t failed;          // 累計傳送失敗的訊息數
+    uint32_t bytesPerSec;     // 最近一則訊息的傳送速率
+} BLETxStats;
+
+// 以 MTU 大小分段發送二進位資料給所有已啟用通知的連線
+bool BLE_sendData(const uint8_t* data, size_t length, bool silentMode = false);
+bool BLE_sendCbor(const CborWriter &writer, bool silentMode = false);
+
+// 同時連線的中央設備數上限 (受藍牙控制器設定限制)
+#ifndef BLE_MAX_CONNECTIONS
+#define BLE_MAX_CONNECTIONS 3
+#endif
+
+// 單一連線資訊
+typedef struct {
+    uint16_t connId;          // 連線識別碼
+    uint8_t address[6];       // 中央設備位址
+    uint16_t mtu;             // 協商後的 ATT MTU
+    bool subscribed;          // 是否已啟用通知
+    uint32_t txMessages;      // 累計送出的訊息數
+    uint32_t txBytes;         // 累計送出的位元組數
+    uint32_t rxMessages;      // 累計收到的寫入數
+    uint32_t rxBytes;         // 累計收到的位元組數
+} BLEConnectionInfo;
+
+// 設定同時連線數上限，未達上限時連線後會繼續廣播
+void BLE_setMaxConnections(uint8_t maxConnections, bool silentMode = false);
+uint8_t BLE_getConnectionCount();
+bool BLE_getConnection(uint8_t index, BLEConnectionInfo &info);
+
+// 發送給指定連線 / 所有已啟用通知的連線 (回傳成功送達的連線數)
+bool BLE_sendTo(uint16_t connId, const uint8_t* data, size_t length, bool silentMode = false);
+int BLE_broadcast(const uint8_t* data, size_t length, bool silentMode = false);
+
+// 是否在每個通知前加上分段標頭 (預設關閉，與舊版用戶端相容)
+void BLE_setChunkHeader(bool enable);
+
+// 取得 ATT MTU (connId 為 -1 時回傳各連線中最小的值) 與傳送統計
+uint16_t BLE_getMTU(int connId = -1);
+void BLE_getTxStats(BLETxStats &stats);
+
 // 檢查連接狀態
 bool BLE_checkStatus();
 
+// ==========================================
+// Metrics
+// ==========================================
+
+// 計數器
+typedef enum {
+    WIRELESS_METRIC_WIFI_CONNECTS = 0,      // WiFi 連線成功次數
+    WIRELESS_METRIC_WIFI_CONNECT_FAILURES,  // WiFi 連線失敗次數
+    WIRELESS_METRIC_WIFI_DISCONNECTS,       // WiFi 斷線次數
+    WIRELESS_METRIC_MQTT_CONNECTS,          // MQTT 連線成功次數 (包含重新連線)
+    WIRELESS_METRIC_MQTT_CONNECT_FAILURES,  // MQTT 連線失敗次數
+    WIRELESS_METRIC_MQTT_RECONNECTS,        // MQTT 自動重新連線成功次數
+    WIRELESS_METRIC_MQTT_PUBLISHES,         // MQTT 發布成功次數
+    WIRELESS_METRIC_MQTT_PUBLISH_FAILURES,  // MQTT 發布失敗次數
+    WIRELESS_METRIC_MQTT_TX_BYTES,          // MQTT 發布的內容位元組數
+    WIRELESS_METRIC_MQTT_RX_BYTES,          // MQTT 收到的內容位元組數
+    WIRELESS_METRIC_MQTT_QUEUE_DROPS,       // MQTT 離線佇列捨棄的訊息數
+    WIRELESS_METRIC_BT_TX_BYTES,            // 藍牙發送位元組數
+    WIRELESS_METRIC_BT_RX_BYTES,            // 藍牙接收位元組數
+    WIRELESS_METRIC_BLE_TX_BYTES,           // BLE 發送位元組數
+    WIRELESS_METRIC_BLE_RX_BYTES,           // BLE 接收位元組數
+    WIRELESS_METRIC_BLE_NOTIFY_FAILURES,    // BLE 通知發送失敗次數
+    WIRELESS_METRIC_BLE_RX_DROPS,           // BLE 接收佇列捨棄的訊息數
+    WIRELESS_METRIC_SERVICE_DROPS,          // 服務任務佇列捨棄的訊息數
+    WIRELESS_METRIC_COUNT
+} WirelessMetricId;
+
+// 延遲直方圖
+typedef enum {
+    WIRELESS_HIST_WIFI_CONNECT = 0,         // WiFi 連線耗時
+    WIRELESS_HIST_MQTT_CONNECT,             // MQTT 連線耗時
+    WIRELESS_HIST_MQTT_PUBLISH,             // MQTT 單次發布耗時
+    WIRELESS_HIST_BT_CONNECT,               // 藍牙主機模式連線耗時
+    WIRELESS_HIST_BLE_SEND,                 // BLE 單則訊息送出耗時 (包含分段)
+    WIRELESS_HIST_COUNT
+} WirelessHistogramId;
+
+// 直方圖區間數，各區間上限見 Wireless_histogramBound (最後一個區間無上限)
+#define WIRELESS_HIST_BUCKETS 8
+
+typedef struct {
+    uint32_t count;                         // 樣本數
+    uint32_t minUs;                         // 最小值 (微秒)
+    uint32_t maxUs;                         // 最大值 (微秒)
+    uint64_t sumUs;                         // 總和 (微秒)
+    uint32_t buckets[WIRELESS_HIST_BUCKETS];
+} WirelessHistogram;
+
+// WiFi 信號強度取樣
+typedef struct {
+    uint32_t samples;
+    int8_t min;
+    int8_t avg;
+    int8_t max;
+    int8_t last;
+} WirelessRssiStats;
+
+// 指標快照
+typedef struct {
+    uint32_t uptimeMs;                      // 自上次重設以來的時間
+    uint32_t counters[WIRELESS_METRIC_COUNT];
+    WirelessHistogram histograms[WIRELESS_HIST_COUNT];
+    WirelessRssiStats rssi;
+} WirelessMetrics;
+
+// RSSI 取樣間隔 (毫秒)
+#ifndef WIRELESS_METRICS_SAMPLE_MS
+#define WIRELESS_METRICS_SAMPLE_MS 10000
+#endif
+// 定期發布的訊息緩衝區大小
+#ifndef WIRELESS_METRICS_PAYLOAD_LEN
+#define WIRELESS_METRICS_PAYLOAD_LEN 768
+#endif
+
+void Wireless_getMetrics(WirelessMetrics &metrics);
+void Wireless_resetMetrics();
+uint32_t Wireless_histogramBound(uint8_t bucket);
+const char* Wireless_metricName(WirelessMetricId id);
+const char* Wireless_histogramName(WirelessHistogramId id);
+size_t Wireless_formatMetrics(char* buffer, size_t size);
+
+// 定期將精簡的指標 (JSON) 發布到 MQTT 主題，topic 為 NULL 或 intervalMs 為 0 時停止
+void Wireless_setMetricsPublish(const char* topic, unsigned long intervalMs = 60000, bool silentMode = false);
+// RSSI 取樣與定期發布，由 Mqtt_loop 自動呼叫；未使用 MQTT 時可自行呼叫以取樣 RSSI
+void Wireless_metricsLoop();
+
+// ==========================================
+// Wireless Service
+// ==========================================
+
+// 服務任務要處理的模組
+#define WIRELESS_SERVICE_WIFI   0x01
+#define WIRELESS_SERVICE_MQTT   0x02
+#define WIRELESS_SERVICE_BT     0x04
+#define WIRELESS_SERVICE_BLE    0x08
+#define WIRELESS_SERVICE_ALL    0x0F
+
+// 服務任務佇列容量
+#ifndef WIRELESS_SERVICE_QUEUE_SIZE
+#define WIRELESS_SERVICE_QUEUE_SIZE 8
+#endif
+#ifndef WIRELESS_SERVICE_TOPIC_LEN
+#define WIRELESS_SERVICE_TOPIC_LEN 64
+#endif
+#ifndef WIRELESS_SERVICE_PAYLOAD_LEN
+#define WIRELESS_SERVICE_PAYLOAD_LEN 256
+#endif
+// 服務任務每輪之間的休息時間 (毫秒)
+#ifndef WIRELESS_SERVICE_PERIOD_MS
+#define WIRELESS_SERVICE_PERIOD_MS 5
+#endif
+
+// 服務任務統計資訊
+typedef struct {
+    uint32_t loops;             // 累計執行輪數
+    uint32_t publishQueued;     // 累計由其他任務轉交的發布請求數
+    uint32_t publishDropped;    // 累計因佇列已滿或過大而捨棄的發布請求數
+    uint32_t inboundQueued;     // 累計放入接收佇列的訊息數
+    uint32_t inboundDropped;    // 累計因佇列已滿或過大而捨棄的接收訊息數
+    uint32_t stackHighWater;    // 服務任務堆疊剩餘量的最低值 (位元組)
+} WirelessServiceStats;
+
+// 啟動服務任務: 於指定核心上定期執行 Wifi_poll/Mqtt_loop/BT_loop/BLE_loop
+// 啟動後 Mqtt_publish/Mqtt_publishBinary 會轉交給服務任務發送 (超過 WIRELESS_SERVICE_PAYLOAD_LEN 的訊息直接在呼叫者的任務中發送)，
+// 收到的訊息放入接收佇列，由應用程式呼叫 Wireless_dispatch 在自己的任務中執行回調函式
+// 其他 MQTT 函式在呼叫者的任務中執行，以互斥鎖與服務任務的 Mqtt_loop 互斥 (可能等待重新連線完成)
+// WiFi 連線、掃描與配網函式同樣以互斥鎖與服務任務的 Wifi_poll 互斥，阻塞式連線可與服務任務同時推進
+bool Wireless_startService(
+    int core = 0, uint8_t priority = 2, uint32_t stackSize = 6144,
+    uint8_t modules = WIRELESS_SERVICE_ALL, bool silentMode = false
+);
+// 不可在服務任務中 (包括其中執行的事件監聽函式) 呼叫，此時返回 false
+bool Wireless_stopService(bool silentMode = false);
+bool Wireless_serviceRunning();
+int Wireless_dispatch(int maxMessages = WIRELESS_SERVICE_QUEUE_SIZE);
+void Wireless_getServiceStats(WirelessServiceStats &stats);
+
+// 以下為模組之間的內部介面，應用程式請勿直接呼叫
+#define WIRELESS_INBOUND_MQTT   0
+#define WIRELESS_INBOUND_BT     1
+#define WIRELESS_INBOUND_BLE    2
+
+bool _wirelessHasListener(uint32_t eventMask);
+bool _wirelessServiceForward();
+bool _wirelessServiceDefer();
+bool _wirelessServicePublish(const char* topic, const uint8_t* payload, size_t length, bool retain);
+void _wirelessServiceDrainPublish();
+bool _wirelessServicePostInbound(uint8_t source, uint16_t connId, const char* topic, const uint8_t* data, size_t length);
+void _mqttDeliver(const char* topic, const uint8_t* payload, unsigned int length);
+bool _mqttPublishDirect(const char* topic, const uint8_t* payload, size_t length, bool retain, bool silentMode);
+void _mqttFlushForwarded();
+void _btDeliver(const uint8_t* data, size_t length);
+void _bleDeliver(uint16_t connId, const uint8_t* data, size_t length);
+void _wirelessMetricAdd(WirelessMetricId id, uint32_t delta = 1);
+void _wirelessMetricLatency(WirelessHistogramId id, uint32_t us);
+void _wirelessMetricRssi(int8_t rssi);
+
 #endif
\ No newline at end of file